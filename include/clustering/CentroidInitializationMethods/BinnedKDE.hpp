@@ -0,0 +1,107 @@
+#ifndef BINNED_KDE_HPP
+#define BINNED_KDE_HPP
+
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <Eigen/Dense>
+
+#include "geometry/point/Point.hpp"
+
+#define KDE_BINNED_MIN_POINTS 1000
+#define KDE_BINNED_TRUNCATION 4.0
+#define KDE_BINNED_OVERSAMPLING 4.0                  // Binning nodes per bandwidth, sought in each dimension
+#define KDE_BINNED_MIN_OVERSAMPLING 2.0              // Binning nodes per bandwidth, below which the bandwidth is not resolved
+#define KDE_BINNED_MAX_NODES (std::size_t(1) << 23)  // Largest number of nodes of the binning grid
+
+/**
+ * \class BinnedKDE
+ * \brief Gaussian kernel density estimation on a regular grid, by binning and convolution.
+ *
+ * The data is linearly binned onto a refinement of the grid: every point spreads a unit
+ * weight over the 2^PD nodes of its cell, in proportion to its distance to them. The
+ * densities at the grid nodes are then the convolution of the weights with the Gaussian
+ * kernel sampled on the binning grid, computed as PD separable 1-D convolutions for a
+ * diagonal bandwidth matrix and truncated at KDE_BINNED_TRUNCATION bandwidths. Each
+ * convolution only keeps the nodes of the evaluation grid along its dimension.
+ *
+ * The binning error grows with the ratio between the step and the bandwidth, so every
+ * step of the evaluation grid is split in as many parts as needed for a binning step of
+ * at most 1 / KDE_BINNED_OVERSAMPLING bandwidths. If that grid would have more than
+ * KDE_BINNED_MAX_NODES nodes, the split is reduced down to 1 / KDE_BINNED_MIN_OVERSAMPLING
+ * bandwidths, and below it the bandwidth is not resolved: see resolves.
+ *
+ * This costs O(N + G' * sum of the kernel widths), G' nodes of the binning grid, instead
+ * of the O(N * G) of the exact sums.
+ *
+ * \tparam PD Dimension of the data points.
+ */
+template <std::size_t PD>
+class BinnedKDE
+{
+public:
+    /**
+     * \brief Prepares the binning of the data onto the grid.
+     *
+     * The grid nodes are origin + c * step for the integer coordinates c in [0, extents),
+     * stored in a vector with the first dimension varying fastest. Points outside the
+     * grid are clamped onto its boundary.
+     *
+     * \param data The input dataset, which must outlive the object.
+     * \param origin The coordinates of the first grid node.
+     * \param step The distance between grid nodes in each dimension.
+     * \param extents The number of grid nodes in each dimension.
+     */
+    BinnedKDE(const std::vector<Point<double, PD>> &data, const std::array<double, PD> &origin,
+              const std::array<double, PD> &step, const std::array<std::size_t, PD> &extents);
+
+    /**
+     * \brief Computes the densities at the grid nodes for a bandwidth matrix.
+     *
+     * The result matches KDEBase::kdeValue at the grid nodes, up to the binning error.
+     *
+     * \param bandwidth The diagonal bandwidth matrix H.
+     * \return The densities, in the order of the grid nodes.
+     * \throws std::invalid_argument If the bandwidth matrix is not diagonal or not resolved.
+     */
+    std::vector<double> densities(const Eigen::MatrixXd &bandwidth) const;
+
+    /**
+     * \brief Whether a bandwidth is resolved by a binning grid of at most KDE_BINNED_MAX_NODES nodes.
+     *
+     * Otherwise the densities are to be computed with sums over the dataset.
+     *
+     * \param bandwidth The bandwidth matrix H.
+     */
+    bool resolves(const Eigen::MatrixXd &bandwidth) const;
+
+    /**
+     * \brief The weights binned onto the grid itself, in the order of its nodes, summing to the number of points.
+     */
+    std::vector<double> weights() const;
+
+private:
+    const std::vector<Point<double, PD>> &m_data; ///< The input dataset.
+    std::array<double, PD> m_origin;       ///< Coordinates of the first grid node.
+    std::array<double, PD> m_step;         ///< Distance between grid nodes in each dimension.
+    std::array<std::size_t, PD> m_extents; ///< Number of grid nodes in each dimension.
+
+    /**
+     * \brief Number of binning steps per grid step in each dimension for a bandwidth.
+     *
+     * \param bandwidth The bandwidth matrix H.
+     * \param refinement The number of binning steps per grid step, set if the bandwidth is resolved.
+     * \return Whether the bandwidth is resolved.
+     */
+    bool refinement(const Eigen::MatrixXd &bandwidth, std::array<std::size_t, PD> &refinement) const;
+
+    /**
+     * \brief Bins the data onto the grid with every step split in parts.
+     *
+     * \param refinement The number of binning steps per grid step in each dimension.
+     * \return The weights of the binning grid, whose extents are (extents - 1) * refinement + 1.
+     */
+    std::vector<double> bin(const std::array<std::size_t, PD> &refinement) const;
+};
+
+#endif // BINNED_KDE_HPP
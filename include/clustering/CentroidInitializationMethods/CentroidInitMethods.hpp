@@ -27,6 +27,9 @@ public:
 
     /**
      * \brief Constructor: Initializes centroids using the dataset.
+     *
+     * The dataset is referenced, not copied: it must outlive the initializer.
+     *
      * \param data The dataset from which to initialize centroids.
      */
     explicit CentroidInitMethod(const std::vector<Point<PT, PD>> &data);
@@ -72,7 +75,7 @@ public:
     std::size_t get_k() const { return m_k; }
 
 protected:
-    std::vector<Point<PT, PD>> m_data; ///< Dataset
+    const std::vector<Point<PT, PD>> &m_data; ///< Dataset (a reference to the points of the metric)
     std::size_t m_k = 0;               ///< Number of clusters
 
     /**
@@ -58,7 +58,7 @@ int ElbowMethod<PT, PD, M>::findK() {
     int optimalK = 0; // Variable to store the optimal number of clusters
 
     // Retrieve the points from KMeans
-    std::vector<Point<PT, PD>> points = (this->m_kMeans).getPoints();
+    const std::vector<Point<PT, PD>> &points = (this->m_kMeans).getPoints();
     std::cout << "Start searching k...\n";
 
     for(int i = 0; i < MAX_CLUSTER ; i++) { // Infinite loop to incrementally search for the optimal k
@@ -68,7 +68,6 @@ int ElbowMethod<PT, PD, M>::findK() {
         mdc.findCentroid(pointerCentroids);
         (this->m_kMeans).setNumClusters(static_cast<std::size_t>(k));
         (this->m_kMeans).fit();
-        points = (this->m_kMeans).getPoints();
         double sum = 0; 
 
         #pragma omp parallel for reduction(+:sum)
@@ -2,13 +2,21 @@
 #define KDEBASE_HPP
 
 #include <vector>
+#include <memory>
 #include <Eigen/Dense>
 #include "geometry/point/Point.hpp"
+#include "geometry/kdtree/KDTree.hpp"
 #include "geometry/point/CentroidPoint.hpp"
 #include "clustering/CentroidInitializationMethods/KernelFunction.hpp"
+#include "clustering/CentroidInitializationMethods/BinnedKDE.hpp"
 
 #define RAY_MIN 3
 #define RANGE_MIN 9
+#define KDE_EVALUATION_BATCH 256 // Points per batch of kernel evaluations in kdeValue
+#define KDE_BANDWIDTH_SHRINK 0.40 // Ratio between consecutive bandwidths of the search ladder
+#define KDE_BANDWIDTH_RUNGS 16    // Number of bandwidths of the search ladder
+#define KDE_TRUNCATION_MIN_POINTS 1000 // Points from which the sums over the dataset are truncated by default
+#define KDE_TRUNCATION_TOLERANCE 1e-8  // Default largest omitted kernel value, relative to the peak of the kernel
 
 /**
  * \class KDEBase
@@ -54,12 +62,71 @@ public:
     /**
      * \brief Computes the KDE value at a given point.
      *
-     * This method evaluates the KDE function at a specific point in the dataset.
+     * This method evaluates the KDE function at a specific point in the dataset. The query
+     * is transformed with fixed-size matrices and the kernel profile is summed over batches
+     * of transformed points with vectorized Eigen array expressions, without heap allocations.
      *
      * \param x The point at which KDE is computed.
+     * \param kernel The kernel function, Gaussian by default.
      * \return The estimated density value at the given point.
+     * \throws std::runtime_error If the bandwidth matrix is not initialized.
      */
-    double kdeValue(const Point<double, PD>& x);
+    double kdeValue(const Point<double, PD>& x, KernelType kernel = KernelType::GAUSSIAN) const;
+
+    /**
+     * \brief Computes the Gaussian KDE value at a given point, summing only the nearby points.
+     *
+     * Only the transformed points within the cutoff radius of the transformed query, found
+     * with a kd-tree, are summed. Each omitted point contributes less than the tolerance
+     * times the peak of its kernel, so the result is within tolerance * K(0) / sqrt(det H)
+     * of kdeValue.
+     *
+     * \param x The point at which KDE is computed.
+     * \param errorBound If not null, receives the bound on the truncation error at this point.
+     * \return The estimated density value at the given point.
+     * \throws std::runtime_error If the bandwidth matrix is not initialized or the truncation is disabled.
+     */
+    double kdeValueTruncated(const Point<double, PD>& x, double* errorBound = nullptr) const;
+
+    /**
+     * \brief Enables the truncated evaluation for the grid densities, or disables it with 0.
+     *
+     * Overrides the default of prepareSums.
+     *
+     * \param tolerance The largest omitted kernel value, relative to the peak of the kernel.
+     * \throws std::invalid_argument If the tolerance is not in [0, 1).
+     */
+    void setTruncation(double tolerance);
+
+    /**
+     * \brief Chooses the truncation of the grid densities about to be computed with sums over a dataset.
+     *
+     * Unless setTruncation was called, the sums over KDE_TRUNCATION_MIN_POINTS points or more
+     * are truncated at KDE_TRUNCATION_TOLERANCE, and exact densities (setExactDensities) are
+     * never truncated. Small datasets are cheaper to sum than to index.
+     *
+     * \param numPoints The number of points of the dataset.
+     */
+    void prepareSums(std::size_t numPoints);
+
+    /**
+     * \brief Whether the grid densities are computed with truncated sums.
+     */
+    bool isTruncated() const { return m_tree != nullptr; }
+
+    /**
+     * \brief The largest truncation error bound of the last grid densities, 0 if they are not truncated.
+     */
+    double getMaxTruncationError() const { return m_maxTruncationError; }
+
+    /**
+     * \brief Computes a grid density with the truncated sums if enabled, else with kdeValue.
+     *
+     * \param x The grid point.
+     * \param maxError The largest truncation error bound so far, updated with the one of this point.
+     * \return The estimated density value at the grid point.
+     */
+    double gridDensity(const Point<double, PD>& x, double& maxError) const;
 
     /**
      * \brief Converts a Point object to an Eigen vector.
@@ -69,10 +136,87 @@ public:
      */
     Eigen::VectorXd pointToVector(const Point<double, PD>& point);
 
-    std::vector<Eigen::VectorXd> m_transformedPoints; ///< Transformed points for KDE calculations.
+    /**
+     * \brief Scales the bandwidth matrix and updates the derived parameters.
+     *
+     * \param factor The factor applied to the diagonal of the bandwidth matrix.
+     * \param m_data The dataset, whose transformed points are updated.
+     */
+    void shrinkBandwidth(double factor, const std::vector<Point<double, PD>>& m_data);
+
+    /**
+     * \brief Adds the points of the dataset farthest from the centroids until there are k.
+     *
+     * Completes the local maxima when even the narrowest bandwidth of the search ladder has
+     * fewer than k of them. Every new centroid is the point whose nearest centroid is the
+     * farthest, a pass over the dataset per centroid.
+     *
+     * \param m_data The dataset.
+     * \param k The number of centroids.
+     * \param centroids The centroids found, completed in place.
+     */
+    void completeWithFarthestPoints(const std::vector<Point<double, PD>>& m_data, std::size_t k, std::vector<CentroidPoint<double, PD>>& centroids) const;
+
+    /**
+     * \brief Chooses between exact sums and the binned engine for the grid densities.
+     *
+     * The exact sums are kept to validate the binned densities.
+     *
+     * \param exact True to always compute the grid densities with kdeValue.
+     */
+    void setExactDensities(bool exact) { m_exactDensities = exact; }
+
+    /**
+     * \brief Whether the grid densities of a dataset are computed by the binned engine (BinnedKDE).
+     *
+     * \param numPoints The number of points of the dataset.
+     */
+    bool useBinnedDensities(std::size_t numPoints) const { return !m_exactDensities && numPoints >= KDE_BINNED_MIN_POINTS; }
+
+    Eigen::Matrix<double, PD, Eigen::Dynamic, Eigen::RowMajor> m_transformedPoints; ///< Transformed points for KDE calculations, one contiguous row per dimension.
     Eigen::MatrixXd m_h_sqrt_inv; ///< Inverse square root of the bandwidth matrix.
     double m_h_det_sqrt; ///< Square root of the determinant of the bandwidth matrix.
     Eigen::MatrixXd m_h; ///< Bandwidth matrix used for KDE computations.
+    bool m_exactDensities = false; ///< Whether the grid densities are always computed with exact sums.
+    double m_truncationTolerance = 0.0; ///< Largest omitted relative kernel value, 0 for untruncated sums.
+    bool m_truncationSet = false; ///< Whether the truncation was chosen by setTruncation rather than prepareSums.
+    double m_maxTruncationError = 0.0; ///< Largest truncation error bound of the last grid densities.
+
+private:
+    std::vector<Point<double, PD>> m_indexedPoints; ///< Copy of the transformed points, reordered by the kd-tree.
+    std::unique_ptr<KdTree<double, PD>> m_tree; ///< Kd-tree over m_indexedPoints, null if the sums are not truncated.
+    double m_cutoffRadius = 0.0; ///< Distance in transformed coordinates beyond which points are omitted.
+    Eigen::Matrix<double, PD, PD> m_transform; ///< Fixed-size copy of m_h_sqrt_inv, applied to the queries.
+
+    /**
+     * \brief Updates the derived parameters and the transformed points for a bandwidth matrix.
+     *
+     * \param bandwidthMatrix The bandwidth matrix H.
+     * \param m_data The dataset to transform.
+     */
+    void transformPoints(const Eigen::MatrixXd& bandwidthMatrix, const std::vector<Point<double, PD>>& m_data);
+
+    /**
+     * \brief Sets the truncation tolerance and builds or drops the kd-tree accordingly.
+     *
+     * \param tolerance The largest omitted kernel value, relative to the peak of the kernel.
+     */
+    void applyTruncation(double tolerance);
+
+    /**
+     * \brief Builds the kd-tree over the transformed points for the truncated sums.
+     */
+    void buildTree();
+
+    /**
+     * \brief Sums a kernel profile of the squared distances from a transformed query to the transformed points.
+     *
+     * \param query The transformed query.
+     * \param profile The profile, a function of an array of squared distances.
+     * \return The sum of the profile over the dataset.
+     */
+    template<typename Profile>
+    double sumProfile(const Eigen::Matrix<double, PD, 1>& query, Profile profile) const;
 };
 
 #endif // KDEBASE_HPP
\ No newline at end of file
@@ -3,6 +3,9 @@
 
 #include <iostream>
 #include <vector>
+#include <array>
+#include <memory>
+#include <unordered_map>
 #include <cmath>
 #include <Eigen/Dense>
 #include <stdexcept>
@@ -13,8 +16,28 @@
 #include "clustering/CentroidInitializationMethods/KernelFunction.hpp"
 #include "clustering/CentroidInitializationMethods/KDEBase.hpp"
 
+#define KDE_MIN_BANDWIDTH_STEPS 0.5 // Grid steps spanned by the narrowest bandwidth of the search ladder
+
 using namespace Eigen;
 
+/**
+ * \struct KDEAnalysis
+ * \brief Grid, densities and local maxima of a KDE with the bandwidth of the rule of thumb.
+ *
+ * Computed once by KDE::analyze, it is shared between the search of k (KDEMethod) and the
+ * centroid initialization of a KDE on the same dataset with the same settings.
+ *
+ * \tparam PD Dimension of the data points.
+ */
+template <std::size_t PD>
+struct KDEAnalysis
+{
+    std::size_t numPoints = 0;                 ///< Number of points of the dataset.
+    std::vector<Point<double, PD>> gridPoints; ///< Points of the grid, from KDE::generateGrid.
+    std::vector<double> densities;             ///< Density at every grid point.
+    std::vector<std::size_t> maxima;           ///< Indices of the local maxima in gridPoints, increasing.
+};
+
 /**
  * \class KDE
  * \brief Implements Kernel Density Estimation (KDE) for centroid initialization.
@@ -59,66 +82,174 @@ public:
     /**
      * \brief Finds local maxima without restriction.
      *
-     * This method identifies local maxima in the KDE process without applying constraints.
+     * This method identifies local maxima in the KDE process without applying constraints,
+     * with the bandwidth of the rule of thumb.
      *
      * \return The number of local maxima found.
      */
     int findLocalWithoutRestriction();
 
+    /**
+     * \brief Computes the grid, the densities and the local maxima with the bandwidth of the rule of thumb.
+     *
+     * \return The analysis, to be reused by findCentroid through setAnalysis.
+     */
+    std::shared_ptr<const KDEAnalysis<PD>> analyze();
+
+    /**
+     * \brief Gives the analysis findCentroid starts from, instead of computing it.
+     *
+     * \param analysis An analysis of the same dataset by a KDE with the same settings, or null.
+     * \throws std::invalid_argument If the analysis is of a dataset of another size.
+     */
+    void setAnalysis(std::shared_ptr<const KDEAnalysis<PD>> analysis);
+
     /**
      * \brief Generates a grid of points for KDE computation.
      *
-     * The grid is used to estimate density values across the space.
+     * The grid is a dense PD-dimensional array stored in a vector, the first dimension
+     * varying fastest: the grid point of integer coordinates (c_0, ..., c_PD-1) is at
+     * index sum(c_d * stride_d). The extents and strides are kept to address neighbors.
+     *
+     * With the sparse grid only the nodes near the data are generated, in increasing order
+     * of their index in the dense grid. Unless setSparseGrid was called, it is chosen when the
+     * binned engine applies to the dataset but cannot resolve the bandwidth of the rule of
+     * thumb over the bounding box, and keeps at most KDE_SPARSE_MAX_OCCUPANCY of its nodes.
      *
      * \return A vector of generated grid points.
      */
     std::vector<Point<double, PD>> generateGrid();
 
     /**
-     * \brief Checks if a given point is a local maximum.
+     * \brief Chooses between the dense grid over the bounding box and the sparse grid.
+     *
+     * The sparse grid keeps the nodes within KDE_SPARSE_MARGIN steps of the node nearest to
+     * a data point, hashed by their index in the dense grid. Densities are only computed at
+     * those nodes, with the sums over the dataset since the binned engine needs the dense
+     * grid, and a node is a local maximum if no kept node of its box is denser. For
+     * clustered or elongated data most of the bounding box is empty and skipped; the
+     * truncated sums (KDEBase::prepareSums) keep the cost of each node low.
+     *
+     * Overrides the choice of generateGrid.
+     *
+     * \param sparse True to use the sparse grid from the next generateGrid.
+     */
+    void setSparseGrid(bool sparse)
+    {
+        m_sparseGrid = sparse;
+        m_sparseGridSet = true;
+    }
+
+    /**
+     * \brief Whether the sparse grid is used, as set or as chosen by the last generateGrid.
+     */
+    bool isSparseGrid() const { return m_sparseGrid; }
+
+    /**
+     * \brief Scale of the bandwidth chosen by the last findCentroid.
      *
-     * Determines whether a point is a local maximum by comparing its KDE value with neighboring points.
+     * \return The ratio between the bandwidth matrix m_h and that of the rule of thumb.
+     */
+    double getBandwidthScale() const { return m_bandwidthScale; }
+
+    /**
+     * \brief Checks if a given point of the dense grid is a local maximum.
+     *
+     * Determines whether a point is a local maximum by comparing its KDE value with the
+     * grid points at most m_ray steps away in every dimension, clipped at the boundary.
+     * A point of zero density is out of reach of the data and never a local maximum, else
+     * every node of the empty regions would be one for narrow bandwidths.
      *
-     * \param gridPoints The set of grid points.
      * \param densities The KDE values associated with each grid point.
      * \param index The index of the point to check.
-     * \param neighborsParallel Reference to a vector storing neighbor indices.
-     * \param offsetsParallel Reference to a vector storing neighbor offsets.
      * \return True if the point is a local maximum, false otherwise.
      */
-    bool isLocalMaximum(const std::vector<Point<double, PD>> &gridPoints, const std::vector<double> &densities, size_t index, std::vector<std::size_t> &neighborsParallel, std::vector<double> &offsetsParallel);
+    bool isLocalMaximum(const std::vector<double> &densities, std::size_t index) const;
+
+    /**
+     * \brief Finds all the local maxima of the densities over the grid.
+     *
+     * Computes the maximum over the (2 * m_ray + 1)^PD box of every grid point with one
+     * separable pass per dimension, each a contiguous, vectorizable loop per offset. On the
+     * sparse grid the box of every node is looked up in the hash of the kept nodes instead.
+     * Points of zero density are skipped, as in isLocalMaximum.
+     *
+     * \param densities The KDE values associated with each grid point.
+     * \return The indices of the local maxima, in increasing order.
+     */
+    std::vector<std::size_t> findLocalMaximaIndices(const std::vector<double> &densities) const;
 
 private:
     int m_ray;                   ///< Radius for local maxima search.
     int m_bandwidthMethods;      ///< Method used for bandwidth selection.
     int range_number_division;   ///< Number of divisions for the range calculation.
     std::size_t m_totalPoints;   ///< Total number of points in the dataset.
-    std::vector<double> m_rs;    ///< Vector containing radius values for KDE calculations.
     std::vector<double> m_range; ///< Range of KDE computations.
     std::vector<double> m_step;  ///< Step sizes used in KDE calculations.
+    std::array<std::size_t, PD> m_extents; ///< Number of grid points in each dimension.
+    std::array<std::size_t, PD> m_strides; ///< Distance in the grid vector between neighbors in each dimension.
+    bool m_sparseGrid = false;             ///< Whether only the nodes near the data are generated.
+    bool m_sparseGridSet = false;          ///< Whether the grid was chosen by setSparseGrid rather than generateGrid.
+    double m_bandwidthScale = 1.0;         ///< Ratio between m_h and the bandwidth of the rule of thumb.
+    std::shared_ptr<const KDEAnalysis<PD>> m_analysis; ///< Analysis given to findCentroid, null to compute it.
+    std::vector<std::size_t> m_sparseNodes; ///< Dense indices of the nodes of the sparse grid, increasing.
+    std::unordered_map<std::size_t, std::size_t> m_sparseSlots; ///< Position in m_sparseNodes of each dense index.
+
+    /**
+     * \brief Generates the nodes of the sparse grid, once the extents and steps are set.
+     *
+     * \param minValues The coordinates of the first node of the dense grid.
+     * \return The points of the kept nodes.
+     */
+    std::vector<Point<double, PD>> generateSparseGrid(const std::vector<double> &minValues);
+
+    /**
+     * \brief Finds the local maxima of the densities over the sparse grid.
+     *
+     * \param densities The KDE values at the nodes of m_sparseNodes.
+     * \return The positions in m_sparseNodes of the local maxima, in increasing order.
+     */
+    std::vector<std::size_t> findSparseLocalMaximaIndices(const std::vector<double> &densities) const;
 
     /**
      * \brief Finds local maxima in the KDE result.
      *
      * Uses the computed KDE values to detect peaks corresponding to potential centroids.
-     *
-     * \param gridPoints The points forming the KDE evaluation grid.
+     * If the bandwidth of the rule of thumb gives fewer than k maxima, the bandwidths
+     * KDE_BANDWIDTH_SHRINK^j times it, for j < KDE_BANDWIDTH_RUNGS, are bisected for the
+     * widest one with at least k maxima: at most 2 + log2(KDE_BANDWIDTH_RUNGS) density
+     * grids are computed, however far the right bandwidth is. The ladder stops at the
+     * bandwidths spanning KDE_MIN_BANDWIDTH_STEPS grid steps, and if even the narrowest one
+     * has fewer than k maxima, they are completed by KDEBase::completeWithFarthestPoints.
+     *
+     * \param analysis The grid, densities and maxima with the bandwidth of the rule of thumb.
      * \param returnVec Reference to a vector where detected centroids will be stored.
      */
-    void findLocalMaxima(const std::vector<Point<double, PD>> &gridPoints, std::vector<CentroidPoint<double, PD>> &returnVec);
+    void findLocalMaxima(const KDEAnalysis<PD> &analysis, std::vector<CentroidPoint<double, PD>> &returnVec);
+
+    /**
+     * \brief Bins the dataset onto the grid, if it is large enough for the binned engine.
+     *
+     * \param gridPoints The points forming the KDE evaluation grid, from generateGrid.
+     * \return The binned dataset, or null if the densities are computed with exact sums.
+     */
+    std::unique_ptr<BinnedKDE<PD>> binDensities(const std::vector<Point<double, PD>> &gridPoints) const;
 
     /**
-     * \brief Generates neighboring points for a given grid point.
+     * \brief Computes the densities at the grid points with the current bandwidth.
      *
-     * Determines neighboring points in the grid to assist in local maximum detection.
+     * \param gridPoints The points forming the KDE evaluation grid.
+     * \param binned The binned dataset, or null to compute exact sums, as for a bandwidth it does not resolve.
+     * \return The density of every grid point.
+     */
+    std::vector<double> computeDensities(const std::vector<Point<double, PD>> &gridPoints, const BinnedKDE<PD> *binned);
+
+    /**
+     * \brief Sets the bandwidth to a rung of the search ladder.
      *
-     * \param grid The set of grid points.
-     * \param currentPoint The point for which neighbors are being generated.
-     * \param dim The dimensionality of the space.
-     * \param neighbors Reference to a vector storing indices of neighboring points.
-     * \param offsets Reference to a vector storing offsets of neighboring points.
+     * \param rung The rung, the bandwidth being KDE_BANDWIDTH_SHRINK^rung times that of the rule of thumb.
      */
-    void generateNeighbors(const std::vector<Point<double, PD>> &grid, const Point<double, PD> &currentPoint, int dim, std::vector<size_t> &neighbors, std::vector<double> &offsets);
+    void setBandwidthRung(int rung);
 };
 
 #endif
\ No newline at end of file
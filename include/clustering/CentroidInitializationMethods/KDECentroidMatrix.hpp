@@ -7,6 +7,7 @@
 
 #include <iostream>
 #include <vector>
+#include <array>
 #include <cmath>
 #include <Eigen/Dense>
 #include <stdexcept>
@@ -22,10 +23,53 @@
 #define M_PI 3.14159265358979323846
 #endif
 
-using Grid3D = std::vector<std::vector<std::vector<Point<double, 3>>>>;
-using Densities3D = std::vector<std::vector<std::vector<double>>>;
 using namespace Eigen;
 
+/**
+ * \struct Grid3D
+ * \brief Regular 3D grid with implicit coordinates.
+ *
+ * The node of indices (x, y, z) is at origin + (x, y, z) * step, so only the geometry of
+ * the grid is stored. Values over the grid live in one flat vector with x varying fastest,
+ * the layout of BinnedKDE.
+ */
+struct Grid3D
+{
+    std::array<double, 3> origin{};        ///< Coordinates of the node (0, 0, 0).
+    std::array<double, 3> step{};          ///< Distance between nodes along each axis.
+    std::array<std::size_t, 3> extents{};  ///< Number of nodes along each axis.
+
+    /**
+     * \brief Total number of nodes.
+     */
+    std::size_t size() const { return extents[0] * extents[1] * extents[2]; }
+
+    /**
+     * \brief Position of the node (x, y, z) in the flat vectors of values.
+     */
+    std::size_t index(std::size_t x, std::size_t y, std::size_t z) const { return x + extents[0] * (y + extents[1] * z); }
+
+    /**
+     * \brief Coordinates of the node (x, y, z).
+     */
+    Point<double, 3> point(std::size_t x, std::size_t y, std::size_t z) const
+    {
+        Point<double, 3> node;
+        node.coordinates = {origin[0] + x * step[0], origin[1] + y * step[1], origin[2] + z * step[2]};
+        return node;
+    }
+
+    /**
+     * \brief Coordinates of the node at a position of the flat vectors of values.
+     */
+    Point<double, 3> point(std::size_t index) const
+    {
+        return point(index % extents[0], (index / extents[0]) % extents[1], index / (extents[0] * extents[1]));
+    }
+};
+
+using Densities3D = std::vector<double>; ///< Densities over a Grid3D, in the order of its nodes.
+
 /**
  * \class KDE3D
  * \brief Implements Kernel Density Estimation (KDE) for 3D data.
@@ -63,17 +107,37 @@ public:
     /**
      * \brief Generates a 3D grid based on input data.
      *
-     * \return A 3D grid of points for KDE calculations.
+     * The grid spans the bounding box of the data, with range_number_division steps per axis.
+     *
+     * \return The geometry of the grid for KDE calculations.
      */
     Grid3D generateGrid();
 
     /**
      * \brief Identifies local maxima in the KDE grid.
      *
-     * \param gridPoints The generated grid of points.
+     * The bandwidth is shrunk by KDE_BANDWIDTH_SHRINK until there are at least k maxima, at
+     * most KDE_BANDWIDTH_RUNGS - 1 times; the maxima of the narrowest bandwidth are then
+     * completed by KDEBase::completeWithFarthestPoints.
+     *
+     * \param grid The generated grid.
      * \param returnVec Vector where detected centroids will be stored.
      */
-    void findLocalMaxima(const Grid3D &gridPoints, std::vector<CentroidPoint<double, PDS>> &returnVec);
+    void findLocalMaxima(const Grid3D &grid, std::vector<CentroidPoint<double, PDS>> &returnVec);
+
+    /**
+     * \brief Finds the nodes of non-zero density not exceeded within RAY_MIN nodes along every axis.
+     *
+     * The maximum over the box of every node is computed plane by plane: each z plane gets
+     * its 2D box maximum, kept in a ring of 2 * RAY_MIN + 1 planes, and the box maximum of
+     * a plane is the maximum of the ring. The working set is a few planes, whatever the
+     * size of the grid, and each thread sweeps its own slab of planes.
+     *
+     * \param grid The grid.
+     * \param densities The densities over the grid.
+     * \return The positions of the local maxima, in the order of the indices (x, y, z).
+     */
+    std::vector<std::size_t> findLocalMaximaIndices(const Grid3D &grid, const Densities3D &densities) const;
 
 private:
     /**
@@ -92,16 +156,23 @@ private:
     std::array<size_t, 3> m_numPoints; ///< Number of points per axis in the grid.
 
     /**
-     * \brief Checks if a point is a local maximum in the KDE density grid.
+     * \brief Computes the densities over the grid with the current bandwidth.
+     *
+     * \param grid The grid.
+     * \param binned The binned dataset, or null to compute the sums over the dataset, as for a bandwidth it does not resolve.
+     * \return The densities over the grid.
+     */
+    Densities3D computeDensities(const Grid3D &grid, const BinnedKDE<PDS> *binned);
+
+    /**
+     * \brief Computes the 2D box maximum of a z plane of densities.
      *
-     * \param gridPoints The generated grid of points.
-     * \param densities Computed density values for the grid.
-     * \param x X-coordinate index.
-     * \param y Y-coordinate index.
-     * \param z Z-coordinate index.
-     * \return True if the point is a local maximum, false otherwise.
+     * \param grid The grid.
+     * \param plane The densities of the plane, x varying fastest.
+     * \param rowMax Buffer of the size of a plane, for the maxima along x.
+     * \param boxMax The box maxima of the plane.
      */
-    bool isLocalMaximum(const Grid3D &gridPoints, const Densities3D &densities, size_t x, size_t y, size_t z);
+    static void planeBoxMax(const Grid3D &grid, const double *plane, std::vector<double> &rowMax, double *boxMax);
 };
 
 #endif // KDE3D_HPP
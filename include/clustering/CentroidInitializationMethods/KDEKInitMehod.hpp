@@ -2,6 +2,7 @@
 #define KDE_K_INIT
 
 #include <cstddef> 
+#include <memory>
 
 // Forward declaration of KMeans to avoid cyclic dependencies
 template <typename PT, std::size_t PD, class M>
@@ -15,6 +16,10 @@ class Kinit;
 template<std::size_t PD>
 class KDE;
 
+// Forward declaration of KDEAnalysis, the grid and densities computed by a KDE
+template<std::size_t PD>
+struct KDEAnalysis;
+
 /**
  * \class KDEMethod
  * \brief Implements a K initialization method based on Kernel Density Estimation (KDE).
@@ -49,17 +54,31 @@ public:
      * \return The optimal number of clusters, K.
      */
     int findK();
+
+    /**
+     * \brief Returns the KDE analysis behind the last findK.
+     *
+     * A KDE centroid initialization on the same points can start from it with
+     * KDE::setAnalysis instead of computing the same grid and densities again.
+     *
+     * \return The analysis, or null before findK.
+     */
+    std::shared_ptr<const KDEAnalysis<PD>> getAnalysis() const { return m_analysis; }
+
+private:
+    std::shared_ptr<const KDEAnalysis<PD>> m_analysis; ///< Grid, densities and maxima of the last findK.
 };
 
 // Implementation of the findK method
 template<typename PT, std::size_t PD, class M>
 int KDEMethod<PT, PD, M>::findK() {
     // Retrieve the points from the KMeans object
-    std::vector<Point<PT, PD>> points = (this->m_kMeans).getPoints();
+    const std::vector<Point<PT, PD>> &points = (this->m_kMeans).getPoints();
     std::cout << "Searching K with KDE...";
     // Create a KDE object using the retrieved points
-    KDE kde(points);
-    int k = kde.findLocalWithoutRestriction();
+    KDE<PD> kde(points);
+    m_analysis = kde.analyze();
+    int k = m_analysis->maxima.size();
     std::cout<< "Optimal is " << k << std::endl;
     // Use KDE to find the optimal number of clusters without restrictions
     return k;
@@ -0,0 +1,70 @@
+#ifndef KMEANS_PLUS_PLUS_HPP
+#define KMEANS_PLUS_PLUS_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "clustering/CentroidInitializationMethods/CentroidInitMethods.hpp"
+
+#define KMEANS_PP_BLOCK_SIZE 4096 // Points per block of the sums of the sampling weights
+#define KMEANS_PP_SEED 42         // Default seed of the sampling
+
+/**
+ * \class KMeansPlusPlus
+ * \brief Centroid initialization by k-means++ (D² sampling).
+ *
+ * The first centroid is a point drawn uniformly, every next one a point drawn with
+ * probability proportional to its squared distance to the nearest centroid so far. The
+ * squared distances are kept per point and updated with the last centroid only, in a
+ * parallel pass that also sums them over blocks of KMEANS_PP_BLOCK_SIZE points. A draw
+ * walks the prefix sums of the blocks, then the points of one block.
+ *
+ * The random numbers are a hash of the seed and of the number of the draw, so that the
+ * centroids only depend on the seed, whatever the number of threads. The cost is k passes
+ * over the dataset.
+ *
+ * \tparam PD Dimension of the data points.
+ */
+template <std::size_t PD>
+class KMeansPlusPlus : public CentroidInitMethod<double, PD>
+{
+public:
+    /**
+     * \brief Constructor for KMeansPlusPlus with a number of centroids.
+     *
+     * \param data The input dataset as a vector of points.
+     * \param k Number of centroids to initialize.
+     * \param seed Seed of the sampling.
+     * \throws std::invalid_argument If k is larger than the number of points.
+     */
+    KMeansPlusPlus(const std::vector<Point<double, PD>> &data, int k, std::uint64_t seed = KMEANS_PP_SEED);
+
+    /**
+     * \brief Constructor for KMeansPlusPlus without k, to be set before findCentroid.
+     *
+     * \param data The input dataset as a vector of points.
+     */
+    KMeansPlusPlus(const std::vector<Point<double, PD>> &data);
+
+    /**
+     * \brief Draws the centroids among the points of the dataset.
+     *
+     * \param centroids Reference to a vector where the computed centroids will be stored.
+     * \throws std::invalid_argument If the number of centroids is not set.
+     */
+    void findCentroid(std::vector<CentroidPoint<double, PD>> &centroids) override;
+
+private:
+    std::uint64_t m_seed = KMEANS_PP_SEED; ///< Seed of the sampling.
+
+    /**
+     * \brief Uniform random number of a draw, from a hash of the seed and the draw.
+     *
+     * \param draw The number of the draw.
+     * \return A number in [0, 1).
+     */
+    double uniform(std::uint64_t draw) const;
+};
+
+#endif // KMEANS_PLUS_PLUS_HPP
@@ -10,6 +10,7 @@
  
  #include <Eigen/Dense>
  #include <cmath>
+ #include <cstddef>
  
  using Eigen::VectorXd;
  
@@ -17,13 +18,33 @@
  #ifndef M_PI
  #define M_PI 3.14159265358979323846
  #endif
+
+ #define KERNEL_GAUSSIAN_MAX_SQUARED_NORM 1400.0 // Squared norm past which the Gaussian profile is 0
  
+ /**
+  * \enum KernelType
+  * \brief The kernel functions available for density estimation.
+  */
+ enum class KernelType {
+     GAUSSIAN,
+     EPANECHNIKOV,
+     UNIFORM,
+     TRIANGULAR,
+     BIWEIGHT,
+     TRIWEIGHT,
+     COSINE
+ };
+
  /**
   * \class Kernel
   * \brief Provides various kernel functions for density estimation and regression.
   *
   * This class implements several common kernel functions, which are used in
   * statistical applications such as kernel density estimation and non-parametric regression.
+  *
+  * Every kernel is also available as a coefficient times a profile of the squared norm of
+  * its argument. The profiles are Eigen array expressions, evaluated with packet math
+  * (including the exponential) over a whole batch of squared norms at once.
   */
  class Kernel {
  public:
@@ -82,6 +103,44 @@
       * \return Computed kernel value.
       */
      static double cosine(const VectorXd& u);
+
+     /**
+      * \brief Coefficient of a kernel in a given dimension, (2 pi)^(-d/2) for the Gaussian and 1 otherwise.
+      *
+      * \param type The kernel.
+      * \param dims The dimension of the argument.
+      * \return The coefficient multiplying the profile.
+      */
+     static double coefficient(KernelType type, std::size_t dims);
+
+     /**
+      * \brief Profiles of the kernels, as expressions of an array `s` of squared norms.
+      *
+      * The kernel of an argument u is coefficient(type, u.size()) times the profile of u.squaredNorm().
+      * The compact supports are clamped with max rather than selected, so that they vectorize too.
+      * The vectorized exp clamps its argument, so the Gaussian would never fall below about
+      * 1e-308: past KERNEL_GAUSSIAN_MAX_SQUARED_NORM it is masked to 0, as std::exp underflows.
+      */
+     template <typename Derived>
+     static auto gaussianProfile(const Eigen::ArrayBase<Derived>& s) { return (-0.5 * s).exp() * (s < KERNEL_GAUSSIAN_MAX_SQUARED_NORM).template cast<double>(); }
+
+     template <typename Derived>
+     static auto epanechnikovProfile(const Eigen::ArrayBase<Derived>& s) { return 0.75 * (1 - s).max(0.0); }
+
+     template <typename Derived>
+     static auto uniformProfile(const Eigen::ArrayBase<Derived>& s) { return 0.5 * (s <= 1).template cast<double>(); }
+
+     template <typename Derived>
+     static auto triangularProfile(const Eigen::ArrayBase<Derived>& s) { return (1 - s.sqrt()).max(0.0); }
+
+     template <typename Derived>
+     static auto biweightProfile(const Eigen::ArrayBase<Derived>& s) { return 15.0 / 16.0 * (1 - s).max(0.0).square(); }
+
+     template <typename Derived>
+     static auto triweightProfile(const Eigen::ArrayBase<Derived>& s) { return 35.0 / 32.0 * (1 - s).max(0.0).cube(); }
+
+     template <typename Derived>
+     static auto cosineProfile(const Eigen::ArrayBase<Derived>& s) { return (s <= 1).select((M_PI / 4.0) * (M_PI / 2.0 * s.sqrt()).cos(), 0.0); }
  };
  
  #endif // KERNEL_HPP
@@ -0,0 +1,91 @@
+#ifndef MEAN_SHIFT_HPP
+#define MEAN_SHIFT_HPP
+
+#include <vector>
+#include <array>
+#include <memory>
+#include <utility>
+#include <cstddef>
+
+#include "clustering/CentroidInitializationMethods/CentroidInitMethods.hpp"
+#include "clustering/CentroidInitializationMethods/KDEBase.hpp"
+#include "geometry/kdtree/KDTree.hpp"
+
+#define MEAN_SHIFT_MAX_SEEDS 256        // Largest number of seeds climbing the density
+#define MEAN_SHIFT_MAX_ITERATIONS 300   // Largest number of updates of a seed
+#define MEAN_SHIFT_TOLERANCE 1e-2       // Shift, in bandwidths, below which a seed has converged
+#define MEAN_SHIFT_CUTOFF 3.0           // Distance, in bandwidths, beyond which points are ignored
+#define MEAN_SHIFT_MERGE_RADIUS 1.0     // Distance, in bandwidths, below which modes are merged
+#define MEAN_SHIFT_SLACK 0.5            // Distance, in bandwidths, a seed moves before its neighbors are searched again
+#define MEAN_SHIFT_MAX_SHRINKS 20       // Largest number of bandwidth shrinks looking for k modes
+#define MEAN_SHIFT_RANDOM_SEED 42       // Seed of the sample of the seeds
+
+/**
+ * \class MeanShift
+ * \brief Centroid initialization at the modes of the kernel density, found by mean shift.
+ *
+ * Seeds subsampled from the dataset climb the Gaussian kernel density estimate by
+ * repeatedly moving to the kernel-weighted mean of their neighbors, with the bandwidth
+ * matrix of KDEBase::bandwidth_RuleOfThumb. The seeds are updated in parallel in the
+ * coordinates where the kernel is isotropic, where the neighbors within MEAN_SHIFT_CUTOFF
+ * bandwidths are found with a kd-tree. A seed keeps its neighbors, searched with a slack,
+ * until it has moved farther than the slack, so that most updates are vectorized sums over
+ * a contiguous buffer. The converged seeds are merged into modes.
+ *
+ * Unlike the grid of KDE, the cost is linear in the seeds times their neighbors, whatever
+ * the dimension.
+ *
+ * \tparam PD Dimension of the data points.
+ */
+template <std::size_t PD>
+class MeanShift : public CentroidInitMethod<double, PD>, public KDEBase<PD>
+{
+public:
+    /**
+     * \brief Constructor for MeanShift with a number of centroids.
+     *
+     * If fewer modes than k are found the bandwidth is shrunk, if more are found the k
+     * densest ones are kept. When no bandwidth gives k modes, as for data on fewer distinct
+     * points, the modes are completed with the farthest points.
+     *
+     * \param data The input dataset as a vector of points.
+     * \param k Number of centroids to initialize.
+     * \throws std::invalid_argument If k is larger than the number of points.
+     */
+    MeanShift(const std::vector<Point<double, PD>> &data, int k);
+
+    /**
+     * \brief Constructor for MeanShift without k, every mode becomes a centroid.
+     *
+     * \param data The input dataset as a vector of points.
+     */
+    MeanShift(const std::vector<Point<double, PD>> &data);
+
+    /**
+     * \brief Computes the centroids at the modes of the density.
+     *
+     * \param centroids Reference to a vector where the computed centroids will be stored.
+     */
+    void findCentroid(std::vector<CentroidPoint<double, PD>> &centroids) override;
+
+    /**
+     * \brief Finds the modes of the density with the current bandwidth.
+     *
+     * \return The modes, in the coordinates of the data, with their density, densest first.
+     */
+    std::vector<std::pair<Point<double, PD>, double>> findModes();
+
+private:
+    std::vector<Point<double, PD>> m_indexed;   ///< Transformed points, reordered by the kd-tree.
+    std::unique_ptr<KdTree<double, PD>> m_tree; ///< Kd-tree over m_indexed.
+
+    /**
+     * \brief Moves a seed, in transformed coordinates, up to a mode of the density.
+     *
+     * \param seed The seed, replaced by the mode.
+     * \return The unnormalized density at the mode.
+     */
+    double climb(std::array<double, PD> &seed) const;
+};
+
+#endif // MEAN_SHIFT_HPP
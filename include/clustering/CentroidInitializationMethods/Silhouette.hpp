@@ -58,7 +58,6 @@ int SilhouetteMethod<PT, PD, M>::findK()
     int optimalK = 2; // The silhouette method does not apply to k=1
     double maxSilhouette = -1.0;
 
-    std::vector<Point<PT, PD>> points = (this->m_kMeans).getPoints();
     std::cout << "Start searching k using Silhouette Method...\n";
 
     for (int k = 2; k < MAX_CLUSTER; ++k)
@@ -81,7 +80,7 @@ template <typename PT, std::size_t PD, class M>
 double SilhouetteMethod<PT, PD, M>::computeSilhouetteScore(int k)
 {
     // Initialization
-    std::vector<Point<PT, PD>> points = (this->m_kMeans).getPoints();
+    const std::vector<Point<PT, PD>> &points = (this->m_kMeans).getPoints();
     MostDistanceClass mdc(points, k);
     std::vector<CentroidPoint<PT, PD>> &pointerCentroids = (this->m_kMeans).getCentroids();
 
@@ -90,8 +89,6 @@ double SilhouetteMethod<PT, PD, M>::computeSilhouetteScore(int k)
     (this->m_kMeans).setNumClusters(static_cast<std::size_t>(k));
     (this->m_kMeans).fit();
 
-    points = (this->m_kMeans).getPoints();
-
     double totalScore = 0.0;
     int numPoints = points.size();
 
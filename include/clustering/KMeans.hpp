@@ -8,6 +8,7 @@
 #include <cmath>
 #include <limits>
 #include <random>
+#include <cstdint>
 #include <omp.h>
 
 #include "geometry/point/Point.hpp"
@@ -18,6 +19,8 @@
 #include "clustering/CentroidInitializationMethods/KDECentroid.hpp"
 #include "clustering/CentroidInitializationMethods/RandomCentroids.hpp"
 #include "clustering/CentroidInitializationMethods/MostDistantCentroids.hpp"
+#include "clustering/CentroidInitializationMethods/MeanShift.hpp"
+#include "clustering/CentroidInitializationMethods/KMeansPlusPlus.hpp"
 #include "clustering/CentroidInitializationMethods/kInitMethods.hpp"
 #include "clustering/CentroidInitializationMethods/Elbowmethod.hpp"
 #include "clustering/CentroidInitializationMethods/KDEKInitMehod.hpp"
@@ -53,9 +56,11 @@ public:
      * \param metric A pointer to the metric function used to calculate distances between points.
      * \param centroidsInitializationMethod The method to initialize centroids.
      * \param kInitializationMethod Additional initialization method for centroids.
+     * \param seed Seed of the k-means++ initialization.
      */
     KMeans(std::size_t clusters, PT treshold, M* metric, 
-           int centroidsInitializationMethod, int kInitializationMethod);
+           int centroidsInitializationMethod, int kInitializationMethod,
+           std::uint64_t seed = KMEANS_PP_SEED);
 
     /** 
      * \brief Destructor for cleaning up resources.
@@ -117,6 +122,7 @@ protected:
   PT treshold;                                     ///< Threshold value for convergence.
   std::size_t numClusters;                         ///< Number of clusters to generate.
   std::vector<CentroidPoint<PT, PD>> centroids;    ///< Centroids of clusters.
+  std::uint64_t seed;                              ///< Seed of the k-means++ initialization.
 
 private:
   /** 
@@ -0,0 +1,125 @@
+#ifndef STREAMING_K_MEANS_HPP
+#define STREAMING_K_MEANS_HPP
+
+#include <vector>
+#include <string>
+#include <random>
+#include <cstdint>
+
+#include "geometry/point/CentroidPoint.hpp"
+#include "utils/PointBlockSource.hpp"
+
+#define STREAMING_MAX_ITERATIONS 100
+#define STREAMING_SAMPLE_SIZE 100000 // Points sampled to initialize the centroids with k-means++
+#define STREAMING_SEED 42            // Default seed of the sampling of the initial centroids
+
+/**
+ * \class StreamingKMeans
+ * \brief Out-of-core Lloyd K-Means over a dataset read block by block from disk.
+ *
+ * Unlike KMeans, the points are never held in memory all together: every iteration
+ * is a pass over the blocks of a PointBlockSource, where each block is assigned to
+ * the nearest centroids in parallel and summed into per-cluster partial sums. The
+ * next block is read by another thread while the current one is processed, so the
+ * I/O overlaps the computation. Memory use is two blocks plus the centroids.
+ *
+ * \tparam PT The type of the point coordinates.
+ * \tparam PD The number of dimensions of the points.
+ */
+template <typename PT, std::size_t PD>
+class StreamingKMeans
+{
+public:
+    /**
+     * \brief Constructor.
+     *
+     * \param clusters The number of clusters.
+     * \param treshold The convergence threshold on the mean displacement of the centroids.
+     * \param source The dataset, which must outlive the object.
+     * \param maxIterations The maximum number of passes of the Lloyd iterations.
+     */
+    StreamingKMeans(std::size_t clusters, PT treshold, PointBlockSource<PT, PD> *source,
+                    std::size_t maxIterations = STREAMING_MAX_ITERATIONS);
+
+    /**
+     * \brief Sets the initial centroids, instead of sampling them from the dataset.
+     */
+    void setCentroids(const std::vector<CentroidPoint<PT, PD>> &initial);
+
+    /**
+     * \brief Samples points uniformly from the dataset, with a reservoir over a whole pass.
+     *
+     * Used to run an in-memory centroid initialization, e.g. k-means++, on a subset
+     * of a dataset too large to load.
+     *
+     * \param count The number of points to sample, all the points if the dataset is smaller.
+     * \param seed The seed of the sampling.
+     * \return The sampled points, with their position in the dataset as id.
+     */
+    std::vector<Point<PT, PD>> samplePoints(std::size_t count, unsigned int seed);
+
+    /**
+     * \brief Runs the Lloyd iterations until convergence.
+     *
+     * Without initial centroids, a first pass samples them uniformly from the dataset.
+     *
+     * \param seed The seed of the sampling of the initial centroids.
+     * \throws std::runtime_error If the dataset has fewer points than clusters.
+     */
+    void fit(unsigned int seed = STREAMING_SEED);
+
+    /**
+     * \brief Writes the label of every point, in the order of the dataset, to a point file.
+     *
+     * The labels are computed in a last pass with the current centroids and stored as a
+     * single INT32 column (see PointFile), which also gives the inertia.
+     *
+     * \param path The path to the output file.
+     * \throws std::runtime_error If the file cannot be written.
+     */
+    void writeLabels(const std::string &path);
+
+    std::vector<CentroidPoint<PT, PD>> getCentroids() const;
+    std::size_t getNumPoints() const { return numPoints; }
+    std::size_t getIterations() const { return iterations; }
+
+    /**
+     * \brief Sum of the squared distances of the points to their centroid, from the last pass.
+     */
+    PT getInertia() const { return inertia; }
+
+private:
+    std::size_t numClusters;
+    PT treshold;
+    PointBlockSource<PT, PD> *source;
+    std::size_t maxIterations;
+
+    std::vector<PT> centroids; ///< Coordinates of the centroids, row by row.
+    std::size_t numPoints = 0;
+    std::size_t iterations = 0;
+    PT inertia = 0;
+
+    /**
+     * \brief Calls `process(block, count)` for every block of a pass, reading the next block meanwhile.
+     */
+    template <typename F>
+    void forEachBlock(F process);
+
+    /**
+     * \brief Samples the initial centroids uniformly, with a reservoir over a whole pass.
+     */
+    void sampleCentroids(unsigned int seed);
+
+    /**
+     * \brief Assigns the points of a block to their nearest centroid.
+     *
+     * \param labels Receives the label of every point, if not null.
+     * \param sums Accumulates the coordinates of the points of every cluster, if not null.
+     * \param counts Accumulates the number of points of every cluster, if not null.
+     * \return The sum of the squared distances of the points to their centroid.
+     */
+    PT assignBlock(const std::vector<PT> &block, std::size_t count, std::int32_t *labels,
+                   std::vector<PT> *sums, std::vector<std::size_t> *counts) const;
+};
+
+#endif // STREAMING_K_MEANS_HPP
@@ -55,9 +55,11 @@ public:
     /**
      * \brief Pointer to the single point of this node (only for leaf nodes).
      * 
-     * If this node is a leaf, it stores a pointer to the associated point.
+     * If this node is a leaf, it stores a pointer to the associated point, in the
+     * vector the tree has been built on (not a copy, so assignments made through
+     * the tree are seen by the dataset).
      */
-    std::unique_ptr<Point<PT, PD>> myPoint = nullptr;
+    Point<PT, PD> *myPoint = nullptr;
 
     /**
      * @brief Default constructor.
@@ -26,6 +26,8 @@ public:
      * \brief Constructs a KD-tree from a given set of points.
      * 
      * This constructor initializes the tree by recursively partitioning the input points.
+     * The points are reordered in place and the leaves point into the vector, which
+     * must outlive the tree and must not be resized.
      * 
      * \param points A reference to a vector of points to be organized into the tree.
      */
@@ -47,6 +49,17 @@ public:
      */
     std::unique_ptr<KdNode<PT, PD>>& getRoot();
 
+    /**
+     * \brief Finds the points within a radius of a center.
+     * 
+     * Subtrees whose bounding box is farther than the radius from the center are skipped.
+     * 
+     * \param center The center of the ball.
+     * \param radius The radius of the ball.
+     * \param result The points within the ball (cleared first), pointing into the vector of the tree.
+     */
+    void radiusSearch(const std::array<PT, PD>& center, PT radius, std::vector<const Point<PT, PD>*>& result) const;
+
 private:
     std::unique_ptr<KdNode<PT, PD>> root = nullptr; ///< Root node of the KD-tree.
 
@@ -73,6 +86,17 @@ private:
      */
     void clearTree(std::unique_ptr<KdNode<PT, PD>>& node);
 
+    /**
+     * \brief Recursively collects the points of a subtree within a ball.
+     * 
+     * \param node The root of the subtree.
+     * \param center The center of the ball.
+     * \param squaredRadius The squared radius of the ball.
+     * \param result The vector the points are appended to.
+     */
+    void radiusSearch(const KdNode<PT, PD>* node, const std::array<PT, PD>& center, PT squaredRadius,
+                      std::vector<const Point<PT, PD>*>& result) const;
+
 };
 
 #endif // KDTREE_HPP
@@ -8,6 +8,7 @@
 #include <exception>
 #include <string>
 #include <filesystem>
+#include <array>
 
 #include "geometry/point/Point.hpp"
 #include "geometry/mesh/Mesh.hpp"
@@ -20,15 +21,19 @@
  * the computed area, the normal vector, and the baricenter (centroid) of the face.
  * The face also includes methods for calculating the area and baricenter from the 
  * provided vertices and mesh vertex data.
+ *
+ * Faces are plain values: Mesh does not store them, it keeps the same attributes in
+ * flat arrays. A Face is used to add a face to a mesh, or as a copy returned by Mesh::getFace.
  */
 struct Face
 {
     /**
      * \brief A list of vertex indices that define the face.
      * 
-     * The vertices are represented by indices into the mesh's vertex array.
+     * The vertices are represented by indices into the mesh's vertex array,
+     * or are NO_VERTEX for faces without vertices (the super-faces of coarse meshes).
      */
-    std::vector<VertId> vertices;
+    std::array<VertId, 3> vertices = {NO_VERTEX, NO_VERTEX, NO_VERTEX};
 
     /**
      * \brief The area of the face.
@@ -36,7 +41,7 @@ struct Face
      * The area is computed as half the magnitude of the cross product of two 
      * edge vectors of the triangle.
      */
-    double area;
+    double area = 0;
 
     /**
      * \brief The baricenter (centroid) of the face.
@@ -63,7 +68,7 @@ struct Face
      * \param meshVertices A list of all the vertices in the mesh, referenced by index.
      * \param id The unique identifier of the face.
      */
-    Face(const std::vector<VertId>& vertices, const std::vector<Point<double, 3>>& meshVertices, FaceId id)
+    Face(const std::array<VertId, 3>& vertices, const std::vector<Point<double, 3>>& meshVertices, FaceId id)
         : vertices(vertices)
     {
         // Compute the area of the face
@@ -85,6 +90,24 @@ struct Face
         baricenter.setID(id);  // Set the face ID on the baricenter
     }
 
+    /**
+     * \brief Constructor that initializes a face from precomputed attributes.
+     * 
+     * Used to copy the faces out of a mesh, and for the aggregated faces of coarse
+     * meshes, which group several triangles and have no vertices of their own.
+     * 
+     * \param vertices The vertex indices of the face, NO_VERTEX if it has none.
+     * \param area The area of the face.
+     * \param baricenter The baricenter of the face.
+     * \param normal The normal of the face.
+     * \param id The unique identifier of the face.
+     */
+    Face(const std::array<VertId, 3> &vertices, double area, const Point<double, 3> &baricenter, const Point<double, 3> &normal, FaceId id)
+        : vertices(vertices), area(area), baricenter(baricenter), normal(normal)
+    {
+        this->baricenter.setID(id);
+    }
+
     /**
      * \brief Default constructor for the Face struct.
      */
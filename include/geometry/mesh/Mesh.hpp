@@ -7,7 +7,10 @@
 #include <set>
 #include <exception>
 #include <string>
+#include <stdexcept>
 #include <filesystem>
+#include <cstdint>
+#include <map>
 
 /**
  * \typedef VertId
@@ -27,8 +30,25 @@ typedef unsigned int EdgeId; /**< Alias for unsigned int representing edge ID. *
  */
 typedef unsigned int FaceId; /**< Alias for unsigned int representing face ID. */
 
+/**
+ * \def NO_VERTEX
+ * \brief Vertex index of the faces that have no vertices, like the super-faces of coarse meshes.
+ */
+#define NO_VERTEX VertId(-1)
+
+/**
+ * \enum AdjacencyMode
+ * \brief Which faces are adjacent in the face adjacency of a mesh.
+ */
+enum class AdjacencyMode
+{
+  VERTEX, /**< Faces sharing at least one vertex (about 12 neighbors per triangle). */
+  EDGE    /**< Faces sharing an edge (at most 3 neighbors per manifold triangle). */
+};
+
 #include "geometry/point/Point.hpp"
 #include "geometry/mesh/Face.hpp"
+#include "utils/Span.hpp"
 
 /**
  * \class Mesh
@@ -37,6 +57,10 @@ typedef unsigned int FaceId; /**< Alias for unsigned int representing face ID. *
  * The Mesh class provides methods for managing a collection of faces and vertices,
  * building face adjacency, exporting the mesh to files, and handling cluster
  * segmentation of the faces.
+ *
+ * Faces are stored as structure of arrays: a flat buffer of three vertex indices
+ * per triangle, and flat arrays of areas, normals and baricenters. The accessors
+ * return views (Span) on these arrays instead of copies.
  */
 class Mesh
 {
@@ -47,10 +71,26 @@ public:
    * This constructor takes a file path, reads the mesh data, and initializes
    * the vertices, faces, and adjacency relationships.
    *
+   * The OBJ file is read in parallel by ObjReader: the faces of all the groups are
+   * loaded, and polygons are split into triangle fans.
+   *
+   * After the first load, the mesh is stored in a binary cache file (see
+   * setCacheDirectory) which later loads map in memory instead of parsing the OBJ.
+   *
    * \param path The file path to the mesh data.
    */
   Mesh(const std::string path);
 
+  /**
+   * \brief Sets the directory of the binary mesh cache.
+   *
+   * By default the cache lives in `kmeans_mesh_cache` under the system temporary
+   * directory. An empty path disables the cache.
+   *
+   * \param directory The cache directory, created on the first write.
+   */
+  static void setCacheDirectory(const std::string &directory) { cacheDirectory = directory; }
+
   Mesh() = default;
 
   /**
@@ -67,11 +107,94 @@ public:
   /**
    * \brief Builds the face adjacency relationships for the mesh.
    *
-   * This method computes the adjacency list for each face in the mesh, storing
-   * the adjacent faces for each face ID.
+   * This method computes the adjacency list for each face in the mesh, in the
+   * adjacency mode of the mesh, and stores it in compressed sparse row form.
+   * It does nothing if the adjacency is already available, adding a face
+   * invalidates it.
+   *
+   * Every (vertex, face) or (edge, face) pair is radix sorted by vertex or edge,
+   * which groups the faces around each vertex or edge, and the neighbors of each
+   * face are merged from the groups of its three vertices or edges.
    */
   void buildFaceAdjacency();
 
+  /**
+   * \brief Sets the face adjacency explicitly, instead of deriving it from shared vertices.
+   *
+   * Used by meshes whose faces have no vertices, like the coarse levels of MeshCoarsening.
+   * The adjacency is taken to be in the current adjacency mode of the mesh.
+   *
+   * \param adjacency The adjacent faces of each face.
+   */
+  void setFaceAdjacency(const std::vector<std::vector<FaceId>> &adjacency);
+
+  /**
+   * \brief Sets which faces are adjacent, vertex adjacency being the default.
+   *
+   * The adjacency is rebuilt in the new mode by the next buildFaceAdjacency. Edge
+   * adjacency gives far fewer neighbors per face, so Dijkstra geodesics relax
+   * about four times fewer arcs, at the cost of slightly longer paths.
+   *
+   * \param mode The adjacency mode.
+   */
+  void setAdjacencyMode(AdjacencyMode mode) { adjacencyMode = mode; }
+
+  /**
+   * \brief Gets the adjacency mode of the mesh.
+   */
+  AdjacencyMode getAdjacencyMode() const { return adjacencyMode; }
+
+  /**
+   * \brief Whether the face adjacency is available in the adjacency mode of the mesh.
+   */
+  bool hasFaceAdjacency() const;
+
+  /**
+   * \brief Reorders the vertices and the faces of the mesh along a Morton curve.
+   *
+   * Vertices are sorted by position and faces by baricenter (see SpatialOrder), so
+   * that faces close on the surface are close in memory, which makes adjacency walks,
+   * Dijkstra frontiers and kd-tree visits far more cache friendly on large meshes.
+   * The face vertex indices, the face adjacency, the clusters and the landmarks are
+   * remapped to the new ids.
+   *
+   * The mesh remembers the file order of its vertices and faces: the exports and the
+   * .seg files keep using it, with the face vertex indices mapped back to the file
+   * positions of the vertices, so the output is the same as without reordering. A
+   * reordered mesh is no longer written to the binary cache, which holds the file order.
+   */
+  void reorderSpatially();
+
+  /**
+   * \brief Gets the position of a face in the file the mesh was loaded from.
+   *
+   * \param face The ID of the face.
+   * \return The original ID of the face, the face itself if the mesh has not been reordered.
+   */
+  FaceId getOriginalFaceId(const FaceId face) const { return originalFaceIds.empty() ? face : originalFaceIds[face]; }
+
+  /**
+   * \brief Gets the position of a vertex in the file the mesh was loaded from.
+   *
+   * \param vertex The ID of the vertex.
+   * \return The original ID of the vertex, the vertex itself if the mesh has not been reordered.
+   */
+  VertId getOriginalVertexId(const VertId vertex) const { return originalVertexIds.empty() ? vertex : originalVertexIds[vertex]; }
+
+  /**
+   * \brief Gets the vertices in the order of the file the mesh was loaded from.
+   *
+   * \return The ID of the vertex at each position of the file.
+   */
+  std::vector<VertId> verticesInFileOrder() const;
+
+  /**
+   * \brief Gets the faces in the order of the file the mesh was loaded from.
+   *
+   * \return The ID of the face at each position of the file.
+   */
+  std::vector<FaceId> facesInFileOrder() const;
+
   /**
    * \brief Overloads the output stream operator to print the mesh.
    *
@@ -113,17 +236,58 @@ public:
    *
    * \return A vector of 3D points representing the centroids of the mesh faces.
    */
-  std::vector<Point<double, 3>> getMeshFacesPoints();
+  std::vector<Point<double, 3>> getMeshFacesPoints() const;
 
   /**
-   * \brief Gets a reference to a specific face in the mesh.
+   * \brief Gets a copy of a specific face in the mesh.
    *
-   * This method returns a reference to the face identified by the given FaceId.
+   * The face is assembled from the attribute arrays, loops over many faces
+   * should use the per-attribute accessors below instead.
    *
    * \param face The ID of the face.
-   * \return A reference to the specified face.
+   * \return The specified face.
+   */
+  Face getFace(const FaceId face) const;
+
+  /**
+   * \brief Gets the three vertex indices of a face (NO_VERTEX for faces without vertices).
+   */
+  Span<const VertId> getFaceVertices(const FaceId face) const { return Span<const VertId>(faceVertices.data() + 3 * face, 3); }
+
+  /**
+   * \brief Gets the area of a face.
+   */
+  double getFaceArea(const FaceId face) const { return faceAreas[face]; }
+
+  /**
+   * \brief Gets the three coordinates of the baricenter of a face.
+   */
+  Span<const double> getFaceBaricenter(const FaceId face) const { return Span<const double>(faceBaricenters.data() + 3 * face, 3); }
+
+  /**
+   * \brief Gets the three coordinates of the unit normal of a face.
+   */
+  Span<const double> getFaceNormal(const FaceId face) const { return Span<const double>(faceNormals.data() + 3 * face, 3); }
+
+  /**
+   * \brief Gets the vertex indices of all the faces, three per face.
    */
-  Face &getFace(const FaceId face) { return meshFaces[face]; }
+  Span<const VertId> getTriangles() const { return faceVertices; }
+
+  /**
+   * \brief Gets the areas of all the faces.
+   */
+  Span<const double> getFaceAreas() const { return faceAreas; }
+
+  /**
+   * \brief Gets the baricenters of all the faces, three coordinates per face.
+   */
+  Span<const double> getFaceBaricenters() const { return faceBaricenters; }
+
+  /**
+   * \brief Gets the normals of all the faces, three coordinates per face.
+   */
+  Span<const double> getFaceNormals() const { return faceNormals; }
 
   /**
    * \brief Gets the number of faces in the mesh.
@@ -132,7 +296,7 @@ public:
    *
    * \return The number of faces in the mesh.
    */
-  int numFaces() const { return meshFaces.size(); }
+  int numFaces() const { return faceAreas.size(); }
 
   /**
    * \brief Gets a reference to the list of vertices in the mesh.
@@ -141,81 +305,179 @@ public:
    *
    * \return A reference to the mesh vertices.
    */
-  std::vector<Point<double, 3>> &getVertices() { return meshVertices; }
-  const
-
-      /**
-       * \brief Gets the list of faces adjacent to a given face.
-       *
-       * This method returns the adjacent faces for a given face identified by the
-       * FaceId.
-       *
-       * \param id The ID of the face.
-       * \return A vector of FaceIds representing the adjacent faces.
-       */
-      std::vector<FaceId>
-      getFaceAdjacencyAt(const FaceId id) const
+  const std::vector<Point<double, 3>> &getVertices() const { return meshVertices; }
+
+  /**
+   * \brief Gets the list of faces adjacent to a given face.
+   *
+   * This method returns the adjacent faces for a given face identified by the
+   * FaceId, sorted by id.
+   *
+   * \param id The ID of the face.
+   * \return A view on the FaceIds of the adjacent faces.
+   * \throws std::out_of_range If the adjacency is not built or the face does not exist.
+   */
+  Span<const FaceId> getFaceAdjacencyAt(const FaceId id) const
   {
-    return faceAdjacency.at(id);
+    if (id + 1 >= adjacencyOffsets.size())
+    {
+      throw std::out_of_range("Face adjacency not built for face " + std::to_string(id));
+    }
+    return Span<const FaceId>(adjacencyIndices.data() + adjacencyOffsets[id], adjacencyOffsets[id + 1] - adjacencyOffsets[id]);
   }
 
   /**
    * \brief Exports the mesh to an .obj file, filtering faces by a specific cluster.
    *
    * This method exports the mesh to an .obj file, including only the faces that
-   * belong to the specified cluster.
+   * belong to the specified cluster (see MeshExporter::writeObj).
    *
    * \param filepath The path to the output .obj file.
    * \param cluster The cluster ID to filter faces.
    */
-  void exportToObj(const std::string &filepath, int cluster);
+  void exportToObj(const std::string &filepath, int cluster) const;
 
   /**
    * \brief Exports the mesh to a grouped .obj file.
    *
-   * This method exports the mesh to an .obj file, grouping faces according to
-   * their cluster IDs.
+   * This method exports the mesh to an .obj file, with one group per cluster
+   * (see MeshExporter::writeGroupedObj).
    *
    * \param filepath The path to the output .obj file.
    */
   void exportToGroupedObj(const std::string &filepath) const;
 
   /**
-   * \brief Gets the list of vertices in the mesh.
-   *
-   * This method returns the list of vertices as a vector of 3D points.
+   * \brief Exports the mesh to a binary .ply file, with the cluster of each face
+   * as `label` property (see MeshExporter::writePly).
    *
-   * \return A vector of 3D points representing the vertices of the mesh.
+   * \param filepath The path to the output .ply file.
    */
-  std::vector<Point<double, 3>> getMeshVertices() const { return meshVertices; }
+  void exportToPly(const std::string &filepath) const;
 
   /**
-   * \brief Gets the adjacency relationships for the faces in the mesh.
+   * \brief Exports the cluster of each face to a .seg file (see MeshExporter::writeSeg).
    *
-   * This method returns a map where each face ID is associated with a vector
-   * of adjacent face IDs.
-   *
-   * \return A map representing the adjacency relationships of faces.
+   * \param filepath The path to the output .seg file.
    */
-  std::unordered_map<FaceId, std::vector<FaceId>> getFaceAdjacency() const { return faceAdjacency; }
+  void exportToSeg(const std::string &filepath) const;
 
   /**
-   * \brief Gets the list of faces in the mesh.
+   * \brief Gets the list of vertices in the mesh.
    *
-   * This method returns the list of faces that constitute the mesh.
+   * This method returns a view on the vertices of the mesh.
    *
-   * \return A vector of faces in the mesh.
+   * \return The 3D points representing the vertices of the mesh.
+   */
+  Span<const Point<double, 3>> getMeshVertices() const { return meshVertices; }
+
+  /**
+   * \brief Gets the offsets of the face adjacency: the neighbors of face `f` are at
+   * positions `[offsets[f], offsets[f + 1])` of getFaceAdjacencyIndices.
+   */
+  Span<const std::uint32_t> getFaceAdjacencyOffsets() const { return adjacencyOffsets; }
+
+  /**
+   * \brief Gets the neighbors of all the faces, concatenated in face order.
    */
-  std::vector<Face> getMeshFaces() const { return meshFaces; }
+  Span<const FaceId> getFaceAdjacencyIndices() const { return adjacencyIndices; }
 
   void addVertex(const Point<double, 3> &vertex);
   void addFace(const Face &face);
 
+  /**
+   * \brief Stores the landmark distance fields computed on the mesh.
+   *
+   * Landmark fields are exact geodesic distance fields from a few landmark faces.
+   * They only depend on the mesh and on its face adjacency, so they are cached here,
+   * for the current adjacency mode, and reused by every metric (and every
+   * segmentation) working on the same mesh.
+   *
+   * \param faces The landmark faces.
+   * \param distances One distance field (one value per face) for each landmark.
+   */
+  void setLandmarks(std::vector<FaceId> faces, std::vector<std::vector<double>> distances);
+
+  /**
+   * \brief Gets the landmark faces cached on the mesh.
+   *
+   * \return The landmark faces, empty if no landmark has been computed yet.
+   */
+  const std::vector<FaceId> &getLandmarkFaces() const;
+
+  /**
+   * \brief Gets the landmark distance fields cached on the mesh.
+   *
+   * \return For each landmark, the distances from the landmark face to every face.
+   */
+  const std::vector<std::vector<double>> &getLandmarkDistances() const;
+
 private:
+  /**
+   * \brief Loads the mesh from a binary cache file.
+   *
+   * The file is memory-mapped and its arrays copied into the mesh, the face
+   * adjacency of the current mode is restored too when the file has it.
+   *
+   * \param path The path to the cache file.
+   * \param sourcePath The path to the source file, hashed if its modification time changed.
+   * \return True if the file is valid and matches the source file of the mesh.
+   */
+  bool readBinary(const std::string &path, const std::string &sourcePath);
+
+  /**
+   * \brief Writes the mesh, and its face adjacency if built, to a binary cache file.
+   *
+   * The adjacency of the other modes already in the file is kept, so that switching
+   * between modes does not drop them from the cache.
+   *
+   * \param path The path to the cache file.
+   */
+  void writeBinary(const std::string &path);
+
+  /**
+   * \brief Loads the face adjacency of the current mode from the binary cache file.
+   *
+   * \return True if the file holds a valid adjacency in this mode for the mesh.
+   */
+  bool readCachedAdjacency();
+
+  /**
+   * \brief Computes the areas, normals and baricenters of all the faces from their vertices.
+   *
+   * The face vertex buffer must be filled, the attribute arrays are resized.
+   */
+  void computeFaceGeometry();
+
+  /**
+   * \brief Landmark faces and their distance fields.
+   */
+  struct Landmarks
+  {
+    std::vector<FaceId> faces;
+    std::vector<std::vector<double>> distances;
+  };
+
+  static std::string cacheDirectory;                             /**< Directory of the binary mesh cache. */
+
   std::vector<Point<double, 3>> meshVertices;                    /**< List of vertices in the mesh. */
-  std::vector<Face> meshFaces;                                   /**< List of faces in the mesh. */
+  std::vector<VertId> faceVertices;                              /**< Vertex indices of the faces, three per face. */
+  std::vector<double> faceAreas;                                 /**< Area of each face. */
+  std::vector<double> faceNormals;                               /**< Unit normal of each face, three coordinates per face. */
+  std::vector<double> faceBaricenters;                           /**< Baricenter of each face, three coordinates per face. */
+  std::vector<VertId> originalVertexIds;                         /**< File position of each vertex, empty if the vertices are in file order. */
+  std::vector<FaceId> originalFaceIds;                           /**< File position of each face, empty if the faces are in file order. */
   std::unordered_map<FaceId, int> faceClusters;                  /**< Map of face IDs to cluster IDs. */
-  std::unordered_map<FaceId, std::vector<FaceId>> faceAdjacency; /**< Adjacency map for faces. */
+  AdjacencyMode adjacencyMode = AdjacencyMode::VERTEX;           /**< Adjacency mode used by buildFaceAdjacency. */
+  AdjacencyMode builtAdjacencyMode = AdjacencyMode::VERTEX;      /**< Adjacency mode of the stored adjacency. */
+  std::vector<std::uint32_t> adjacencyOffsets;                   /**< CSR offsets of the face adjacency, empty if not built. */
+  std::vector<FaceId> adjacencyIndices;                          /**< CSR neighbors of the face adjacency. */
+  std::map<AdjacencyMode, Landmarks> landmarks;                  /**< Landmarks used for geodesic bounds, by adjacency mode. */
+  std::string binaryCachePath;                                   /**< Cache file of the mesh, empty if not cached. */
+  std::set<AdjacencyMode> cachedAdjacencyModes;                  /**< Adjacency modes stored in the cache file. */
+  std::uint64_t sourceSize = 0;                                  /**< Size of the source file. */
+  std::int64_t sourceMtime = 0;                                  /**< Modification time of the source file. */
+  std::uint64_t sourceHash = 0;                                  /**< Content hash of the source file. */
 };
 
 #endif // MESH_HPP
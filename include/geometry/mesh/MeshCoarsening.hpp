@@ -0,0 +1,53 @@
+#ifndef MESH_COARSENING_HPP
+#define MESH_COARSENING_HPP
+
+#include <vector>
+#include <array>
+#include <cmath>
+#include <random>
+#include <algorithm>
+
+#include "geometry/mesh/Mesh.hpp"
+
+#define COARSENING_MIN_REDUCTION 0.9
+
+/**
+ * \class MeshCoarsening
+ * \brief Builds coarser versions of a mesh by grouping adjacent faces into super-faces.
+ *
+ * Faces are paired with a heavy-edge matching on the face adjacency graph, where the
+ * heaviest edges join close faces with similar normals. Each pair becomes a super-face
+ * with the summed area and the area-weighted baricenter and normal. Two super-faces are
+ * adjacent when any of their faces are.
+ *
+ * Coarse meshes are face graphs: their faces have no vertices and the adjacency is set
+ * explicitly, so only metrics working on faces (Euclidean, Dijkstra) apply to them.
+ */
+class MeshCoarsening
+{
+public:
+    /**
+     * \brief Coarsens a mesh once, roughly halving its number of faces.
+     *
+     * \param mesh The mesh to coarsen, its face adjacency must be built.
+     * \param parent Filled with the super-face of the coarse mesh containing each face of `mesh`.
+     * \param seed Seed of the random visiting order of the matching.
+     * \return The coarse mesh, with its face adjacency built.
+     */
+    static Mesh coarsen(Mesh &mesh, std::vector<FaceId> &parent, unsigned int seed = 0);
+
+    /**
+     * \brief Coarsens a mesh repeatedly until it has at most `targetFaces` faces.
+     *
+     * Stops earlier if a level removes less than (1 - COARSENING_MIN_REDUCTION) of the faces.
+     *
+     * \param mesh The finest mesh.
+     * \param targetFaces The wanted number of faces of the coarsest level.
+     * \param levels Filled with the coarse meshes, from the finest to the coarsest.
+     * \param parents Filled with the parent maps: `parents[l]` maps the faces of level `l`
+     *                (level 0 being `mesh`) to the faces of `levels[l]`.
+     */
+    static void buildHierarchy(Mesh &mesh, int targetFaces, std::vector<Mesh> &levels, std::vector<std::vector<FaceId>> &parents);
+};
+
+#endif // MESH_COARSENING_HPP
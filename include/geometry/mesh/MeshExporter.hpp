@@ -0,0 +1,82 @@
+#ifndef MESH_EXPORTER_HPP
+#define MESH_EXPORTER_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "geometry/mesh/Mesh.hpp"
+
+#define EXPORT_BLOCK_SIZE 16384
+#define EXPORT_BLOCKS_PER_THREAD 4
+
+/**
+ * \class MeshExporter
+ * \brief Writes meshes and their segmentations to OBJ, PLY and .seg files.
+ *
+ * The text formats are produced in blocks of EXPORT_BLOCK_SIZE lines, formatted
+ * in parallel with `std::to_chars` into large buffers which are then written in
+ * order, a few blocks per thread at a time. The binary PLY is assembled the same
+ * way, without any formatting.
+ *
+ * Faces are always written in the file order of the mesh (see Mesh::reorderSpatially).
+ * Faces without a cluster have label -1.
+ */
+class MeshExporter
+{
+public:
+    /**
+     * \brief Writes the vertices of the mesh and the faces of one cluster to an OBJ file.
+     *
+     * \param mesh The mesh.
+     * \param path The path to the output file.
+     * \param cluster The cluster of the faces to write.
+     * \return True if the file has been written.
+     */
+    static bool writeObj(const Mesh &mesh, const std::string &path, int cluster);
+
+    /**
+     * \brief Writes the mesh to an OBJ file with one group per cluster.
+     *
+     * The faces are grouped with a counting sort on their cluster, so each cluster
+     * is a single `g cluster_<id>` group, whatever the order of the faces. The groups
+     * are sorted by cluster, and the faces of a group are in file order.
+     *
+     * \param mesh The mesh.
+     * \param path The path to the output file.
+     * \return True if the file has been written.
+     */
+    static bool writeGroupedObj(const Mesh &mesh, const std::string &path);
+
+    /**
+     * \brief Writes the mesh to a binary PLY file, with the cluster of each face.
+     *
+     * Vertices have `double` coordinates, and faces a list of `int` vertex indices and
+     * an `int` property `label` holding their cluster. The file uses the byte order of
+     * the machine.
+     *
+     * \param mesh The mesh.
+     * \param path The path to the output file.
+     * \return True if the file has been written.
+     */
+    static bool writePly(const Mesh &mesh, const std::string &path);
+
+    /**
+     * \brief Writes the cluster of every face to a .seg file, one per line.
+     *
+     * The file can be read back with Mesh::createSegmentationFromSegFile.
+     *
+     * \param mesh The mesh.
+     * \param path The path to the output file.
+     * \return True if the file has been written.
+     */
+    static bool writeSeg(const Mesh &mesh, const std::string &path);
+
+private:
+    /**
+     * \brief Gets the cluster of every face, in the file order of the faces.
+     */
+    static std::vector<int> fileOrderLabels(const Mesh &mesh, const std::vector<FaceId> &faces);
+};
+
+#endif // MESH_EXPORTER_HPP
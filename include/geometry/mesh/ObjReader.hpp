@@ -0,0 +1,67 @@
+#ifndef OBJ_READER_HPP
+#define OBJ_READER_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <omp.h>
+
+#include "geometry/mesh/Mesh.hpp"
+
+#define OBJ_MIN_CHUNK_SIZE (1 << 20)
+#define OBJ_CHUNKS_PER_THREAD 4
+#define OBJ_DEFAULT_GROUP "default"
+
+/**
+ * \brief The geometry read from an OBJ file, in flat arrays.
+ */
+struct ObjData
+{
+    std::vector<double> vertices;     ///< Vertex coordinates, three per vertex.
+    std::vector<VertId> triangles;    ///< 0-based vertex indices, three per triangle.
+    std::vector<std::string> groups;  ///< Names of the groups holding at least one triangle, in order of appearance.
+    std::vector<int> triangleGroups;  ///< Index in `groups` of the group of each triangle.
+
+    std::size_t numVertices() const { return vertices.size() / 3; }
+    std::size_t numTriangles() const { return triangles.size() / 3; }
+};
+
+/**
+ * \class ObjReader
+ * \brief A parallel reader of the geometry of Wavefront OBJ files.
+ *
+ * The file is memory-mapped and split into line-aligned chunks parsed in parallel.
+ * A first pass counts the vertices and triangles of every chunk; their prefix sums
+ * give each chunk its place in the output arrays, which a second pass fills directly.
+ * Numbers are parsed with `std::from_chars`.
+ *
+ * Only `v`, `f` and `g` statements are read. Polygons are triangulated as fans around
+ * their first vertex, face vertices may be written as `v`, `v/vt`, `v//vn` or `v/vt/vn`
+ * and negative (relative) indices are supported. Faces before the first `g` statement
+ * belong to the OBJ_DEFAULT_GROUP group.
+ */
+class ObjReader
+{
+public:
+    /**
+     * \brief Reads an OBJ file.
+     *
+     * \param path The path to the file.
+     * \return The vertices, triangles and groups of the file.
+     * \throws std::runtime_error If the file cannot be read or is malformed.
+     */
+    static ObjData read(const std::string &path);
+
+    /**
+     * \brief Parses the content of an OBJ file.
+     *
+     * \param data The content of the file.
+     * \param size The size of the content in bytes.
+     * \param minChunkSize The minimum size of the chunks parsed in parallel.
+     * \return The vertices, triangles and groups of the content.
+     * \throws std::runtime_error If the content is malformed.
+     */
+    static ObjData parse(const char *data, std::size_t size, std::size_t minChunkSize = OBJ_MIN_CHUNK_SIZE);
+};
+
+#endif // OBJ_READER_HPP
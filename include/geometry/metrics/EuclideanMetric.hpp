@@ -101,11 +101,23 @@ public:
      */
     std::vector<Point<PT, PD>> &getPoints() override;
 
+    /**
+     * \brief Sets the data points and rebuilds the KDTree over them.
+     *
+     * \param data The data points, moved into the metric.
+     */
+    void setPoints(std::vector<Point<PT, PD>> data) override;
+
 private:
     Mesh *mesh; /**< Pointer to the mesh object for the metric calculation. */
     double treshold; /**< The threshold value for the metric. */
     std::unique_ptr<KdTree<PT, PD>> kdtree; /**< Pointer to the KDTree used for nearest-neighbor search. */
 
+    /**
+     * \brief Builds the KDTree over the data points, unless the GPU will cluster them.
+     */
+    void buildTree();
+
     /**
      * \brief Filters the data points based on certain criteria.
      * 
@@ -96,9 +96,25 @@ public:
      */
     std::vector<Point<PT, PD>>& getPoints() override;
 
+    /**
+     * \brief Sets the number of landmark faces used to bound the geodesic distances.
+     * 
+     * Landmark distance fields give lower and upper bounds on the distance between
+     * any two faces (triangle inequality), which let the assignment step skip the
+     * seeds that cannot be the closest to a face. Use 0 to always compute the full
+     * distance field of every seed.
+     * 
+     * \param numLandmarks The number of landmarks (farthest-point sampled faces).
+     */
+    void setNumLandmarks(std::size_t numLandmarks) { this->numLandmarks = numLandmarks; }
+
+    static constexpr std::size_t defaultNumLandmarks = 8; /**< Number of landmarks of a new metric. */
+
 protected:
     Mesh *mesh; /**< Pointer to the mesh used in geodesic calculations. */
-    std::unordered_map<FaceId, std::vector<PT>> distances; /**< Stores computed geodesic distances for each face. */
+    std::vector<std::vector<PT>> distances; /**< Stores computed geodesic distances for each centroid (empty if skipped). */
+    std::vector<int> boundedClusters; /**< Cluster of each face when decided by the landmark bounds alone, -1 otherwise. */
+    std::size_t numLandmarks = defaultNumLandmarks; /**< Number of landmarks used to bound the distances (0 disables them). */
     int oldPoints = 0; /**< Keeps track of the number of points from previous iterations. */
     double avgDistances; /**< Stores the average geodesic distance used for convergence checks. */
 
@@ -114,6 +130,15 @@ protected:
      */
     double computeEuclideanDistance(const Point<PT, PD>& a, const Point<PT, PD>& b) const;
 
+    /**
+     * \brief Computes the Euclidean distance between two points given by their coordinates.
+     * 
+     * \param a The PD coordinates of the first point, e.g. a face baricenter of the mesh.
+     * \param b The PD coordinates of the second point.
+     * \return The Euclidean distance between the two points.
+     */
+    double computeEuclideanDistance(const PT *a, const PT *b) const;
+
     /**
      * \brief Computes the geodesic distances starting from a given face using Dijkstra's algorithm.
      * 
@@ -126,6 +151,51 @@ protected:
      */
     virtual std::vector<PT> computeDistances(const FaceId startFace) const;
 
+    /**
+     * \brief Computes the geodesic distances from several starting faces at once.
+     * 
+     * The default implementation runs `computeDistances` for each face in parallel.
+     * Derived metrics can override it to share work between the sources.
+     * 
+     * \param startFaces The starting faces, one per centroid.
+     * \return One vector of geodesic distances for each starting face.
+     */
+    virtual std::vector<std::vector<PT>> computeDistancesBatch(const std::vector<FaceId> &startFaces) const;
+
+    /**
+     * \brief Computes the geodesic distances from a given face up to a maximum radius.
+     * 
+     * Dijkstra's algorithm is stopped as soon as the closest face in the queue is farther
+     * than `radius`: the distances of the faces within the radius are exact, the others
+     * are either upper bounds or the maximum value of PT.
+     * 
+     * \param startFace The starting face from which distances will be calculated.
+     * \param radius The distance after which the search is stopped.
+     * \return A vector of computed geodesic distances for the mesh faces.
+     */
+    std::vector<PT> computeDistancesWithin(const FaceId startFace, const PT radius) const;
+
+    /**
+     * \brief Computes the landmark distance fields and caches them on the mesh.
+     * 
+     * Landmarks are chosen with farthest-point sampling over the geodesic distance,
+     * starting from the first face. Nothing is done if the mesh already holds them.
+     */
+    void setupLandmarks();
+
+    /**
+     * \brief Computes the distance fields of the seeds using the landmark bounds.
+     * 
+     * For each face, the landmark fields give a lower bound |d(l, s) - d(l, f)| and an
+     * upper bound d(l, s) + d(l, f) on the distance between a seed s and the face f.
+     * Faces with a single possible seed are assigned directly (see `boundedClusters`),
+     * and each seed only explores the mesh up to the farthest face it can still win.
+     * Seeds that cannot win any face are not expanded at all.
+     * 
+     * \param seedFaces The face of each centroid.
+     */
+    void setupWithLandmarks(const std::vector<FaceId> &seedFaces);
+
     /**
      * \brief Stores the centroids after the fitting process.
      * 
@@ -142,7 +212,7 @@ protected:
      * \param f2 The second face.
      * \return The dihedral angle between the two faces in radians.
      */
-    double dihedralAngle(const Face& f1, const Face& f2) const;
+    double dihedralAngle(const FaceId f1, const FaceId f2) const;
 
     /**
      * \brief Sets up the average distance between neighbors faces.
@@ -6,8 +6,20 @@
 #include <cmath>
 #include <stdexcept>
 #include <cassert>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <utility>
+#include <cstdint>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
 #include "geometry/mesh/Mesh.hpp"
 #include "geometry/metrics/GeodesicDijkstraMetric.hpp"
+#include "geometry/metrics/HeatSolver.hpp"
+#include "utils/Hash.hpp"
+#include "utils/MappedFile.hpp"
+#include "utils/BinaryIO.hpp"
 
 #ifdef WIN32
 #include <windows.h>
@@ -34,6 +46,10 @@
 
 typedef Eigen::Matrix<double,Eigen::Dynamic,1> VectorXS;
 
+#define HEAT_CACHE_VERSION 2
+#define HEAT_MEMO_SIZE 4
+#define HEAT_CACHE_MAX_BYTES (std::uintmax_t(1) << 30) // Default bound on the size of the on-disk cache
+
 /** 
  * \class GeodesicHeatMetric
  * \brief A class for computing geodesic distances using heat diffusion-based method.
@@ -72,14 +88,101 @@ public:
      */
     std::vector<PT> computeDistances(const FaceId startFace) const override;
 
+    /**
+     * \brief Computes the heat geodesic distances from several starting faces at once.
+     *
+     * All the sources are stacked as the columns of a single right-hand side, so the
+     * diffusion and Poisson solves reuse each factorization once for the whole batch,
+     * and the gradient and divergence become sparse-matrix times dense-matrix products.
+     * Every vertex of a starting face is used as a heat source.
+     *
+     * When there is one starting face per centroid, in the order of the centroids, the
+     * iterative solver starts each column from the previous solution of the same centroid.
+     *
+     * \param startFaces The starting faces, one per centroid.
+     * \return One vector of geodesic distances (per face) for each starting face.
+     */
+    std::vector<std::vector<PT>> computeDistancesBatch(const std::vector<FaceId> &startFaces) const override;
+
+    /**
+     * \brief Sets the directory where the heat operators are cached between runs.
+     *
+     * By default the cache lives in `kmeans_heat_cache` under the system temporary
+     * directory. An empty path disables the on-disk cache. The least recently used
+     * files are removed when the cache grows past the bound of setCacheSizeLimit.
+     *
+     * \param directory The cache directory, created on the first write.
+     */
+    static void setCacheDirectory(const std::string &directory);
+
+    /**
+     * \brief Sets the bound on the total size of the files of the on-disk cache.
+     *
+     * \param bytes The bound, HEAT_CACHE_MAX_BYTES by default. The file just written is
+     *              always kept, so 0 keeps only the operators of the last mesh.
+     */
+    static void setCacheSizeLimit(std::uintmax_t bytes);
+
+    /**
+     * \brief Drops the solvers kept in memory for the last meshes.
+     *
+     * Up to HEAT_MEMO_SIZE solvers, with their factorizations, are kept between metrics.
+     */
+    static void clearMemoryCache();
+
+    /**
+     * \brief Sets the linear solver used by the metrics constructed afterwards.
+     *
+     * \param type `DIRECT` for the sparse factorizations, `ITERATIVE` for preconditioned
+     *             conjugate gradient, `AUTO` (default) to choose from the size of the mesh.
+     */
+    static void setSolverType(HeatSolverType type);
+
 protected:
     /**
-     * \brief Heat geodesics data.
+     * \brief Linear solver of the heat method.
      *
-     * Contains the results and information necessary for performing the heat geodesic
-     * calculations using the igl library.
+     * Holds the gradient and divergence operators and the precomputed solvers. It is
+     * shared with the other metrics built on the same mesh, since it is only read during the solves.
      */
-    igl::HeatGeodesicsData<PT> data_heat;
+    std::shared_ptr<const HeatSolver<PT>> solver;
+
+    /**
+     * \brief The solutions of the previous iteration, used as initial guesses by the iterative solver.
+     *
+     * Column `c` belongs to centroid `c`. Only the batches over the centroids read and
+     * update it, the other solves start cold.
+     */
+    mutable HeatWarmStart<PT> warmStart;
+
+    /**
+     * \brief Computes the heat geodesic distances of a batch, starting the iterative solver from `warm`.
+     */
+    std::vector<std::vector<PT>> solveDistances(const std::vector<FaceId> &startFaces, HeatWarmStart<PT> &warm) const;
+
+    /**
+     * \brief Path of the cache file of the mesh with the given hash, empty if caching is disabled.
+     */
+    static std::string cacheFile(std::uint64_t key);
+
+    /**
+     * \brief Loads the operators from the on-disk cache.
+     *
+     * \return True if a valid cache entry was found for the given key.
+     */
+    static bool loadOperators(std::uint64_t key, HeatOperators<PT> &ops);
+
+    /**
+     * \brief Writes the operators to the on-disk cache. Failures are not fatal.
+     */
+    static void saveOperators(std::uint64_t key, const HeatOperators<PT> &ops);
+
+private:
+    static std::string cacheDirectory;
+    static std::uintmax_t cacheSizeLimit;
+    static HeatSolverType solverType;
+    static std::mutex memoMutex;
+    static std::list<std::pair<std::uint64_t, std::shared_ptr<const HeatSolver<PT>>>> memo;
 };
 
 #endif // GEODESIC_HEAT_METRIC_HPP
\ No newline at end of file
@@ -0,0 +1,187 @@
+#ifndef HEAT_SOLVER_HPP
+#define HEAT_SOLVER_HPP
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <cassert>
+#include <Eigen/Sparse>
+#include <Eigen/IterativeLinearSolvers>
+
+#ifdef WIN32
+#include <windows.h>
+#undef max
+#undef min
+#endif
+#include <igl/min_quad_with_fixed.h>
+#ifdef WIN32
+#undef max
+#undef min
+#endif
+
+#define HEAT_ITERATIVE_MIN_VERTICES 500000
+// The heat is exponentially small far from the sources and its gradient gets normalized,
+// so the diffusion needs a much tighter tolerance than the Poisson problem
+#define HEAT_CG_DIFFUSION_TOLERANCE 1e-14
+#define HEAT_CG_POISSON_TOLERANCE 1e-10
+#define HEAT_POISSON_REGULARIZATION 1e-8
+
+/**
+ * \brief The linear solvers available for the heat method.
+ *
+ * `AUTO` uses the direct factorizations on small meshes and switches to the
+ * iterative solver from HEAT_ITERATIVE_MIN_VERTICES vertices.
+ */
+enum class HeatSolverType
+{
+    AUTO,
+    DIRECT,
+    ITERATIVE
+};
+
+/**
+ * \brief The assembled operators of the heat method, before any factorization.
+ */
+template <typename PT>
+struct HeatOperators
+{
+    Eigen::SparseMatrix<PT> L, M, Grad;
+    Eigen::Matrix<PT, Eigen::Dynamic, 1> dblA;
+    Eigen::VectorXi b;
+};
+
+/**
+ * \brief The previous solutions of a metric, used as initial guesses by the iterative solver.
+ *
+ * Column `c` holds the solution for the seed of centroid `c` at the previous iteration,
+ * which moves little from one iteration to the next.
+ */
+template <typename PT>
+struct HeatWarmStart
+{
+    Eigen::Matrix<PT, Eigen::Dynamic, Eigen::Dynamic> neumann, dirichlet, poisson;
+};
+
+/**
+ * \class HeatSolver
+ * \brief Base class of the linear solvers of the heat method.
+ *
+ * A solver owns the gradient and divergence operators of the mesh and solves the
+ * two linear problems of the heat method, the heat diffusion and the Poisson
+ * equation, for several sources at once (one per column).
+ *
+ * \tparam PT Type of the scalars (e.g., float, double)
+ */
+template <typename PT>
+class HeatSolver
+{
+public:
+    typedef Eigen::Matrix<PT, Eigen::Dynamic, Eigen::Dynamic> MatrixXS;
+
+    virtual ~HeatSolver() = default;
+
+    /**
+     * \brief Builds the solver of the given type from the assembled operators.
+     *
+     * \param type The solver to use, `AUTO` to choose it from the size of the mesh.
+     * \param ops The assembled operators of the mesh.
+     * \param t The time step of the heat diffusion.
+     * \param numFaces The number of faces of the mesh.
+     * \return The solver, ready to be used.
+     * \throws std::runtime_error If the precomputation fails.
+     */
+    static std::shared_ptr<const HeatSolver<PT>> create(HeatSolverType type, HeatOperators<PT> ops, PT t, int numFaces);
+
+    /**
+     * \brief Resolves `AUTO` to the solver used for a mesh with the given number of vertices.
+     */
+    static HeatSolverType resolve(HeatSolverType type, int numVertices);
+
+    /**
+     * \brief Diffuses the heat from the sources, averaging Neumann and Dirichlet boundary conditions.
+     *
+     * \param u0 The heat sources, one column per source.
+     * \param warm The warm start of the caller, updated with the new solutions.
+     * \return The diffused heat, one column per source.
+     */
+    virtual MatrixXS diffuse(const MatrixXS &u0, HeatWarmStart<PT> &warm) const = 0;
+
+    /**
+     * \brief Solves the Poisson equation recovering the distances from the divergence of the unit gradients.
+     *
+     * The solution is defined up to a constant, which is removed by the caller.
+     *
+     * \param divergence The divergence of the normalized gradients, one column per source.
+     * \param warm The warm start of the caller, updated with the new solutions.
+     * \return The distances at the vertices, one column per source.
+     */
+    virtual MatrixXS poisson(const MatrixXS &divergence, HeatWarmStart<PT> &warm) const = 0;
+
+    const Eigen::SparseMatrix<PT> &gradient() const { return Grad; }
+    const Eigen::SparseMatrix<PT> &divergence() const { return Div; }
+    int gradientDimension() const { return ng; }
+
+protected:
+    HeatSolver(HeatOperators<PT> &ops, int numFaces);
+
+    Eigen::SparseMatrix<PT> Grad, Div;
+    int ng;
+};
+
+/**
+ * \class DirectHeatSolver
+ * \brief Solves the heat method with the sparse factorizations of `igl::min_quad_with_fixed`.
+ *
+ * Fast once precomputed, but the factorizations take a lot of memory on large meshes.
+ */
+template <typename PT>
+class DirectHeatSolver : public HeatSolver<PT>
+{
+public:
+    typedef typename HeatSolver<PT>::MatrixXS MatrixXS;
+
+    DirectHeatSolver(HeatOperators<PT> ops, PT t, int numFaces);
+
+    MatrixXS diffuse(const MatrixXS &u0, HeatWarmStart<PT> &warm) const override;
+    MatrixXS poisson(const MatrixXS &divergence, HeatWarmStart<PT> &warm) const override;
+
+private:
+    igl::min_quad_with_fixed_data<PT> Neumann, Dirichlet, Poisson;
+    Eigen::VectorXi b;
+};
+
+/**
+ * \class IterativeHeatSolver
+ * \brief Solves the heat method with conjugate gradient preconditioned by incomplete Cholesky.
+ *
+ * The memory stays close to the size of the operators, so it scales to meshes whose
+ * factorization would not fit in RAM. The singular Poisson system is regularized with
+ * a small multiple of the mass matrix, the remaining constant is removed by the caller.
+ */
+template <typename PT>
+class IterativeHeatSolver : public HeatSolver<PT>
+{
+public:
+    typedef typename HeatSolver<PT>::MatrixXS MatrixXS;
+
+    IterativeHeatSolver(HeatOperators<PT> ops, PT t, int numFaces);
+
+    MatrixXS diffuse(const MatrixXS &u0, HeatWarmStart<PT> &warm) const override;
+    MatrixXS poisson(const MatrixXS &divergence, HeatWarmStart<PT> &warm) const override;
+
+private:
+    typedef Eigen::ConjugateGradient<Eigen::SparseMatrix<PT>, Eigen::Lower | Eigen::Upper, Eigen::IncompleteCholesky<PT>> CGSolver;
+
+    /**
+     * \brief Solves `A X = B`, starting from `guess` when it has the right size.
+     */
+    static MatrixXS solve(const CGSolver &solver, const MatrixXS &B, const MatrixXS &guess);
+
+    // The conjugate gradient keeps a reference to its matrix, so the matrices are stored here
+    Eigen::SparseMatrix<PT> Q, Qinterior, A;
+    CGSolver Neumann, Dirichlet, Poisson;
+    std::vector<int> interior; ///< Vertices not on the boundary, unknowns of the Dirichlet problem.
+};
+
+#endif // HEAT_SOLVER_HPP
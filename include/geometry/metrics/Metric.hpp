@@ -49,7 +49,7 @@ public:
      * This constructor initializes the metric with both centroids and data points.
      * 
      * \param centroids A reference to a vector of centroid points.
-     * \param data A vector of data points used for the metric calculations.
+     * \param data A vector of data points used for the metric calculations, moved into the metric.
      */
     explicit Metric(std::vector<CentroidPoint<PT, PD>> &centroids, std::vector<Point<PT, PD>> data);
 
@@ -89,11 +89,13 @@ public:
     /**
      * \brief Sets the data points for the metric.
      * 
-     * This method sets the data points used in the metric calculation.
+     * This method sets the data points used in the metric calculation. Pass an
+     * rvalue (e.g. with std::move) to hand the points over without a copy.
+     * Derived metrics that index the points override it to rebuild their index.
      * 
      * \param data A vector of data points.
      */
-    void setPoints(std::vector<Point<PT, PD>> data);
+    virtual void setPoints(std::vector<Point<PT, PD>> data);
 
     /**
      * \brief Gets the data points used for the metric calculations.
@@ -124,7 +126,14 @@ protected:
     double threshold; /**< A threshold value used in the metric calculation. */
     std::vector<CentroidPoint<PT, PD>> oldCentroids; /**< Stores the old centroids for comparison. */
     std::vector<CentroidPoint<PT, PD>> *centroids; /**< Pointer to the vector of centroids. */
-    std::vector<Point<PT, PD>> data; /**< Stores the data points used in the metric calculation. */
+    /**
+     * \brief The dataset: the only copy of the points.
+     *
+     * The initializers and the kd-tree of EuclideanMetric refer to the points in place,
+     * so the vector must not be replaced or resized while they are in use, except through
+     * `setPoints`, which derived metrics override to rebuild what indexes the points.
+     */
+    std::vector<Point<PT, PD>> data;
 
     /**
      * \brief Stores the centroids after the fitting process.
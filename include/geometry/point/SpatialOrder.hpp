@@ -0,0 +1,66 @@
+#ifndef SPATIALORDER_HPP
+#define SPATIALORDER_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "geometry/point/Point.hpp"
+
+/**
+ * \def MORTON_KEY_BITS
+ * \brief Number of bits of the Morton keys, shared among the dimensions.
+ */
+#define MORTON_KEY_BITS 63
+
+/**
+ * \class SpatialOrder
+ * \brief Orders points along a Morton (Z-order) space-filling curve.
+ *
+ * Points that are close along the curve are close in space, so storing data in
+ * curve order keeps the neighbors of a point (the faces around a Dijkstra
+ * frontier, the points of a kd-tree leaf) close in memory too.
+ *
+ * The coordinates are quantized on the bounding box of the points, with
+ * MORTON_KEY_BITS / dimensions bits per dimension, and the bits of the dimensions
+ * are interleaved into the key. The keys are sorted with a stable radix sort, so
+ * points with the same key keep their relative order.
+ */
+class SpatialOrder
+{
+public:
+    /**
+     * \brief Computes the Morton key of every point.
+     *
+     * \param coordinates The coordinates of the points, `dimensions` per point.
+     * \param count The number of points.
+     * \param dimensions The number of dimensions of the points.
+     * \return The key of each point.
+     */
+    static std::vector<std::uint64_t> mortonKeys(const double *coordinates, std::size_t count, std::size_t dimensions);
+
+    /**
+     * \brief Computes the Morton order of a set of points.
+     *
+     * \param coordinates The coordinates of the points, `dimensions` per point.
+     * \param count The number of points.
+     * \param dimensions The number of dimensions of the points.
+     * \return The index of the point at each position of the order.
+     */
+    static std::vector<std::uint32_t> mortonOrder(const double *coordinates, std::size_t count, std::size_t dimensions);
+
+    /**
+     * \brief Sorts a point set in Morton order.
+     *
+     * Meant to be called on a dataset before a metric builds its kd-tree on it. The
+     * points keep their ids, the returned permutation maps them back to their
+     * original positions.
+     *
+     * \param points The points, reordered in place.
+     * \return The original position of the point at each position.
+     */
+    template <typename PT, std::size_t PD>
+    static std::vector<std::uint32_t> reorderPoints(std::vector<Point<PT, PD>> &points);
+};
+
+#endif // SPATIALORDER_HPP
@@ -38,11 +38,13 @@ public:
      * \param threshold Convergence threshold for the K-Means algorithm.
      * \param num_initialization_method The method used for initializing centroids.
      * \param kInitializationMethod The method used for choosing initial K-Means centers.
+     * \param seed Seed of the k-means++ initialization.
      */
     MeshSegmentation(Mesh* mesh, int clusters, double threshold, 
-                     int num_initialization_method, int kInitializationMethod)
+                     int num_initialization_method, int kInitializationMethod,
+                     std::uint64_t seed = KMEANS_PP_SEED)
         : metric(M(*mesh, threshold, mesh->getMeshFacesPoints())),
-          kmeans(clusters, threshold, &metric, num_initialization_method, kInitializationMethod),
+          kmeans(clusters, threshold, &metric, num_initialization_method, kInitializationMethod, seed),
           mesh(mesh) {}
 
     /**
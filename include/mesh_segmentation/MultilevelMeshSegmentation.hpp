@@ -0,0 +1,469 @@
+#ifndef MULTILEVEL_MESH_SEGMENTATION_HPP
+#define MULTILEVEL_MESH_SEGMENTATION_HPP
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <limits>
+#include <queue>
+#include <functional>
+#include <type_traits>
+
+#include "geometry/mesh/Mesh.hpp"
+#include "geometry/mesh/MeshCoarsening.hpp"
+#include "geometry/metrics/EuclideanMetric.hpp"
+#include "geometry/metrics/GeodesicDijkstraMetric.hpp"
+#include "geometry/metrics/GeodesicHeatMetric.hpp"
+#include "mesh_segmentation/MeshSegmentation.hpp"
+
+#define MULTILEVEL_COARSE_FACES 4000
+#define MULTILEVEL_REFINE_SWEEPS 3
+
+/**
+ * \brief The metric used to cluster the coarsest level of a multilevel segmentation.
+ *
+ * Coarse levels are face graphs without a triangulation, so the heat metric falls
+ * back to Dijkstra geodesics there; the other metrics are used as they are.
+ */
+template <class M>
+struct CoarseMetric
+{
+    typedef M type;
+};
+
+template <typename PT, std::size_t PD>
+struct CoarseMetric<GeodesicHeatMetric<PT, PD>>
+{
+    typedef GeodesicDijkstraMetric<PT, PD> type;
+};
+
+/**
+ * \class MultilevelMeshSegmentation
+ * \brief Segments a large mesh by clustering a coarse version of it and refining back.
+ *
+ * The face graph is coarsened (see MeshCoarsening) down to about MULTILEVEL_COARSE_FACES
+ * super-faces, K-Means runs on the coarsest level with the chosen metric, and the labels
+ * are projected back level by level. At each level a few refinement sweeps move the faces
+ * on the segment boundaries to the closest adjacent segment, which fixes the blocky
+ * boundaries left by the projection.
+ *
+ * The metric drives the clustering of the coarsest level (through CoarseMetric, so heat
+ * geodesics become Dijkstra geodesics there) and the refinement criterion. With the
+ * Euclidean metric a face goes to the segment with the closest area-weighted centroid.
+ * With the geodesic metrics it goes to the segment with the closest seed face, the face
+ * of the segment nearest to its centroid, in the Dijkstra distance of the face graph
+ * (baricenter distances plus the dihedral term of GeodesicDijkstraMetric). The Dijkstra
+ * of each seed stays inside its segment and the band of faces around it.
+ *
+ * Meshes that are already small are segmented directly, like MeshSegmentation does.
+ *
+ * \tparam M The metric used for measuring distances between points on the mesh (EuclideanMetric, GeodesicDijkstraMetric, GeodesicHeatMetric).
+ */
+template <class M>
+class MultilevelMeshSegmentation
+{
+public:
+    /**
+     * \brief Constructs a MultilevelMeshSegmentation object.
+     *
+     * \param mesh Pointer to the mesh to be segmented.
+     * \param clusters Number of clusters (segments) to create.
+     * \param threshold Convergence threshold for the K-Means algorithm.
+     * \param num_initialization_method The method used for initializing centroids.
+     * \param kInitializationMethod The method used for choosing initial K-Means centers.
+     * \param coarseFaces The number of faces of the coarsest level.
+     * \param seed Seed of the k-means++ initialization.
+     */
+    MultilevelMeshSegmentation(Mesh *mesh, int clusters, double threshold,
+                               int num_initialization_method, int kInitializationMethod,
+                               int coarseFaces = MULTILEVEL_COARSE_FACES,
+                               std::uint64_t seed = KMEANS_PP_SEED)
+        : mesh(mesh), clusters(clusters), threshold(threshold),
+          num_initialization_method(num_initialization_method),
+          kInitializationMethod(kInitializationMethod), coarseFaces(coarseFaces), seed(seed) {}
+
+    /**
+     * \brief Performs the multilevel segmentation and stores the clusters in the mesh.
+     */
+    void fit();
+
+private:
+    /**
+     * \brief Moves the faces on the segment boundaries to the closest adjacent segment.
+     *
+     * \param level The mesh of the current level, with its face adjacency built.
+     * \param labels The segment of each face of the level, updated in place.
+     */
+    void refine(Mesh &level, std::vector<int> &labels) const;
+
+    /**
+     * \brief Proposes for every boundary face the adjacent segment with the closest centroid.
+     *
+     * \return The segment each face should move to, -1 to stay.
+     */
+    static std::vector<int> closestCentroidMoves(const Mesh &level, const std::vector<int> &labels,
+                                                 const std::vector<std::array<double, 3>> &centroids);
+
+    /**
+     * \brief Proposes for every boundary face the adjacent segment with the closest seed face.
+     *
+     * The seed of a segment is its face nearest to the centroid. A bounded Dijkstra from
+     * each seed visits the faces of its segment and stops at the band of faces around it.
+     *
+     * \return The segment each face should move to, -1 to stay.
+     */
+    static std::vector<int> closestSeedMoves(const Mesh &level, const std::vector<int> &labels,
+                                             const std::vector<std::array<double, 3>> &centroids);
+
+    /**
+     * \brief Length of the edge between two adjacent faces, as in GeodesicDijkstraMetric.
+     *
+     * \param avgDistance The average distance between the baricenters of adjacent faces.
+     */
+    static double edgeLength(const Mesh &level, FaceId f, FaceId g, double avgDistance);
+
+    static double baricenterDistance(const Mesh &level, FaceId f, FaceId g);
+
+    Mesh *mesh;                    ///< Pointer to the mesh to be segmented.
+    int clusters;                  ///< Number of clusters, 0 to detect it.
+    double threshold;              ///< Convergence threshold of K-Means.
+    int num_initialization_method; ///< Centroid initialization method.
+    int kInitializationMethod;     ///< Method detecting the number of clusters.
+    int coarseFaces;               ///< Number of faces of the coarsest level.
+    std::uint64_t seed;            ///< Seed of the k-means++ initialization.
+};
+
+template <class M>
+void MultilevelMeshSegmentation<M>::fit()
+{
+    std::vector<Mesh> levels;
+    std::vector<std::vector<FaceId>> parents;
+    MeshCoarsening::buildHierarchy(*mesh, coarseFaces, levels, parents);
+
+    if (levels.empty())
+    {
+        MeshSegmentation<M> segmentation(mesh, clusters, threshold, num_initialization_method, kInitializationMethod, seed);
+        segmentation.fit();
+        return;
+    }
+
+    // Cluster the coarsest level
+    Mesh &coarsest = levels.back();
+    MeshSegmentation<typename CoarseMetric<M>::type> segmentation(&coarsest, clusters, threshold, num_initialization_method, kInitializationMethod, seed);
+    segmentation.fit();
+
+    std::vector<int> labels(coarsest.numFaces());
+    for (FaceId f = 0; f < coarsest.numFaces(); ++f)
+    {
+        labels[f] = coarsest.getFaceCluster(f);
+    }
+
+    // Project back and refine, level by level
+    for (int l = levels.size() - 1; l >= 0; --l)
+    {
+        const std::vector<FaceId> &parent = parents[l];
+        std::vector<int> fineLabels(parent.size());
+        #pragma omp parallel for
+        for (int f = 0; f < parent.size(); ++f)
+        {
+            fineLabels[f] = labels[parent[f]];
+        }
+        labels = std::move(fineLabels);
+
+        refine(l == 0 ? *mesh : levels[l - 1], labels);
+    }
+
+    for (FaceId f = 0; f < mesh->numFaces(); ++f)
+    {
+        mesh->setFaceCluster(f, labels[f]);
+    }
+}
+
+template <class M>
+void MultilevelMeshSegmentation<M>::refine(Mesh &level, std::vector<int> &labels) const
+{
+    const int numFaces = level.numFaces();
+    int numClusters = 0;
+    for (int label : labels)
+    {
+        numClusters = std::max(numClusters, label + 1);
+    }
+
+    for (int sweep = 0; sweep < MULTILEVEL_REFINE_SWEEPS; ++sweep)
+    {
+        // Area-weighted centroids and sizes of the segments
+        std::vector<std::array<double, 3>> centroids(numClusters, {0.0, 0.0, 0.0});
+        std::vector<double> areas(numClusters, 0.0);
+        std::vector<int> sizes(numClusters, 0);
+        #pragma omp parallel
+        {
+            std::vector<std::array<double, 3>> localCentroids(numClusters, {0.0, 0.0, 0.0});
+            std::vector<double> localAreas(numClusters, 0.0);
+            std::vector<int> localSizes(numClusters, 0);
+
+            #pragma omp for nowait
+            for (int f = 0; f < numFaces; ++f)
+            {
+                const double area = level.getFaceArea(f);
+                const Span<const double> baricenter = level.getFaceBaricenter(f);
+                for (int d = 0; d < 3; ++d)
+                {
+                    localCentroids[labels[f]][d] += area * baricenter[d];
+                }
+                localAreas[labels[f]] += area;
+                localSizes[labels[f]]++;
+            }
+
+            #pragma omp critical
+            {
+                for (int c = 0; c < numClusters; ++c)
+                {
+                    for (int d = 0; d < 3; ++d)
+                    {
+                        centroids[c][d] += localCentroids[c][d];
+                    }
+                    areas[c] += localAreas[c];
+                    sizes[c] += localSizes[c];
+                }
+            }
+        }
+        for (int c = 0; c < numClusters; ++c)
+        {
+            for (int d = 0; d < 3; ++d)
+            {
+                centroids[c][d] /= areas[c] > 0 ? areas[c] : 1.0;
+            }
+        }
+
+        // Best adjacent segment of every boundary face, in the distance of the metric
+        const std::vector<int> proposals = std::is_base_of<GeodesicDijkstraMetric<double, 3>, M>::value
+                                               ? closestSeedMoves(level, labels, centroids)
+                                               : closestCentroidMoves(level, labels, centroids);
+
+        // Apply the moves, never emptying a segment
+        int moved = 0;
+        for (int f = 0; f < numFaces; ++f)
+        {
+            if (proposals[f] >= 0 && sizes[labels[f]] > 1)
+            {
+                sizes[labels[f]]--;
+                sizes[proposals[f]]++;
+                labels[f] = proposals[f];
+                moved++;
+            }
+        }
+
+        if (moved == 0)
+        {
+            break;
+        }
+    }
+}
+
+template <class M>
+std::vector<int> MultilevelMeshSegmentation<M>::closestCentroidMoves(const Mesh &level, const std::vector<int> &labels,
+                                                                     const std::vector<std::array<double, 3>> &centroids)
+{
+    const int numFaces = level.numFaces();
+    std::vector<int> proposals(numFaces, -1);
+    #pragma omp parallel for
+    for (int f = 0; f < numFaces; ++f)
+    {
+        const Span<const double> coordinates = level.getFaceBaricenter(f);
+        auto cost = [&](int c)
+        {
+            double dist2 = 0;
+            for (int d = 0; d < 3; ++d)
+            {
+                dist2 += (coordinates[d] - centroids[c][d]) * (coordinates[d] - centroids[c][d]);
+            }
+            return dist2;
+        };
+
+        int best = labels[f];
+        double bestCost = cost(best);
+        for (FaceId g : level.getFaceAdjacencyAt(f))
+        {
+            if (labels[g] != best && labels[g] != labels[f] && cost(labels[g]) < bestCost)
+            {
+                best = labels[g];
+                bestCost = cost(best);
+            }
+        }
+        if (best != labels[f])
+        {
+            proposals[f] = best;
+        }
+    }
+    return proposals;
+}
+
+template <class M>
+std::vector<int> MultilevelMeshSegmentation<M>::closestSeedMoves(const Mesh &level, const std::vector<int> &labels,
+                                                                 const std::vector<std::array<double, 3>> &centroids)
+{
+    const int numFaces = level.numFaces();
+    const int numClusters = centroids.size();
+
+    // Average distance between adjacent baricenters, the scale of the dihedral term
+    double total = 0.0;
+    long long pairs = 0;
+    #pragma omp parallel for reduction(+:total, pairs)
+    for (int f = 0; f < numFaces; ++f)
+    {
+        for (FaceId g : level.getFaceAdjacencyAt(f))
+        {
+            if (f < g)
+            {
+                total += baricenterDistance(level, f, g);
+                pairs++;
+            }
+        }
+    }
+    const double avgDistance = pairs > 0 ? total / pairs : 0.0;
+
+    // Seed of each segment: its face nearest to the centroid
+    std::vector<FaceId> seeds(numClusters, -1);
+    std::vector<double> seedDistances(numClusters, std::numeric_limits<double>::max());
+    for (int f = 0; f < numFaces; ++f)
+    {
+        const Span<const double> baricenter = level.getFaceBaricenter(f);
+        double dist2 = 0;
+        for (int d = 0; d < 3; ++d)
+        {
+            dist2 += (baricenter[d] - centroids[labels[f]][d]) * (baricenter[d] - centroids[labels[f]][d]);
+        }
+        if (dist2 < seedDistances[labels[f]])
+        {
+            seedDistances[labels[f]] = dist2;
+            seeds[labels[f]] = f;
+        }
+    }
+
+    std::vector<char> boundary(numFaces, false);
+    #pragma omp parallel for
+    for (int f = 0; f < numFaces; ++f)
+    {
+        for (FaceId g : level.getFaceAdjacencyAt(f))
+        {
+            boundary[f] |= labels[g] != labels[f];
+        }
+    }
+
+    // Distances of the boundary faces to the seed of their segment and of the adjacent segments
+    std::vector<std::vector<std::pair<FaceId, double>>> reached(numClusters);
+    #pragma omp parallel
+    {
+        std::vector<double> dist(numFaces, std::numeric_limits<double>::max());
+        std::vector<FaceId> touched;
+
+        #pragma omp for schedule(dynamic)
+        for (int c = 0; c < numClusters; ++c)
+        {
+            if (seeds[c] < 0)
+            {
+                continue;
+            }
+
+            std::priority_queue<std::pair<double, FaceId>, std::vector<std::pair<double, FaceId>>, std::greater<>> pq;
+            dist[seeds[c]] = 0;
+            touched.push_back(seeds[c]);
+            pq.push({0, seeds[c]});
+            while (!pq.empty())
+            {
+                auto [currentDistance, f] = pq.top();
+                pq.pop();
+                if (currentDistance > dist[f])
+                {
+                    continue;
+                }
+                if (boundary[f])
+                {
+                    reached[c].emplace_back(f, currentDistance);
+                }
+
+                // The faces of the band are reached but not expanded
+                if (labels[f] != c)
+                {
+                    continue;
+                }
+                for (FaceId g : level.getFaceAdjacencyAt(f))
+                {
+                    const double candidate = currentDistance + edgeLength(level, f, g, avgDistance);
+                    if (candidate < dist[g])
+                    {
+                        if (dist[g] == std::numeric_limits<double>::max())
+                        {
+                            touched.push_back(g);
+                        }
+                        dist[g] = candidate;
+                        pq.push({candidate, g});
+                    }
+                }
+            }
+
+            for (FaceId f : touched)
+            {
+                dist[f] = std::numeric_limits<double>::max();
+            }
+            touched.clear();
+        }
+    }
+
+    std::vector<double> ownCost(numFaces, std::numeric_limits<double>::max());
+    std::vector<double> bestCost(numFaces, std::numeric_limits<double>::max());
+    std::vector<int> proposals(numFaces, -1);
+    for (int c = 0; c < numClusters; ++c)
+    {
+        for (const auto &[f, d] : reached[c])
+        {
+            if (labels[f] == c)
+            {
+                ownCost[f] = d;
+            }
+            else if (d < bestCost[f])
+            {
+                bestCost[f] = d;
+                proposals[f] = c;
+            }
+        }
+    }
+
+    #pragma omp parallel for
+    for (int f = 0; f < numFaces; ++f)
+    {
+        if (proposals[f] >= 0 && bestCost[f] >= ownCost[f])
+        {
+            proposals[f] = -1;
+        }
+    }
+    return proposals;
+}
+
+template <class M>
+double MultilevelMeshSegmentation<M>::edgeLength(const Mesh &level, FaceId f, FaceId g, double avgDistance)
+{
+    const Span<const double> n1 = level.getFaceNormal(f);
+    const Span<const double> n2 = level.getFaceNormal(g);
+    const double norms = std::sqrt((n1[0] * n1[0] + n1[1] * n1[1] + n1[2] * n1[2]) * (n2[0] * n2[0] + n2[1] * n2[1] + n2[2] * n2[2]));
+    double cosTheta = norms > 0 ? (n1[0] * n2[0] + n1[1] * n2[1] + n1[2] * n2[2]) / norms : 1.0;
+    cosTheta = std::max(-1.0, std::min(1.0, cosTheta));
+
+    // Sine of the dihedral angle, scaled by the average distance between adjacent faces
+    return baricenterDistance(level, f, g) + std::sqrt(1 - cosTheta * cosTheta) * avgDistance;
+}
+
+template <class M>
+double MultilevelMeshSegmentation<M>::baricenterDistance(const Mesh &level, FaceId f, FaceId g)
+{
+    const Span<const double> a = level.getFaceBaricenter(f);
+    const Span<const double> b = level.getFaceBaricenter(g);
+    double dist2 = 0;
+    for (int d = 0; d < 3; ++d)
+    {
+        dist2 += (a[d] - b[d]) * (a[d] - b[d]);
+    }
+    return std::sqrt(dist2);
+}
+
+#endif // MULTILEVEL_MESH_SEGMENTATION_HPP
@@ -57,7 +57,7 @@ struct Entry_CE* EvaluateConsistencyError(Segmentation *s1, Segmentation *s2)
       int a = s1->getMesh()->getFaceCluster(face);
       int b = s2->getMesh()->getFaceCluster(face);
       Intersection[a * nSeg2 + b] += 1;
-      AreaIntersection[a * nSeg2 + b] += s1->getMesh()->getFace(face).getArea();
+      AreaIntersection[a * nSeg2 + b] += s1->getMesh()->getFaceArea(face);
     }
 
     // get normalized set/area differences
@@ -36,7 +36,7 @@ struct Entry_HD* EvaluateHammingDistance(Segmentation* s1, Segmentation* s2){
   {
     int i= s1->getMesh()->getFaceCluster(face);
     int j = s2->getMesh()->getFaceCluster(face);
-		intersection[i][j] += s1->getMesh()->getFace(face).getArea();
+		intersection[i][j] += s1->getMesh()->getFaceArea(face);
 	}
 	
 	// Find the best matches
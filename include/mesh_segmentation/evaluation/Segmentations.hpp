@@ -107,7 +107,7 @@ void Segmentation::CreateSegmentation(int k)
     {
         int id = mesh->getFaceCluster(face);
 
-        float faceArea = mesh->getFace(face).getArea();
+        float faceArea = mesh->getFaceArea(face);
         segments[id].addFace(face, faceArea);
         area += faceArea;
     }
@@ -0,0 +1,275 @@
+#ifndef BINARYIO_HPP
+#define BINARYIO_HPP
+
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
+#include <system_error>
+#include <atomic>
+#include <random>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "utils/Hash.hpp"
+
+/**
+ * \brief Writes raw values to a binary stream, in the native byte order.
+ *
+ * \param out The output stream, opened in binary mode.
+ * \param values Pointer to the first value.
+ * \param count Number of values to write.
+ */
+template <typename T>
+void writeValues(std::ofstream &out, const T *values, std::size_t count)
+{
+    out.write(reinterpret_cast<const char *>(values), count * sizeof(T));
+}
+
+/**
+ * \brief Writes a single raw value to a binary stream.
+ */
+template <typename T>
+void writeValue(std::ofstream &out, const T &value)
+{
+    writeValues(out, &value, 1);
+}
+
+/**
+ * \class BinaryReader
+ * \brief Bounds-checked sequential reader over a block of bytes, e.g. a mapped file.
+ *
+ * Values are copied out with `memcpy`, so the block does not need any alignment.
+ */
+class BinaryReader
+{
+public:
+    BinaryReader(const char *data, std::size_t size) : cursor(data), end(data + size) {}
+
+    /**
+     * \brief Returns a pointer to the next `bytes` bytes and moves past them.
+     *
+     * \throws std::runtime_error If fewer bytes are left.
+     */
+    const char *take(std::size_t bytes)
+    {
+        if (static_cast<std::size_t>(end - cursor) < bytes)
+        {
+            throw std::runtime_error("Truncated binary file");
+        }
+        const char *data = cursor;
+        cursor += bytes;
+        return data;
+    }
+
+    template <typename T>
+    void readValues(T *values, std::size_t count)
+    {
+        const std::size_t bytes = count * sizeof(T);
+        std::memcpy(values, take(bytes), bytes);
+    }
+
+    template <typename T>
+    T readValue()
+    {
+        T value;
+        readValues(&value, 1);
+        return value;
+    }
+
+private:
+    const char *cursor;
+    const char *end;
+};
+
+/**
+ * \brief Returns the directory `name` under the system temporary directory, empty if there is none.
+ */
+inline std::string defaultCacheDirectory(const std::string &name)
+{
+    std::error_code ec;
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path(ec);
+    return ec ? std::string() : (tmp / name).string();
+}
+
+/**
+ * \brief Checks the checksum that writeFileAtomically appends to a file.
+ *
+ * \param data The content of the file, e.g. a mapped file.
+ * \param size The size of the file.
+ * \return The size of the content before the checksum.
+ * \throws std::runtime_error If the file is too short or the checksum does not match.
+ */
+inline std::size_t verifyChecksum(const char *data, std::size_t size)
+{
+    if (size < sizeof(std::uint64_t))
+    {
+        throw std::runtime_error("Truncated binary file");
+    }
+    const std::size_t contentSize = size - sizeof(std::uint64_t);
+    std::uint64_t checksum;
+    std::memcpy(&checksum, data + contentSize, sizeof(checksum));
+    if (fnv1a(data, contentSize) != checksum)
+    {
+        throw std::runtime_error("Checksum mismatch");
+    }
+    return contentSize;
+}
+
+/**
+ * \brief Returns a temporary path next to `path`, unique among the processes and threads.
+ */
+inline std::string uniqueTemporaryPath(const std::string &path)
+{
+    static std::atomic<std::uint64_t> counter{0};
+#ifdef _WIN32
+    const std::uint64_t pid = _getpid();
+#else
+    const std::uint64_t pid = getpid();
+#endif
+    std::uint64_t salt = std::random_device()();
+    salt = fnv1a(&pid, sizeof(pid), salt);
+    const std::uint64_t count = counter++;
+    salt = fnv1a(&count, sizeof(count), salt);
+    return path + "." + std::to_string(pid) + "." + hashToString(salt) + ".tmp";
+}
+
+/**
+ * \brief Writes a file through a temporary file renamed at the end.
+ *
+ * A concurrent reader never sees a partial file, and concurrent writers of the same path
+ * use distinct temporary files. The FNV-1a hash of the content is appended to the file,
+ * to be checked with verifyChecksum. Failures are silent (the function returns false),
+ * since the files written this way are caches.
+ *
+ * \param path The path of the file to write, its directory is created if needed.
+ * \param write Callback writing the content to the given stream.
+ * \return True if the file has been written.
+ */
+template <typename Writer>
+bool writeFileAtomically(const std::string &path, Writer write)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+    const std::string tmpPath = uniqueTemporaryPath(path);
+    bool written = false;
+    {
+        std::ofstream out(tmpPath, std::ios::binary);
+        if (!out)
+        {
+            return false;
+        }
+        write(out);
+        written = static_cast<bool>(out);
+    }
+
+    // Checksum of the content, read back in blocks
+    if (written)
+    {
+        std::uint64_t checksum = FNV_OFFSET_BASIS;
+        {
+            std::ifstream in(tmpPath, std::ios::binary);
+            char buffer[1 << 16];
+            while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0)
+            {
+                checksum = fnv1a(buffer, in.gcount(), checksum);
+            }
+            written = in.eof();
+        }
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::app);
+        writeValue(out, checksum);
+        written = written && out;
+    }
+
+    if (written)
+    {
+        std::filesystem::rename(tmpPath, path, ec);
+    }
+    if (!written || ec)
+    {
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * \brief Marks a cache file as recently used, for the eviction of pruneCacheDirectory.
+ */
+inline void touchCacheFile(const std::string &path)
+{
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+}
+
+/**
+ * \brief Removes the least recently written files with the given extension until the
+ * directory holds at most `maxBytes` of them.
+ *
+ * Failures are silent, the files are caches. The file `keep`, usually the one just
+ * written, is never removed, even if it is larger than the bound on its own.
+ *
+ * \param directory The cache directory.
+ * \param extension The extension of the cache files, e.g. `.heat`.
+ * \param maxBytes The bound on the total size of the cache files.
+ * \param keep Path of a file to keep.
+ */
+inline void pruneCacheDirectory(const std::string &directory, const std::string &extension, std::uintmax_t maxBytes, const std::string &keep = std::string())
+{
+    struct Entry
+    {
+        std::filesystem::file_time_type time;
+        std::uintmax_t size;
+        std::filesystem::path path;
+    };
+
+    std::error_code ec;
+    std::vector<Entry> entries;
+    std::uintmax_t total = 0;
+    for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec))
+    {
+        const std::filesystem::path &path = it->path();
+        std::error_code entryEc;
+        if (path.extension() != extension || !it->is_regular_file(entryEc))
+        {
+            continue;
+        }
+        const std::uintmax_t size = it->file_size(entryEc);
+        const std::filesystem::file_time_type time = it->last_write_time(entryEc);
+        if (entryEc)
+        {
+            continue;
+        }
+        total += size;
+        if (path != std::filesystem::path(keep))
+        {
+            entries.push_back({time, size, path});
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b)
+              { return a.time < b.time; });
+    for (const Entry &entry : entries)
+    {
+        if (total <= maxBytes)
+        {
+            break;
+        }
+        std::error_code removeEc;
+        if (std::filesystem::remove(entry.path, removeEc))
+        {
+            total -= entry.size;
+        }
+    }
+}
+
+#endif // BINARYIO_HPP
@@ -5,28 +5,57 @@
 #include <vector>
 #include <string>
 #include <stdexcept>
+#include <charconv>
+#include <atomic>
+#include <algorithm>
 #include "csv.hpp"
 #include "geometry/point/Point.hpp"
+#include "utils/MappedFile.hpp"
+#include "utils/LineChunks.hpp"
+
+#define CSV_MIN_CHUNK_SIZE (1 << 20)
+#define CSV_CHUNKS_PER_THREAD 4
+
+/**
+ * \brief The content of a numeric CSV file, stored by column.
+ *
+ * \tparam PT The type of the values.
+ */
+template <typename PT>
+struct CSVColumns
+{
+    std::vector<std::string> header;      ///< Names of the columns, empty if the file has no header.
+    std::vector<std::vector<PT>> columns; ///< Values of each column, in row order.
+
+    std::size_t numColumns() const { return columns.size(); }
+    std::size_t numRows() const { return columns.empty() ? 0 : columns[0].size(); }
+};
 
 /**
  * \class CSVUtils
  * \brief A static utility class for handling CSV file operations.
- * 
- * The `CSVUtils` class provides a static method to read a CSV file and convert 
- * its rows into `Point` objects. This enables easy integration of CSV data 
+ *
+ * The `CSVUtils` class provides a static method to read a CSV file and convert
+ * its rows into `Point` objects. This enables easy integration of CSV data
  * into geometric computations.
+ *
+ * Plain numeric files take a fast path: the file is memory-mapped, the header and
+ * the delimiter are detected on the first line, and line-aligned chunks are parsed
+ * in parallel with `std::from_chars` straight into preallocated storage. Files the
+ * fast path cannot handle (quoted fields, non-numeric values, ragged rows) go
+ * through the generic `csv::CSVReader`.
  */
 class CSVUtils
 {
 public:
     /**
      * \brief Reads a CSV file and converts its rows into `Point` objects.
-     * 
-     * This static method processes a CSV file where each row corresponds to a 
-     * `Point` in a multi-dimensional space. The method ensures that each row 
-     * has the correct number of dimensions and converts the data into numerical 
+     *
+     * This static method processes a CSV file where each row corresponds to a
+     * `Point` in a multi-dimensional space. The method ensures that each row
+     * has the correct number of dimensions and converts the data into numerical
      * values of type `PT`.
-     * 
+     *
      * \tparam PT The data type of the point coordinates (e.g., `float`, `double`, `int`).
      * \tparam PD The number of dimensions of each point (e.g., 2 for 2D, 3 for 3D).
      * \param filepath The path to the CSV file.
@@ -35,6 +64,97 @@ public:
      */
     template <typename PT, std::size_t PD>
     static std::vector<Point<PT, PD>> readCSV(const std::string &filepath)
+    {
+        std::vector<Point<PT, PD>> points;
+        std::vector<std::string> header;
+        std::size_t dimensions = 0;
+        bool parsed = false;
+        try
+        {
+            MappedFile file(filepath);
+            parsed = parseNumeric<PT>(file.data(), file.size(), CSV_MIN_CHUNK_SIZE, header,
+                [&](std::size_t rows, std::size_t columns)
+                {
+                    dimensions = columns;
+                    if (columns == PD)
+                    {
+                        points.resize(rows);
+                    }
+                    return columns == PD;
+                },
+                [&](std::size_t row, std::size_t column, PT value)
+                {
+                    points[row].coordinates[column] = value;
+                });
+        }
+        catch (const std::exception &e)
+        {
+            throw std::runtime_error(std::string("Error reading CSV: ") + e.what());
+        }
+
+        if (parsed)
+        {
+            return points;
+        }
+        if (dimensions != 0 && dimensions != PD)
+        {
+            throw std::runtime_error("Error reading CSV: Row does not have the correct number of dimensions: " + std::to_string(dimensions));
+        }
+        return readCSVGeneric<PT, PD>(filepath);
+    }
+
+    /**
+     * \brief Reads a numeric CSV file into columns, with the fast path only.
+     *
+     * \tparam PT The type of the values.
+     * \param filepath The path to the CSV file.
+     * \return The header and the columns of the file.
+     * \throws std::runtime_error If the file cannot be opened or is not a plain numeric CSV file.
+     */
+    template <typename PT>
+    static CSVColumns<PT> readColumns(const std::string &filepath)
+    {
+        MappedFile file(filepath);
+        return parseColumns<PT>(file.data(), file.size());
+    }
+
+    /**
+     * \brief Parses the content of a numeric CSV file into columns.
+     *
+     * \tparam PT The type of the values.
+     * \param data The content of the file.
+     * \param size The size of the content in bytes.
+     * \param minChunkSize The minimum size of the chunks parsed in parallel.
+     * \return The header and the columns of the content.
+     * \throws std::runtime_error If the content is not a plain numeric CSV file.
+     */
+    template <typename PT>
+    static CSVColumns<PT> parseColumns(const char *data, std::size_t size, std::size_t minChunkSize = CSV_MIN_CHUNK_SIZE)
+    {
+        CSVColumns<PT> csv;
+        const bool parsed = parseNumeric<PT>(data, size, minChunkSize, csv.header,
+            [&](std::size_t rows, std::size_t columns)
+            {
+                csv.columns.assign(columns, std::vector<PT>(rows));
+                return true;
+            },
+            [&](std::size_t row, std::size_t column, PT value)
+            {
+                csv.columns[column][row] = value;
+            });
+        if (!parsed)
+        {
+            throw std::runtime_error("Error reading CSV: Not a numeric CSV file");
+        }
+        return csv;
+    }
+
+private:
+    /**
+     * \brief Reads a CSV file with the generic `csv::CSVReader`, row by row.
+     */
+    template <typename PT, std::size_t PD>
+    static std::vector<Point<PT, PD>> readCSVGeneric(const std::string &filepath)
     {
         std::vector<Point<PT, PD>> points; // Collection to store the parsed Points
 
@@ -77,6 +197,187 @@ public:
 
         return points;
     }
+
+    static bool isBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    static bool isBlankLine(const char *begin, const char *end)
+    {
+        while (begin < end && isBlank(*begin))
+        {
+            ++begin;
+        }
+        return begin == end;
+    }
+
+    // Parses one field, surrounded by optional blanks
+    template <typename PT>
+    static bool parseField(const char *begin, const char *end, PT &value)
+    {
+        while (begin < end && isBlank(*begin))
+        {
+            ++begin;
+        }
+        while (end > begin && isBlank(end[-1]))
+        {
+            --end;
+        }
+        if (begin < end && *begin == '+')
+        {
+            ++begin;
+        }
+        const auto result = std::from_chars(begin, end, value);
+        return result.ec == std::errc() && result.ptr == end;
+    }
+
+    // Calls `f(begin, end)` for every field of a line, until it returns false
+    template <typename F>
+    static bool forEachField(const char *begin, const char *end, char delimiter, F f)
+    {
+        while (true)
+        {
+            const char *fieldEnd = std::find(begin, end, delimiter);
+            if (!f(begin, fieldEnd))
+            {
+                return false;
+            }
+            if (fieldEnd == end)
+            {
+                return true;
+            }
+            begin = fieldEnd + 1;
+        }
+    }
+
+    /**
+     * \brief Parses a plain numeric CSV content in parallel.
+     *
+     * The first non-blank line gives the delimiter (the first of `,`, `;` or tab it
+     * contains) and the number of columns, and is the header if any of its fields is
+     * not a number. The other lines are counted per chunk, `allocate(rows, columns)`
+     * prepares the storage, and every value is handed to `store(row, column, value)`.
+     *
+     * \return False if `allocate` returns false or a line is not a row of numbers
+     * with the same number of columns as the first line.
+     */
+    template <typename PT, typename Allocate, typename Store>
+    static bool parseNumeric(const char *data, std::size_t size, std::size_t minChunkSize,
+                             std::vector<std::string> &header, Allocate allocate, Store store)
+    {
+        const char *end = data + size;
+        if (size >= 3 && std::equal(data, data + 3, "\xEF\xBB\xBF"))
+        {
+            data += 3; // UTF-8 byte order mark
+        }
+
+        // First line: delimiter, columns and header
+        const char *firstLine = data, *firstLineEnd = data;
+        forEachLine(data, end, [&](const char *begin, const char *lineEnd)
+        {
+            firstLine = begin;
+            firstLineEnd = lineEnd;
+            return isBlankLine(begin, lineEnd);
+        });
+        if (isBlankLine(firstLine, firstLineEnd))
+        {
+            return allocate(0, 0);
+        }
+
+        char delimiter = ',';
+        for (char candidate : {',', ';', '\t'})
+        {
+            if (std::find(firstLine, firstLineEnd, candidate) != firstLineEnd)
+            {
+                delimiter = candidate;
+                break;
+            }
+        }
+
+        std::size_t numColumns = 0;
+        bool numeric = true;
+        std::vector<std::string> names;
+        forEachField(firstLine, firstLineEnd, delimiter, [&](const char *begin, const char *fieldEnd)
+        {
+            PT value;
+            numeric = numeric && parseField(begin, fieldEnd, value);
+            while (begin < fieldEnd && (isBlank(*begin) || *begin == '"'))
+            {
+                ++begin;
+            }
+            while (fieldEnd > begin && (isBlank(fieldEnd[-1]) || fieldEnd[-1] == '"'))
+            {
+                --fieldEnd;
+            }
+            names.emplace_back(begin, fieldEnd);
+            numColumns++;
+            return true;
+        });
+        const char *body = firstLine;
+        if (!numeric)
+        {
+            header = std::move(names);
+            body = firstLineEnd < end ? firstLineEnd + 1 : end;
+        }
+
+        // Count the rows of every chunk, then parse the chunks at their place
+        std::vector<LineChunk> chunks = splitLineChunks(body, end - body, minChunkSize, CSV_CHUNKS_PER_THREAD);
+        std::vector<std::size_t> rowOffsets(chunks.size() + 1, 0);
+        #pragma omp parallel for schedule(dynamic)
+        for (int c = 0; c < chunks.size(); ++c)
+        {
+            std::size_t rows = 0;
+            forEachLine(chunks[c].begin, chunks[c].end, [&](const char *begin, const char *lineEnd)
+            {
+                rows += !isBlankLine(begin, lineEnd);
+                return true;
+            });
+            rowOffsets[c + 1] = rows;
+        }
+        for (std::size_t c = 0; c < chunks.size(); ++c)
+        {
+            rowOffsets[c + 1] += rowOffsets[c];
+        }
+
+        if (!allocate(rowOffsets.back(), numColumns))
+        {
+            return false;
+        }
+
+        std::atomic<bool> valid(true);
+        #pragma omp parallel for schedule(dynamic)
+        for (int c = 0; c < chunks.size(); ++c)
+        {
+            std::size_t row = rowOffsets[c];
+            forEachLine(chunks[c].begin, chunks[c].end, [&](const char *begin, const char *lineEnd)
+            {
+                if (isBlankLine(begin, lineEnd))
+                {
+                    return true;
+                }
+                std::size_t column = 0;
+                const bool parsed = forEachField(begin, lineEnd, delimiter, [&](const char *fieldBegin, const char *fieldEnd)
+                {
+                    PT value;
+                    if (column >= numColumns || !parseField(fieldBegin, fieldEnd, value))
+                    {
+                        return false;
+                    }
+                    store(row, column++, value);
+                    return true;
+                });
+                if (!parsed || column != numColumns)
+                {
+                    valid = false;
+                    return false;
+                }
+                row++;
+                return valid.load(std::memory_order_relaxed);
+            });
+        }
+        return valid;
+    }
 };
 
 #endif // CSVUTILS_HPP
@@ -0,0 +1,45 @@
+#ifndef HASH_HPP
+#define HASH_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <cstdio>
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+/**
+ * \brief Computes the 64-bit FNV-1a hash of a block of memory.
+ *
+ * The hash is not cryptographic, it is meant to build cache keys from the content
+ * of meshes and datasets. Blocks can be chained by passing the previous hash as seed.
+ *
+ * \param data Pointer to the first byte to hash.
+ * \param size Number of bytes to hash.
+ * \param seed The starting value of the hash.
+ * \return The hash of the block.
+ */
+inline std::uint64_t fnv1a(const void *data, std::size_t size, std::uint64_t seed = FNV_OFFSET_BASIS)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    std::uint64_t hash = seed;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * \brief Formats a hash as a 16-digit hexadecimal string, e.g. to name cache files.
+ */
+inline std::string hashToString(std::uint64_t hash)
+{
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return std::string(buffer);
+}
+
+#endif // HASH_HPP
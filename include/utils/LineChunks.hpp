@@ -0,0 +1,73 @@
+#ifndef LINECHUNKS_HPP
+#define LINECHUNKS_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <omp.h>
+
+/**
+ * \brief A line-aligned part of a text buffer.
+ */
+struct LineChunk
+{
+    const char *begin = nullptr;
+    const char *end = nullptr;
+};
+
+/**
+ * \brief Splits a text buffer into line-aligned chunks, to be parsed in parallel.
+ *
+ * The buffer is cut in about `chunksPerThread` chunks per thread (a few per thread
+ * balance the load), none smaller than `minChunkSize` bytes unless the buffer is,
+ * and every cut is moved forward to the next line start.
+ *
+ * \param data The text.
+ * \param size The size of the text in bytes.
+ * \param minChunkSize The minimum size of a chunk.
+ * \param chunksPerThread The number of chunks per thread.
+ * \return The chunks, covering the whole buffer in order (at least one).
+ */
+inline std::vector<LineChunk> splitLineChunks(const char *data, std::size_t size, std::size_t minChunkSize, std::size_t chunksPerThread)
+{
+    const std::size_t maxChunks = static_cast<std::size_t>(omp_get_max_threads()) * chunksPerThread;
+    const std::size_t numChunks = std::max<std::size_t>(1, std::min(maxChunks, size / std::max<std::size_t>(minChunkSize, 1)));
+
+    std::vector<LineChunk> chunks(numChunks);
+    const char *end = data + size;
+    const char *begin = data;
+    for (std::size_t c = 0; c < numChunks; ++c)
+    {
+        const char *chunkEnd = c + 1 == numChunks ? end : std::max(begin, data + (c + 1) * size / numChunks);
+        if (chunkEnd < end)
+        {
+            const char *newline = static_cast<const char *>(std::memchr(chunkEnd, '\n', end - chunkEnd));
+            chunkEnd = newline ? newline + 1 : end;
+        }
+        chunks[c].begin = begin;
+        chunks[c].end = chunkEnd;
+        begin = chunkEnd;
+    }
+    return chunks;
+}
+
+/**
+ * \brief Calls `f(begin, end)` for every line of a text, without its newline, until `f` returns false.
+ */
+template <typename F>
+void forEachLine(const char *begin, const char *end, F f)
+{
+    while (begin < end)
+    {
+        const char *newline = static_cast<const char *>(std::memchr(begin, '\n', end - begin));
+        const char *lineEnd = newline ? newline : end;
+        if (!f(begin, lineEnd))
+        {
+            return;
+        }
+        begin = newline ? newline + 1 : end;
+    }
+}
+
+#endif // LINECHUNKS_HPP
@@ -0,0 +1,140 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <string>
+#include <cstddef>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#undef max
+#undef min
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \class MappedFile
+ * \brief A read-only memory mapping of a whole file.
+ *
+ * The `MappedFile` class wraps the POSIX `mmap` and the Windows file mapping APIs
+ * behind the same interface. The mapping is released when the object is destroyed.
+ * Empty files are valid and yield a null `data()` with a `size()` of zero.
+ */
+class MappedFile
+{
+public:
+    /**
+     * \brief Maps the given file in memory.
+     *
+     * \param filepath The path to the file to map.
+     * \throws std::runtime_error If the file cannot be opened or mapped.
+     */
+    explicit MappedFile(const std::string &filepath)
+    {
+#ifdef _WIN32
+        file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error("Cannot open file: " + filepath);
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize))
+        {
+            CloseHandle(file);
+            throw std::runtime_error("Cannot read the size of file: " + filepath);
+        }
+        length = static_cast<std::size_t>(fileSize.QuadPart);
+
+        if (length > 0)
+        {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            addr = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+            if (addr == nullptr)
+            {
+                if (mapping)
+                {
+                    CloseHandle(mapping);
+                }
+                CloseHandle(file);
+                throw std::runtime_error("Cannot map file: " + filepath);
+            }
+        }
+#else
+        fd = open(filepath.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("Cannot open file: " + filepath);
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            throw std::runtime_error("Cannot read the size of file: " + filepath);
+        }
+        length = static_cast<std::size_t>(st.st_size);
+
+        if (length > 0)
+        {
+            addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED)
+            {
+                addr = nullptr;
+                close(fd);
+                throw std::runtime_error("Cannot map file: " + filepath);
+            }
+        }
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifdef _WIN32
+        if (addr)
+        {
+            UnmapViewOfFile(addr);
+        }
+        if (mapping)
+        {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+#else
+        if (addr)
+        {
+            munmap(addr, length);
+        }
+        close(fd);
+#endif
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /**
+     * \brief Returns a pointer to the first byte of the file.
+     */
+    const char *data() const { return static_cast<const char *>(addr); }
+
+    /**
+     * \brief Returns the size of the file in bytes.
+     */
+    std::size_t size() const { return length; }
+
+private:
+    void *addr = nullptr;
+    std::size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+#endif // MAPPEDFILE_HPP
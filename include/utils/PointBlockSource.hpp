@@ -0,0 +1,212 @@
+#ifndef POINTBLOCKSOURCE_HPP
+#define POINTBLOCKSOURCE_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <filesystem>
+#include <omp.h>
+
+#include "utils/CSVUtils.hpp"
+#include "utils/PointFile.hpp"
+
+#define STREAM_BLOCK_POINTS (1 << 20)
+#define STREAM_CSV_BLOCK_BYTES (16 << 20)
+
+/**
+ * \class PointBlockSource
+ * \brief A dataset read from disk one block of points at a time.
+ *
+ * Blocks hold the coordinates row by row (PD values per point), in the order of
+ * the file, so a dataset larger than the memory can be processed in passes.
+ *
+ * \tparam PT The type of the coordinates.
+ * \tparam PD The number of dimensions of the points.
+ */
+template <typename PT, std::size_t PD>
+class PointBlockSource
+{
+public:
+    virtual ~PointBlockSource() = default;
+
+    /**
+     * \brief Reads the next block of points.
+     *
+     * \param block The buffer receiving the coordinates, resized as needed.
+     * \return The number of points of the block, 0 at the end of the dataset.
+     */
+    virtual std::size_t read(std::vector<PT> &block) = 0;
+
+    /**
+     * \brief Starts a new pass from the first point.
+     */
+    virtual void rewind() = 0;
+
+    /**
+     * \brief Opens a point file (.kpts extension) or a numeric CSV file.
+     */
+    static std::unique_ptr<PointBlockSource> open(const std::string &path);
+};
+
+/**
+ * \class PointFileBlockSource
+ * \brief Blocks of a fixed number of points, copied from the columns of a mapped point file.
+ */
+template <typename PT, std::size_t PD>
+class PointFileBlockSource : public PointBlockSource<PT, PD>
+{
+public:
+    explicit PointFileBlockSource(const std::string &path, std::size_t blockPoints = STREAM_BLOCK_POINTS)
+        : file(path), blockPoints(std::max<std::size_t>(blockPoints, 1))
+    {
+        if (file.dimensions() != PD)
+        {
+            throw std::runtime_error("Point file has " + std::to_string(file.dimensions()) + " dimensions instead of " + std::to_string(PD));
+        }
+    }
+
+    std::size_t read(std::vector<PT> &block) override
+    {
+        const std::size_t count = std::min(blockPoints, file.numPoints() - next);
+        block.resize(count * PD);
+        switch (file.type())
+        {
+        case PointFileType::FLOAT64:
+            copyBlock<double>(block, count);
+            break;
+        case PointFileType::FLOAT32:
+            copyBlock<float>(block, count);
+            break;
+        case PointFileType::INT32:
+            copyBlock<std::int32_t>(block, count);
+            break;
+        }
+        next += count;
+        return count;
+    }
+
+    void rewind() override
+    {
+        next = 0;
+    }
+
+private:
+    PointFile file;
+    std::size_t blockPoints;
+    std::size_t next = 0;
+
+    template <typename T>
+    void copyBlock(std::vector<PT> &block, std::size_t count) const
+    {
+        for (std::size_t d = 0; d < PD; ++d)
+        {
+            const T *column = file.column<T>(d) + next;
+            #pragma omp parallel for
+            for (std::int64_t i = 0; i < count; ++i)
+            {
+                block[i * PD + d] = static_cast<PT>(column[i]);
+            }
+        }
+    }
+};
+
+/**
+ * \class CSVBlockSource
+ * \brief Blocks of whole lines of a numeric CSV file, parsed with CSVUtils::parseColumns.
+ *
+ * The file is read in chunks of about `blockBytes` bytes, the partial line at the
+ * end of a chunk being carried over to the next one.
+ */
+template <typename PT, std::size_t PD>
+class CSVBlockSource : public PointBlockSource<PT, PD>
+{
+public:
+    explicit CSVBlockSource(const std::string &path, std::size_t blockBytes = STREAM_CSV_BLOCK_BYTES)
+        : in(path, std::ios::binary), blockBytes(std::max<std::size_t>(blockBytes, 1))
+    {
+        if (!in)
+        {
+            throw std::runtime_error("Error reading CSV: Cannot open " + path);
+        }
+    }
+
+    std::size_t read(std::vector<PT> &block) override
+    {
+        // A chunk of blank lines or of the header only is not the end of the file
+        std::size_t count = 0;
+        do
+        {
+            count = readChunk(block);
+        } while (count == 0 && (in || !buffer.empty()));
+        return count;
+    }
+
+    void rewind() override
+    {
+        in.clear();
+        in.seekg(0);
+        buffer.clear();
+        firstChunk = true;
+    }
+
+private:
+    std::ifstream in;
+    std::size_t blockBytes;
+    std::string buffer;
+    bool firstChunk = true;
+
+    std::size_t readChunk(std::vector<PT> &block)
+    {
+        // Complete the carried over line, then cut the chunk after its last newline
+        std::size_t lineEnd = std::string::npos;
+        while (in && lineEnd == std::string::npos)
+        {
+            const std::size_t size = buffer.size();
+            buffer.resize(size + blockBytes);
+            in.read(&buffer[size], blockBytes);
+            buffer.resize(size + in.gcount());
+            lineEnd = buffer.rfind('\n');
+        }
+        const std::size_t chunkSize = in ? lineEnd + 1 : buffer.size();
+
+        // Only the first line of the file can be a header
+        const CSVColumns<PT> csv = CSVUtils::parseColumns<PT>(buffer.data(), chunkSize);
+        if (!firstChunk && !csv.header.empty())
+        {
+            throw std::runtime_error("Error reading CSV: Not a numeric CSV file");
+        }
+        if (csv.numRows() > 0 && csv.numColumns() != PD)
+        {
+            throw std::runtime_error("Error reading CSV: Row does not have the correct number of dimensions: " + std::to_string(csv.numColumns()));
+        }
+        buffer.erase(0, chunkSize);
+        firstChunk = firstChunk && csv.header.empty() && csv.numRows() == 0;
+
+        block.resize(csv.numRows() * PD);
+        #pragma omp parallel for
+        for (std::int64_t i = 0; i < csv.numRows(); ++i)
+        {
+            for (std::size_t d = 0; d < PD; ++d)
+            {
+                block[i * PD + d] = csv.columns[d][i];
+            }
+        }
+        return csv.numRows();
+    }
+};
+
+template <typename PT, std::size_t PD>
+std::unique_ptr<PointBlockSource<PT, PD>> PointBlockSource<PT, PD>::open(const std::string &path)
+{
+    if (std::filesystem::path(path).extension() == ".kpts")
+    {
+        return std::make_unique<PointFileBlockSource<PT, PD>>(path);
+    }
+    return std::make_unique<CSVBlockSource<PT, PD>>(path);
+}
+
+#endif // POINTBLOCKSOURCE_HPP
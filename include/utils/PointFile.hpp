@@ -0,0 +1,320 @@
+#ifndef POINTFILE_HPP
+#define POINTFILE_HPP
+
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <omp.h>
+
+#include "geometry/point/Point.hpp"
+#include "utils/BinaryIO.hpp"
+#include "utils/CSVUtils.hpp"
+#include "utils/MappedFile.hpp"
+
+#define POINT_FILE_MAGIC 0x5354504b // "KPTS"
+#define POINT_FILE_VERSION 1
+#define POINT_FILE_ALIGNMENT 64
+
+/**
+ * \enum PointFileType
+ * \brief Type of the values stored in a point file.
+ */
+enum class PointFileType : std::uint32_t
+{
+    FLOAT64 = 0,
+    FLOAT32 = 1,
+    INT32 = 2
+};
+
+/**
+ * \brief The PointFileType of a C++ type.
+ */
+template <typename T>
+struct PointFileTypeOf;
+
+template <>
+struct PointFileTypeOf<double>
+{
+    static constexpr PointFileType value = PointFileType::FLOAT64;
+};
+
+template <>
+struct PointFileTypeOf<float>
+{
+    static constexpr PointFileType value = PointFileType::FLOAT32;
+};
+
+template <>
+struct PointFileTypeOf<std::int32_t>
+{
+    static constexpr PointFileType value = PointFileType::INT32;
+};
+
+/**
+ * \class PointFile
+ * \brief A memory-mapped binary point file, stored by column.
+ *
+ * The file starts with a POINT_FILE_ALIGNMENT bytes header: magic, version, number
+ * of points N, number of dimensions D and value type, in the byte order of the
+ * machine. The D columns follow, each one a block of N values starting at a multiple
+ * of POINT_FILE_ALIGNMENT bytes, so the columns can be used in place from the map,
+ * without parsing.
+ *
+ * The same format stores the labels (one INT32 column) and the centroids (one point
+ * per centroid) of a clustering.
+ */
+class PointFile
+{
+public:
+    /**
+     * \brief Maps a point file and validates its header.
+     *
+     * \param path The path to the file.
+     * \throws std::runtime_error If the file cannot be read or is not a valid point file.
+     */
+    explicit PointFile(const std::string &path) : file(path)
+    {
+        BinaryReader reader(file.data(), file.size());
+        try
+        {
+            if (reader.readValue<std::uint32_t>() != POINT_FILE_MAGIC || reader.readValue<std::uint32_t>() != POINT_FILE_VERSION)
+            {
+                throw std::runtime_error("Not a point file");
+            }
+            points = reader.readValue<std::uint64_t>();
+            dims = reader.readValue<std::uint32_t>();
+            valueType = static_cast<PointFileType>(reader.readValue<std::uint32_t>());
+            if (valueType != PointFileType::FLOAT64 && valueType != PointFileType::FLOAT32 && valueType != PointFileType::INT32)
+            {
+                throw std::runtime_error("Unknown value type");
+            }
+            // Checked before the offsets, whose products would wrap for a huge N, with
+            // half of the range left for the padding of the columns
+            if (points > (SIZE_MAX - POINT_FILE_ALIGNMENT) / typeSize(valueType) / std::max<std::size_t>(dims, 1) / 2)
+            {
+                throw std::runtime_error("Too many points");
+            }
+            if (file.size() < columnOffset(dims, points, typeSize(valueType)))
+            {
+                throw std::runtime_error("Truncated point file");
+            }
+        }
+        catch (const std::exception &e)
+        {
+            throw std::runtime_error("Invalid point file " + path + ": " + e.what());
+        }
+    }
+
+    std::size_t numPoints() const { return points; }
+    std::size_t dimensions() const { return dims; }
+    PointFileType type() const { return valueType; }
+
+    /**
+     * \brief Gets a column of the file, in place in the map.
+     *
+     * \tparam T The type of the values, which must be the type of the file.
+     * \param d The dimension of the column.
+     * \return A pointer to the numPoints values of the column.
+     * \throws std::invalid_argument If the type or the dimension do not match the file.
+     */
+    template <typename T>
+    const T *column(std::size_t d) const
+    {
+        if (PointFileTypeOf<T>::value != valueType || d >= dims)
+        {
+            throw std::invalid_argument("Column type or dimension does not match the point file");
+        }
+        return reinterpret_cast<const T *>(file.data() + columnOffset(d, points, sizeof(T)));
+    }
+
+    /**
+     * \brief Copies a range of points of the file into `Point` objects.
+     *
+     * The values are converted to PT, and every point gets its index in the file as id.
+     *
+     * \param begin The index of the first point.
+     * \param end The index after the last point, clamped to the number of points.
+     * \return The points of the range.
+     * \throws std::runtime_error If the file has not PD dimensions.
+     */
+    template <typename PT, std::size_t PD>
+    std::vector<Point<PT, PD>> readPoints(std::size_t begin = 0, std::size_t end = std::numeric_limits<std::size_t>::max()) const
+    {
+        if (dims != PD)
+        {
+            throw std::runtime_error("Point file has " + std::to_string(dims) + " dimensions instead of " + std::to_string(PD));
+        }
+        end = std::min(end, points);
+        begin = std::min(begin, end);
+
+        std::vector<Point<PT, PD>> result(end - begin);
+        switch (valueType)
+        {
+        case PointFileType::FLOAT64:
+            copyPoints<double>(result, begin);
+            break;
+        case PointFileType::FLOAT32:
+            copyPoints<float>(result, begin);
+            break;
+        case PointFileType::INT32:
+            copyPoints<std::int32_t>(result, begin);
+            break;
+        }
+        return result;
+    }
+
+    /**
+     * \brief Writes columns of values to a point file.
+     *
+     * \param path The path to the output file.
+     * \param columns Pointers to the values of each column.
+     * \param numPoints The number of values of each column.
+     * \throws std::runtime_error If the file cannot be written.
+     */
+    template <typename T>
+    static void writeColumns(const std::string &path, const std::vector<const T *> &columns, std::size_t numPoints)
+    {
+        std::ofstream out(path, std::ios::binary);
+        if (!out)
+        {
+            throw std::runtime_error("Cannot write point file: " + path);
+        }
+
+        writeHeader<T>(out, numPoints, columns.size());
+        for (const T *column : columns)
+        {
+            writeValues(out, column, numPoints);
+            writeColumnPadding<T>(out, numPoints);
+        }
+
+        if (!out.flush())
+        {
+            throw std::runtime_error("Cannot write point file: " + path);
+        }
+    }
+
+    /**
+     * \brief Writes the header of a point file, padded to the first column.
+     *
+     * With writeColumnPadding, lets a writer stream the columns one after the other.
+     */
+    template <typename T>
+    static void writeHeader(std::ofstream &out, std::size_t numPoints, std::size_t numColumns)
+    {
+        writeValue<std::uint32_t>(out, POINT_FILE_MAGIC);
+        writeValue<std::uint32_t>(out, POINT_FILE_VERSION);
+        writeValue<std::uint64_t>(out, numPoints);
+        writeValue<std::uint32_t>(out, numColumns);
+        writeValue<std::uint32_t>(out, static_cast<std::uint32_t>(PointFileTypeOf<T>::value));
+        writePadding(out, POINT_FILE_ALIGNMENT - 4 * sizeof(std::uint32_t) - sizeof(std::uint64_t));
+    }
+
+    /**
+     * \brief Writes the padding after the numPoints values of a column.
+     */
+    template <typename T>
+    static void writeColumnPadding(std::ofstream &out, std::size_t numPoints)
+    {
+        const std::size_t bytes = numPoints * sizeof(T);
+        writePadding(out, columnOffset(1, numPoints, sizeof(T)) - POINT_FILE_ALIGNMENT - bytes);
+    }
+
+    /**
+     * \brief Writes points to a point file, in the order of the vector.
+     */
+    template <typename PT, std::size_t PD>
+    static void writePoints(const std::string &path, const std::vector<Point<PT, PD>> &data)
+    {
+        std::vector<std::vector<PT>> columns(PD, std::vector<PT>(data.size()));
+        #pragma omp parallel for
+        for (std::int64_t i = 0; i < data.size(); ++i)
+        {
+            for (std::size_t d = 0; d < PD; ++d)
+            {
+                columns[d][i] = data[i].coordinates[d];
+            }
+        }
+        writeColumns(path, columnPointers(columns), data.size());
+    }
+
+    /**
+     * \brief Writes one label per point to a point file with a single INT32 column.
+     */
+    static void writeLabels(const std::string &path, const std::vector<std::int32_t> &labels)
+    {
+        writeColumns<std::int32_t>(path, {labels.data()}, labels.size());
+    }
+
+    /**
+     * \brief Converts a numeric CSV file to a FLOAT64 point file, column by column.
+     *
+     * \param csvPath The path to the CSV file (see CSVUtils::readColumns).
+     * \param path The path to the output point file.
+     */
+    static void convertCSV(const std::string &csvPath, const std::string &path)
+    {
+        const CSVColumns<double> csv = CSVUtils::readColumns<double>(csvPath);
+        writeColumns(path, columnPointers(csv.columns), csv.numRows());
+    }
+
+private:
+    MappedFile file;
+    std::size_t points = 0;
+    std::size_t dims = 0;
+    PointFileType valueType = PointFileType::FLOAT64;
+
+    static void writePadding(std::ofstream &out, std::size_t bytes)
+    {
+        static const char zeros[POINT_FILE_ALIGNMENT] = {};
+        out.write(zeros, bytes);
+    }
+
+    static std::size_t typeSize(PointFileType type)
+    {
+        return type == PointFileType::FLOAT64 ? sizeof(double) : sizeof(std::int32_t);
+    }
+
+    // Offset of column d, the header being padded like the columns
+    static std::size_t columnOffset(std::size_t d, std::size_t numPoints, std::size_t valueSize)
+    {
+        const std::size_t columnBytes = (numPoints * valueSize + POINT_FILE_ALIGNMENT - 1) / POINT_FILE_ALIGNMENT * POINT_FILE_ALIGNMENT;
+        return POINT_FILE_ALIGNMENT + d * columnBytes;
+    }
+
+    template <typename T>
+    static std::vector<const T *> columnPointers(const std::vector<std::vector<T>> &columns)
+    {
+        std::vector<const T *> pointers;
+        for (const std::vector<T> &column : columns)
+        {
+            pointers.push_back(column.data());
+        }
+        return pointers;
+    }
+
+    template <typename T, typename PT, std::size_t PD>
+    void copyPoints(std::vector<Point<PT, PD>> &result, std::size_t begin) const
+    {
+        std::vector<const T *> columns(PD);
+        for (std::size_t d = 0; d < PD; ++d)
+        {
+            columns[d] = column<T>(d) + begin;
+        }
+        #pragma omp parallel for
+        for (std::int64_t i = 0; i < result.size(); ++i)
+        {
+            for (std::size_t d = 0; d < PD; ++d)
+            {
+                result[i].coordinates[d] = static_cast<PT>(columns[d][i]);
+            }
+            result[i].id = begin + i;
+        }
+    }
+};
+
+#endif // POINTFILE_HPP
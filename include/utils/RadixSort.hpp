@@ -0,0 +1,78 @@
+#ifndef RADIXSORT_HPP
+#define RADIXSORT_HPP
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <omp.h>
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+
+/**
+ * \brief Sorts (key, value) pairs by key with a parallel LSD radix sort, one byte per pass.
+ *
+ * Each thread counts the digits of its block, the counts give every (digit, thread)
+ * its range of the output, and each thread scatters its block there, keeping the order:
+ * the sort is stable. Only the bytes below the highest set bit of the largest key are
+ * sorted, so small keys take few passes.
+ *
+ * \param keys The keys, sorted in place.
+ * \param values The values, moved along with their keys.
+ */
+inline void radixSortPairs(std::vector<std::uint64_t> &keys, std::vector<std::uint32_t> &values)
+{
+    const std::int64_t n = keys.size();
+    std::uint64_t maxKey = 0;
+    #pragma omp parallel for reduction(max : maxKey)
+    for (std::int64_t i = 0; i < n; ++i)
+    {
+        maxKey = std::max(maxKey, keys[i]);
+    }
+
+    std::vector<std::uint64_t> keysOut(n);
+    std::vector<std::uint32_t> valuesOut(n);
+    std::vector<std::int64_t> counts(omp_get_max_threads() * RADIX_BUCKETS);
+    for (int shift = 0; shift < 64 && (maxKey >> shift) > 0; shift += RADIX_BITS)
+    {
+        #pragma omp parallel
+        {
+            const int thread = omp_get_thread_num();
+            const int numThreads = omp_get_num_threads();
+            const std::int64_t begin = n * thread / numThreads, end = n * (thread + 1) / numThreads;
+            std::int64_t *count = counts.data() + thread * RADIX_BUCKETS;
+
+            std::fill(count, count + RADIX_BUCKETS, 0);
+            for (std::int64_t i = begin; i < end; ++i)
+            {
+                count[(keys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+            }
+            #pragma omp barrier
+
+            #pragma omp single
+            {
+                std::int64_t offset = 0;
+                for (int digit = 0; digit < RADIX_BUCKETS; ++digit)
+                {
+                    for (int t = 0; t < numThreads; ++t)
+                    {
+                        const std::int64_t size = counts[t * RADIX_BUCKETS + digit];
+                        counts[t * RADIX_BUCKETS + digit] = offset;
+                        offset += size;
+                    }
+                }
+            }
+
+            for (std::int64_t i = begin; i < end; ++i)
+            {
+                const std::int64_t position = count[(keys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+                keysOut[position] = keys[i];
+                valuesOut[position] = values[i];
+            }
+        }
+        keys.swap(keysOut);
+        values.swap(valuesOut);
+    }
+}
+
+#endif // RADIXSORT_HPP
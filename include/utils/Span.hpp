@@ -0,0 +1,45 @@
+#ifndef SPAN_HPP
+#define SPAN_HPP
+
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * \class Span
+ * \brief A non-owning view over a contiguous sequence of values.
+ *
+ * A minimal stand-in for C++20 `std::span`: the view is invalidated when the
+ * underlying storage is resized or destroyed.
+ *
+ * \tparam T The type of the values, const-qualified for read-only views.
+ */
+template <typename T>
+class Span
+{
+public:
+    Span() = default;
+
+    Span(T *data, std::size_t size) : ptr(data), length(size) {}
+
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T> || std::is_same_v<U, T>>>
+    Span(std::vector<U> &vector) : ptr(vector.data()), length(vector.size()) {}
+
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+    Span(const std::vector<U> &vector) : ptr(vector.data()), length(vector.size()) {}
+
+    T *data() const { return ptr; }
+    std::size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+
+    T &operator[](std::size_t i) const { return ptr[i]; }
+
+    T *begin() const { return ptr; }
+    T *end() const { return ptr + length; }
+
+private:
+    T *ptr = nullptr;
+    std::size_t length = 0;
+};
+
+#endif // SPAN_HPP
@@ -26,7 +26,7 @@ static void BM_MeshSegmentation(benchmark::State& state) {
     std::string file_name = mesh_files[num_file];
     Mesh mesh(file_name);
 
-    int n = mesh.getMeshFacesPoints().size();
+    int n = mesh.numFaces();
 
     int num_clusters = 5;  
     int num_initialization_method = 2; 
@@ -0,0 +1,214 @@
+#include "clustering/CentroidInitializationMethods/BinnedKDE.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <omp.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+template <std::size_t PD>
+BinnedKDE<PD>::BinnedKDE(const std::vector<Point<double, PD>> &data, const std::array<double, PD> &origin,
+                         const std::array<double, PD> &step, const std::array<std::size_t, PD> &extents)
+    : m_data(data), m_origin(origin), m_step(step), m_extents(extents)
+{
+    for (std::size_t dim = 0; dim < PD; ++dim)
+    {
+        m_extents[dim] = std::max<std::size_t>(m_extents[dim], 1);
+    }
+}
+
+template <std::size_t PD>
+std::vector<double> BinnedKDE<PD>::weights() const
+{
+    std::array<std::size_t, PD> refinement;
+    refinement.fill(1);
+    return bin(refinement);
+}
+
+template <std::size_t PD>
+bool BinnedKDE<PD>::refinement(const Eigen::MatrixXd &bandwidth, std::array<std::size_t, PD> &refinement) const
+{
+    // The sought number of nodes per bandwidth first, then the smallest acceptable one
+    for (double oversampling : {KDE_BINNED_OVERSAMPLING, KDE_BINNED_MIN_OVERSAMPLING})
+    {
+        double totalNodes = 1.0;
+        for (std::size_t dim = 0; dim < PD; ++dim)
+        {
+            const double h = std::sqrt(bandwidth(dim, dim));
+            refinement[dim] = 1;
+            if (m_extents[dim] > 1 && m_step[dim] > 0 && h > 0)
+            {
+                refinement[dim] = static_cast<std::size_t>(std::max(1.0, std::ceil(oversampling * m_step[dim] / h)));
+            }
+            totalNodes *= static_cast<double>(m_extents[dim] - 1) * refinement[dim] + 1;
+        }
+        if (totalNodes <= static_cast<double>(KDE_BINNED_MAX_NODES))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <std::size_t PD>
+bool BinnedKDE<PD>::resolves(const Eigen::MatrixXd &bandwidth) const
+{
+    std::array<std::size_t, PD> unused;
+    return bandwidth.rows() == PD && bandwidth.cols() == PD && refinement(bandwidth, unused);
+}
+
+template <std::size_t PD>
+std::vector<double> BinnedKDE<PD>::bin(const std::array<std::size_t, PD> &refinement) const
+{
+    std::array<double, PD> step;
+    std::array<std::size_t, PD> extents, strides;
+    std::size_t totalNodes = 1;
+    for (std::size_t dim = 0; dim < PD; ++dim)
+    {
+        step[dim] = m_step[dim] / refinement[dim];
+        extents[dim] = (m_extents[dim] - 1) * refinement[dim] + 1;
+        strides[dim] = totalNodes;
+        totalNodes *= extents[dim];
+    }
+    std::vector<double> weights(totalNodes, 0.0);
+
+    // Linear binning, on thread-local grids merged at the end
+    #pragma omp parallel
+    {
+        std::vector<double> localWeights(totalNodes, 0.0);
+
+        #pragma omp for
+        for (std::size_t i = 0; i < m_data.size(); ++i)
+        {
+            // Lower node of the cell of the point and position of the point in the cell
+            std::size_t base = 0;
+            std::array<double, PD> fraction;
+            for (std::size_t dim = 0; dim < PD; ++dim)
+            {
+                double position = step[dim] > 0 ? (m_data[i].coordinates[dim] - m_origin[dim]) / step[dim] : 0.0;
+                position = std::clamp(position, 0.0, static_cast<double>(extents[dim] - 1));
+                const std::size_t cell = std::min(static_cast<std::size_t>(position), extents[dim] > 1 ? extents[dim] - 2 : 0);
+                fraction[dim] = position - cell;
+                base += cell * strides[dim];
+            }
+
+            // Corners of the cell, one bit per dimension
+            for (std::size_t corner = 0; corner < (std::size_t(1) << PD); ++corner)
+            {
+                double weight = 1.0;
+                std::size_t node = base;
+                for (std::size_t dim = 0; dim < PD; ++dim)
+                {
+                    if (corner & (std::size_t(1) << dim))
+                    {
+                        weight *= fraction[dim];
+                        node += extents[dim] > 1 ? strides[dim] : 0;
+                    }
+                    else
+                    {
+                        weight *= 1.0 - fraction[dim];
+                    }
+                }
+                localWeights[node] += weight;
+            }
+        }
+
+        #pragma omp critical
+        {
+            for (std::size_t j = 0; j < totalNodes; ++j)
+            {
+                weights[j] += localWeights[j];
+            }
+        }
+    }
+    return weights;
+}
+
+template <std::size_t PD>
+std::vector<double> BinnedKDE<PD>::densities(const Eigen::MatrixXd &bandwidth) const
+{
+    if (bandwidth.rows() != PD || bandwidth.cols() != PD || !bandwidth.isDiagonal())
+    {
+        throw std::invalid_argument("Binned KDE requires a diagonal bandwidth matrix");
+    }
+    std::array<std::size_t, PD> refinement;
+    if (!this->refinement(bandwidth, refinement))
+    {
+        throw std::invalid_argument("Binned KDE cannot resolve the bandwidth within KDE_BINNED_MAX_NODES nodes");
+    }
+
+    // Extents of the values, those of the binning grid until the dimension is convolved
+    std::array<std::size_t, PD> extents;
+    for (std::size_t dim = 0; dim < PD; ++dim)
+    {
+        extents[dim] = (m_extents[dim] - 1) * refinement[dim] + 1;
+    }
+
+    std::vector<double> result = bin(refinement), previous;
+    std::size_t stride = 1;
+    for (std::size_t dim = 0; dim < PD; ++dim)
+    {
+        // Gaussian sampled on the binning grid, up to the truncation or the size of the grid
+        const double h = std::sqrt(bandwidth(dim, dim));
+        const double step = m_step[dim] / refinement[dim];
+        const std::size_t extent = extents[dim];
+        std::size_t width = 0;
+        if (step > 0 && h > 0)
+        {
+            width = std::min<std::size_t>(extent - 1, static_cast<std::size_t>(std::ceil(KDE_BINNED_TRUNCATION * h / step)));
+        }
+        std::vector<double> kernel(width + 1);
+        for (std::size_t j = 0; j <= width; ++j)
+        {
+            const double u = j * step / h;
+            kernel[j] = std::exp(-0.5 * u * u);
+        }
+
+        // 1-D convolution along the dimension, kept at the grid nodes only: the values are a
+        // sequence of blocks of `extent` slices of `stride` values, and every slice of a node
+        // sums the slices of the block within the kernel width
+        previous.swap(result);
+        const std::size_t split = refinement[dim];
+        const std::size_t nodes = m_extents[dim];
+        const std::size_t numBlocks = previous.size() / (stride * extent);
+        result.assign(numBlocks * nodes * stride, 0.0);
+        #pragma omp parallel for collapse(2)
+        for (std::size_t b = 0; b < numBlocks; ++b)
+        {
+            for (std::size_t c = 0; c < nodes; ++c)
+            {
+                double *out = result.data() + (b * nodes + c) * stride;
+                const double *in = previous.data() + b * extent * stride;
+                const std::size_t center = c * split;
+                const std::size_t first = center >= width ? center - width : 0;
+                const std::size_t last = std::min(center + width, extent - 1);
+                for (std::size_t j = first; j <= last; ++j)
+                {
+                    const double g = kernel[j > center ? j - center : center - j];
+                    const double *slice = in + j * stride;
+                    #pragma omp simd
+                    for (std::size_t t = 0; t < stride; ++t)
+                    {
+                        out[t] += g * slice[t];
+                    }
+                }
+            }
+        }
+        stride *= nodes;
+    }
+
+    // Same normalization as the exact sums: 1 / (N * (2 pi)^(PD/2) * sqrt(det H))
+    const double normalization = 1.0 / (m_data.size() * std::pow(2 * M_PI, PD / 2.0) * std::sqrt(bandwidth.determinant()));
+    #pragma omp parallel for simd
+    for (std::size_t j = 0; j < result.size(); ++j)
+    {
+        result[j] *= normalization;
+    }
+    return result;
+}
+
+template class BinnedKDE<3>;
+template class BinnedKDE<2>;
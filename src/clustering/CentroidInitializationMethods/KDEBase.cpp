@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <limits>
+#include <stdexcept>
 #include "clustering/CentroidInitializationMethods/KDEBase.hpp"
 
 
@@ -51,14 +55,7 @@
         Eigen::MatrixXd bandwidthMatrix = bandwidths.array().square().matrix().asDiagonal();
 
         // Compute necessary components for KDE
-        Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(bandwidthMatrix);
-        this->m_h_sqrt_inv = solver.operatorInverseSqrt();                  // Inverse square root of the bandwidth matrix
-        this->m_h_det_sqrt = sqrt(bandwidthMatrix.determinant());           // Square root of the determinant of the bandwidth matrix
-        m_transformedPoints.clear();
-        for (const auto& xi : m_data) {
-            Eigen::VectorXd transformed = m_h_sqrt_inv * pointToVector(xi);
-            m_transformedPoints.push_back(transformed);
-        }
+        transformPoints(bandwidthMatrix, m_data);
         return bandwidthMatrix; // Return the bandwidth matrix
     }
 
@@ -75,6 +72,176 @@
 
 
 
+    /* Shrinks the bandwidth when too few maxima are found, keeping kdeValue consistent with it. */
+    template<std::size_t PD>
+    void KDEBase<PD>::shrinkBandwidth(double factor, const std::vector<Point<double, PD>>& m_data) {
+        // A diagonal bandwidth is scaled uniformly, so the transformed points and the derived
+        // parameters are rescaled in place instead of transforming the dataset again
+        if (m_h.isDiagonal() && static_cast<std::size_t>(m_transformedPoints.cols()) == m_data.size()) {
+            const double inverseSqrt = 1.0 / std::sqrt(factor);
+            m_h.diagonal() *= factor;
+            m_h_sqrt_inv *= inverseSqrt;
+            m_transform *= inverseSqrt;
+            m_h_det_sqrt *= std::pow(factor, PD / 2.0);
+            m_transformedPoints *= inverseSqrt;
+            if (m_truncationTolerance > 0) {
+                buildTree();
+            }
+            return;
+        }
+
+        m_h.diagonal() *= factor;
+        transformPoints(m_h, m_data);
+    }
+
+
+    /* Inverse square root and determinant of the bandwidth matrix, and the dataset in the
+       coordinates where the kernel is isotropic, stored dimension by dimension. */
+    template<std::size_t PD>
+    void KDEBase<PD>::transformPoints(const Eigen::MatrixXd& bandwidthMatrix, const std::vector<Point<double, PD>>& m_data) {
+        Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(bandwidthMatrix);
+        m_h_sqrt_inv = solver.operatorInverseSqrt();                  // Inverse square root of the bandwidth matrix
+        m_h_det_sqrt = sqrt(bandwidthMatrix.determinant());           // Square root of the determinant of the bandwidth matrix
+        m_transform = m_h_sqrt_inv;
+
+        m_transformedPoints.resize(PD, m_data.size());
+        #pragma omp parallel for
+        for (size_t i = 0; i < m_data.size(); ++i) {
+            m_transformedPoints.col(i).noalias() = m_transform * Eigen::Map<const Eigen::Matrix<double, PD, 1>>(m_data[i].coordinates.data());
+        }
+        if (m_truncationTolerance > 0) {
+            buildTree();
+        }
+    }
+
+
+    /* The kd-tree reorders the points it is built on, so it gets its own copy of them. */
+    template<std::size_t PD>
+    void KDEBase<PD>::buildTree() {
+        m_tree.reset();
+        m_indexedPoints.resize(m_transformedPoints.cols());
+        for (size_t i = 0; i < m_indexedPoints.size(); ++i) {
+            for (std::size_t d = 0; d < PD; ++d) {
+                m_indexedPoints[i].coordinates[d] = m_transformedPoints(d, i);
+            }
+        }
+        m_tree = std::make_unique<KdTree<double, PD>>(m_indexedPoints);
+    }
+
+
+    template<std::size_t PD>
+    void KDEBase<PD>::setTruncation(double tolerance) {
+        if (tolerance < 0 || tolerance >= 1) {
+            throw std::invalid_argument("The truncation tolerance must be in [0, 1).");
+        }
+        m_truncationSet = true;
+        applyTruncation(tolerance);
+    }
+
+
+    template<std::size_t PD>
+    void KDEBase<PD>::prepareSums(std::size_t numPoints) {
+        if (m_truncationSet) {
+            return;
+        }
+        const double tolerance = !m_exactDensities && numPoints >= KDE_TRUNCATION_MIN_POINTS ? KDE_TRUNCATION_TOLERANCE : 0.0;
+        if (tolerance != m_truncationTolerance) {
+            applyTruncation(tolerance);
+        }
+    }
+
+
+    /* A Gaussian contribution exp(-r^2 / 2) is below the tolerance beyond r = sqrt(-2 ln(tolerance)). */
+    template<std::size_t PD>
+    void KDEBase<PD>::applyTruncation(double tolerance) {
+        m_truncationTolerance = tolerance;
+        m_maxTruncationError = 0.0;
+        if (tolerance == 0) {
+            m_tree.reset();
+            m_indexedPoints.clear();
+            return;
+        }
+        m_cutoffRadius = sqrt(-2.0 * log(tolerance));
+        if (m_transformedPoints.cols() > 0) {
+            buildTree();
+        }
+    }
+
+
+    /* Gaussian sum over the points within the cutoff radius. The omitted points are farther
+       than the radius, so each of them would have added less than the tolerance times the peak. */
+    template<std::size_t PD>
+    double KDEBase<PD>::kdeValueTruncated(const Point<double, PD>& x, double* errorBound) const {
+        if (m_h.rows() == 0 || m_h.cols() == 0) {
+            throw std::runtime_error("Bandwidth matrix is not initialized.");
+        }
+        if (!m_tree) {
+            throw std::runtime_error("Truncated evaluation is not enabled.");
+        }
+
+        const Eigen::Matrix<double, PD, 1> transformedQuery = m_transform * Eigen::Map<const Eigen::Matrix<double, PD, 1>>(x.coordinates.data());
+        std::array<double, PD> center;
+        for (std::size_t d = 0; d < PD; ++d) {
+            center[d] = transformedQuery[d];
+        }
+
+        // One neighbor buffer per thread, reused across the grid points
+        thread_local std::vector<const Point<double, PD>*> neighbors;
+        m_tree->radiusSearch(center, m_cutoffRadius, neighbors);
+
+        double density = 0.0;
+        for (const Point<double, PD>* neighbor : neighbors) {
+            double squaredNorm = 0.0;
+            for (std::size_t d = 0; d < PD; ++d) {
+                const double diff = center[d] - neighbor->coordinates[d];
+                squaredNorm += diff * diff;
+            }
+            density += exp(-0.5 * squaredNorm);
+        }
+
+        const double normalization = Kernel::coefficient(KernelType::GAUSSIAN, PD) / (m_indexedPoints.size() * m_h_det_sqrt);
+        if (errorBound) {
+            *errorBound = (m_indexedPoints.size() - neighbors.size()) * m_truncationTolerance * normalization;
+        }
+        return density * normalization;
+    }
+
+
+    template<std::size_t PD>
+    double KDEBase<PD>::gridDensity(const Point<double, PD>& x, double& maxError) const {
+        if (!m_tree) {
+            return kdeValue(x);
+        }
+        double error = 0.0;
+        const double density = kdeValueTruncated(x, &error);
+        maxError = std::max(maxError, error);
+        return density;
+    }
+
+
+    /* Sum of the profile over the dataset, a batch of points at a time: each row of the
+       transformed points is contiguous, so the squared distances and the profile are Eigen
+       array expressions evaluated with packets, in a buffer that lives on the stack. */
+    template<std::size_t PD>
+    template<typename Profile>
+    double KDEBase<PD>::sumProfile(const Eigen::Matrix<double, PD, 1>& query, Profile profile) const {
+        using Batch = Eigen::Array<double, Eigen::Dynamic, 1, Eigen::ColMajor, KDE_EVALUATION_BATCH, 1>;
+        const Eigen::Index n = m_transformedPoints.cols();
+
+        double sum = 0.0;
+        Batch squaredNorms;
+        for (Eigen::Index start = 0; start < n; start += KDE_EVALUATION_BATCH) {
+            const Eigen::Index size = std::min<Eigen::Index>(KDE_EVALUATION_BATCH, n - start);
+            squaredNorms = (m_transformedPoints.row(0).segment(start, size).transpose().array() - query[0]).square();
+            for (std::size_t d = 1; d < PD; ++d) {
+                squaredNorms += (m_transformedPoints.row(d).segment(start, size).transpose().array() - query[d]).square();
+            }
+            sum += profile(squaredNorms).sum();
+        }
+        return sum;
+    }
+
+
     /* This defines the actual function. "x" is the independent variable, and "data" 
        represents the set of points required for the calculation.
        It simply computes the kernel density estimate (KDE) for the given input. 
@@ -88,28 +255,69 @@
         * - K(u): The kernel function, typically a symmetric and normalized function.
      */
     template<std::size_t PD>
-    double KDEBase<PD>::kdeValue(const Point<double, PD>& x) {
+    double KDEBase<PD>::kdeValue(const Point<double, PD>& x, KernelType kernel) const {
         // Check if the bandwidth matrix is initialized
         if (m_h.rows() == 0 || m_h.cols() == 0) {
             throw std::runtime_error("Bandwidth matrix is not initialized.");
         }
 
         // Transform the query point using the square root inverse of the bandwidth matrix
-        Eigen::VectorXd transformedQuery = m_h_sqrt_inv * pointToVector(x);
+        const Eigen::Matrix<double, PD, 1> transformedQuery = m_transform * Eigen::Map<const Eigen::Matrix<double, PD, 1>>(x.coordinates.data());
 
-        double density = 0.0; // Initialize the density value to 0
-
-        // Iterate through all transformed points in the dataset
-        Eigen::VectorXd diff(PD);
-        for (size_t i = 0; i < m_transformedPoints.size(); ++i) {
-            diff.noalias() = transformedQuery - m_transformedPoints[i];
-            density += Kernel::gaussian(diff);
+        // Sum the kernel profile over the dataset, the kernel is chosen outside the loop
+        double density = 0.0;
+        switch (kernel) {
+            case KernelType::GAUSSIAN:
+                density = sumProfile(transformedQuery, [](const auto& s) { return Kernel::gaussianProfile(s); });
+                break;
+            case KernelType::EPANECHNIKOV:
+                density = sumProfile(transformedQuery, [](const auto& s) { return Kernel::epanechnikovProfile(s); });
+                break;
+            case KernelType::UNIFORM:
+                density = sumProfile(transformedQuery, [](const auto& s) { return Kernel::uniformProfile(s); });
+                break;
+            case KernelType::TRIANGULAR:
+                density = sumProfile(transformedQuery, [](const auto& s) { return Kernel::triangularProfile(s); });
+                break;
+            case KernelType::BIWEIGHT:
+                density = sumProfile(transformedQuery, [](const auto& s) { return Kernel::biweightProfile(s); });
+                break;
+            case KernelType::TRIWEIGHT:
+                density = sumProfile(transformedQuery, [](const auto& s) { return Kernel::triweightProfile(s); });
+                break;
+            case KernelType::COSINE:
+                density = sumProfile(transformedQuery, [](const auto& s) { return Kernel::cosineProfile(s); });
+                break;
         }
 
-        // Normalize the density using the determinant of the bandwidth matrix and the dataset size
-        density /= (m_transformedPoints.size() * m_h_det_sqrt);
-        
-        return density; // Return the estimated density value
+        // Normalize the density using the kernel coefficient, the determinant of the bandwidth matrix and the dataset size
+        return density * Kernel::coefficient(kernel, PD) / (m_transformedPoints.cols() * m_h_det_sqrt);
+    }
+
+
+    template<std::size_t PD>
+    void KDEBase<PD>::completeWithFarthestPoints(const std::vector<Point<double, PD>>& m_data, std::size_t k, std::vector<CentroidPoint<double, PD>>& centroids) const {
+        // Squared distance of every point to its nearest centroid, updated with the new ones
+        const std::size_t n = m_data.size();
+        std::vector<double> squaredDistances(n, std::numeric_limits<double>::infinity());
+        std::size_t updated = 0;
+        while (centroids.size() < k && n > 0) {
+            for (; updated < centroids.size(); ++updated) {
+                const std::array<double, PD> center = centroids[updated].coordinates;
+                #pragma omp parallel for
+                for (std::size_t i = 0; i < n; ++i) {
+                    double distance = 0.0;
+                    for (std::size_t dim = 0; dim < PD; ++dim) {
+                        const double delta = m_data[i].coordinates[dim] - center[dim];
+                        distance += delta * delta;
+                    }
+                    squaredDistances[i] = std::min(squaredDistances[i], distance);
+                }
+            }
+            const std::size_t farthest = std::max_element(squaredDistances.begin(), squaredDistances.end()) - squaredDistances.begin();
+            centroids.emplace_back(m_data[farthest]);
+            centroids.back().setID(centroids.size() - 1);
+        }
     }
 
 
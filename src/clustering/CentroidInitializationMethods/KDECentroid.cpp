@@ -1,9 +1,13 @@
 #include <cstddef>
+#include <cstdlib>
+#include <algorithm>
 #include "clustering/CentroidInitializationMethods/KDECentroid.hpp"
 
 
 #define RAY_MIN 3
 #define RANGE_MIN 9
+#define KDE_SPARSE_MARGIN 1 // Grid steps kept around the nodes nearest to the data in the sparse grid
+#define KDE_SPARSE_MAX_OCCUPANCY 0.5 // Largest fraction of kept nodes for which the sparse grid is chosen
 
 template <typename PT, std::size_t PD>
 class CentroidPoint ;
@@ -39,11 +43,11 @@ class Kernel;
     template<std::size_t PD>
     void KDE<PD>::findCentroid(std::vector<CentroidPoint<double, PD>>& centroids) {
 
-        // Generate the grid points based on the calculated ranges and steps
-        std::vector<Point<double, PD>> gridPoints = generateGrid();
+        // Grid, densities and maxima with the bandwidth of the rule of thumb, unless given
+        const std::shared_ptr<const KDEAnalysis<PD>> analysis = m_analysis ? m_analysis : analyze();
 
         // Find the peaks (local maxima) in the grid
-        findLocalMaxima(gridPoints, centroids);
+        findLocalMaxima(*analysis, centroids);
 
         //exportedMesh(this->m_data, "Mesh");
         //exportedMesh(centroids, "Centroids");
@@ -53,47 +57,32 @@ class Kernel;
 
     template<std::size_t PD>
     int KDE<PD>::findLocalWithoutRestriction(){
-        //Necessary declaration
-        std::vector<std::pair<Point<double, PD>, double>> maximaPD;
-        std::vector<double> densities;
-
-        // Generate the grid points based on the calculated ranges and steps
-        std::vector<Point<double, PD>> gridPoints = generateGrid();  
-
-        densities.resize(gridPoints.size());
-
-        // Compute KDE density for each grid point in parallel
-        #pragma omp parallel for
-        for (std::size_t i = 0; i < gridPoints.size(); ++i) {
-            densities[i] = this->kdeValue(gridPoints[i]);
-        }
+        return analyze()->maxima.size();
+    }
 
-        // Thread-local storage for maxima to avoid race conditions
-        std::vector<std::vector<std::pair<Point<double, PD>, double>>> threadLocalMaxima(omp_get_max_threads());
+    template<std::size_t PD>
+    std::shared_ptr<const KDEAnalysis<PD>> KDE<PD>::analyze() {
+        auto analysis = std::make_shared<KDEAnalysis<PD>>();
+        analysis->numPoints = this->m_data.size();
 
-        // Identify local maxima in parallel
-        #pragma omp parallel
-        {
-            int threadID = omp_get_thread_num(); // Get the thread ID
-            auto& localMaxima = threadLocalMaxima[threadID]; // Access the thread's local maxima storage
+        // Generate the grid points based on the calculated ranges and steps
+        analysis->gridPoints = generateGrid();
 
-            std::vector<std::vector<std::size_t>> neighborsParallel(omp_get_max_threads());
-            std::vector<std::vector<double>> offsetsParallel(omp_get_max_threads());
+        // Compute KDE density for each grid point
+        setBandwidthRung(0);
+        analysis->densities = computeDensities(analysis->gridPoints, binDensities(analysis->gridPoints).get());
 
-            #pragma omp for
-            for (size_t i = 0; i < gridPoints.size(); ++i) {
-                if (isLocalMaximum(gridPoints, densities, i, neighborsParallel[omp_get_thread_num()], offsetsParallel[omp_get_thread_num()])) { // Check if the current point is a local maximum
-                    localMaxima.emplace_back(gridPoints[i], densities[i]); // Add it to the local maxima
-                }
-            }
-        }
+        // Identify local maxima with the stencil pass over the grid
+        analysis->maxima = findLocalMaximaIndices(analysis->densities);
+        return analysis;
+    }
 
-        // Merge thread-local maxima into the global maxima vector
-        for (const auto& localMaxima : threadLocalMaxima) {
-            maximaPD.insert(maximaPD.end(), localMaxima.begin(), localMaxima.end());
+    template<std::size_t PD>
+    void KDE<PD>::setAnalysis(std::shared_ptr<const KDEAnalysis<PD>> analysis) {
+        if (analysis && analysis->numPoints != this->m_data.size()) {
+            throw std::invalid_argument("The KDE analysis was computed on another dataset");
         }
-
-        return maximaPD.size();
+        m_analysis = std::move(analysis);
     }
 
     /*This function allows the creation of a grid in the multidimensional space where the points to be classified reside. 
@@ -115,18 +104,40 @@ class Kernel;
             }
         }
         
+        // Extents and strides of the grid, the first dimension varying fastest
+        m_range.assign(PD, 0.0);
+        m_step.assign(PD, 0.0);
+        m_totalPoints = 1;
         for (size_t dim = 0; dim < PD; ++dim) {
-            m_range.push_back(maxValues[dim] - minValues[dim]);
-            m_step.push_back(m_range[dim] / range_number_division); 
-            m_rs.push_back(m_step[dim] * this->m_ray);
-        }    
+            m_range[dim] = maxValues[dim] - minValues[dim];
+            m_step[dim] = m_range[dim] / range_number_division;
+            m_extents[dim] = m_step[dim] > 0 ? static_cast<size_t>(m_range[dim] / m_step[dim]) + 1 : 1;
+            m_strides[dim] = m_totalPoints;
+            m_totalPoints *= m_extents[dim];
+        }
 
-        // Compute the total number of points
-        std::vector<size_t> counters(PD, 0);
-        m_totalPoints = 1;
-        for (size_t i = 0; i < PD; ++i) {
-            m_totalPoints *= static_cast<size_t>(m_range[i] / m_step[i]) + 1;
+        // Unless set, the sparse grid is chosen when the binning cannot resolve the bandwidth
+        // of the rule of thumb over the bounding box, and most of the box is empty
+        bool sparse = m_sparseGrid;
+        if (!m_sparseGridSet) {
+            sparse = false;
+            if (this->useBinnedDensities(this->m_data.size()) && this->m_h.size() > 0) {
+                std::array<double, PD> origin, step;
+                std::copy(minValues.begin(), minValues.end(), origin.begin());
+                std::copy(m_step.begin(), m_step.end(), step.begin());
+                sparse = !BinnedKDE<PD>(this->m_data, origin, step, m_extents).resolves(this->m_h / m_bandwidthScale);
+            }
+        }
+        if (sparse) {
+            std::vector<Point<double, PD>> sparseGrid = generateSparseGrid(minValues);
+            if (m_sparseGridSet || sparseGrid.size() <= KDE_SPARSE_MAX_OCCUPANCY * m_totalPoints) {
+                m_sparseGrid = true;
+                return sparseGrid;
+            }
+            m_sparseNodes.clear();
+            m_sparseSlots.clear();
         }
+        m_sparseGrid = false;
 
         // Initialize the grid vector to store points
         std::vector<Point<double, PD>> grid(m_totalPoints);  // Allocazione diretta
@@ -137,9 +148,9 @@ class Kernel;
             size_t index = i;
 
             for (size_t dim = 0; dim < PD; ++dim) {
-                size_t offset = index % (static_cast<size_t>(m_range[dim] / m_step[dim]) + 1);
+                size_t offset = index % m_extents[dim];
                 point.coordinates[dim] = minValues[dim] + offset * m_step[dim];
-                index /= static_cast<size_t>(m_range[dim] / m_step[dim]) + 1;
+                index /= m_extents[dim];
             }
 
             grid[i] = point;  // Scriviamo direttamente in un vettore pre-allocato
@@ -152,131 +163,340 @@ class Kernel;
 
     // Find local maxima in the grid
     template<std::size_t PD>
-    void KDE<PD>::findLocalMaxima(const std::vector<Point<double, PD>>& gridPoints, std::vector<CentroidPoint<double, PD>>& returnVec) {
-        std::vector<std::pair<Point<double, PD>, double>> maximaPD;
-        std::vector<double> densities(gridPoints.size()); 
-
-        int countCicle = 0;
-        while (true) {
-            std::cout << "Counter: " << countCicle << std::endl;
-
-            #pragma omp parallel for
-            for (size_t i = 0; i < gridPoints.size(); ++i) {
-                densities[i] = this->kdeValue(gridPoints[i]);
+    void KDE<PD>::findLocalMaxima(const KDEAnalysis<PD>& analysis, std::vector<CentroidPoint<double, PD>>& returnVec) {
+        // Bandwidth of the rule of thumb first, enough in most cases
+        setBandwidthRung(0);
+        const std::vector<Point<double, PD>>* gridPoints = &analysis.gridPoints;
+        const std::vector<double>* densities = &analysis.densities;
+        const std::vector<std::size_t>* maxima = &analysis.maxima;
+        std::vector<Point<double, PD>> ladderGrid;
+        std::vector<double> ladderDensities;
+        std::vector<std::size_t> ladderMaxima;
+
+        if (this->m_k != 0 && maxima->size() < this->m_k) {
+            // The grid again, for its geometry if the analysis comes from another KDE; large
+            // datasets are binned once, then every bandwidth only costs a convolution
+            ladderGrid = generateGrid();
+            std::unique_ptr<BinnedKDE<PD>> binned = binDensities(ladderGrid);
+
+            // Narrowest rung whose bandwidth spans KDE_MIN_BANDWIDTH_STEPS steps in some
+            // dimension: the kernels of narrower ones fall between the nodes and show no more modes
+            double stepsPerBandwidth = 0.0;
+            for (std::size_t dim = 0; dim < PD; ++dim) {
+                if (m_step[dim] > 0) {
+                    stepsPerBandwidth = std::max(stepsPerBandwidth, std::sqrt(this->m_h(dim, dim)) / m_step[dim]);
+                }
+            }
+            int high = KDE_BANDWIDTH_RUNGS - 1;
+            if (stepsPerBandwidth > 0) {
+                const double rungs = 2.0 * std::log(stepsPerBandwidth / KDE_MIN_BANDWIDTH_STEPS) / std::log(1.0 / KDE_BANDWIDTH_SHRINK);
+                high = static_cast<int>(std::clamp(std::floor(rungs), 0.0, static_cast<double>(high)));
             }
 
-            std::vector<std::vector<std::pair<Point<double, PD>, double>>> threadLocalMaxima(omp_get_max_threads());
-            std::vector<std::vector<std::size_t>> neighborsParallel(omp_get_max_threads());
-            std::vector<std::vector<double>> offsetsParallel(omp_get_max_threads()); 
-
-            #pragma omp parallel
-            {
-                int threadID = omp_get_thread_num();
-                auto& localMaxima = threadLocalMaxima[threadID];
-
-                #pragma omp for
-                for (size_t i = 0; i < gridPoints.size(); ++i) {
-                    if (isLocalMaximum(gridPoints, densities, i, neighborsParallel[omp_get_thread_num()], offsetsParallel[omp_get_thread_num()])) {
-                        localMaxima.emplace_back(gridPoints[i], densities[i]);
-                    }
+            // Narrowest bandwidth, then bisection between a rung with too few maxima and one with enough
+            int low = 0;
+            setBandwidthRung(high);
+            ladderDensities = computeDensities(ladderGrid, binned.get());
+            ladderMaxima = findLocalMaximaIndices(ladderDensities);
+            // Fewer modes than clusters even with the narrowest bandwidth, as for data on
+            // fewer distinct points: its maxima are completed with the farthest points
+            if (ladderMaxima.size() < this->m_k) {
+                returnVec.reserve(this->m_k);
+                for (std::size_t i : ladderMaxima) {
+                    returnVec.emplace_back(ladderGrid[i]);
+                    returnVec.back().setID(returnVec.size() - 1);
                 }
+                this->completeWithFarthestPoints(this->m_data, this->m_k, returnVec);
+                return;
             }
-
-            for (const auto& localMaxima : threadLocalMaxima) {
-                maximaPD.insert(maximaPD.end(), localMaxima.begin(), localMaxima.end());
+            while (high - low > 1) {
+                const int middle = (low + high) / 2;
+                setBandwidthRung(middle);
+                std::vector<double> middleDensities = computeDensities(ladderGrid, binned.get());
+                std::vector<std::size_t> middleMaxima = findLocalMaximaIndices(middleDensities);
+                if (middleMaxima.size() < this->m_k) {
+                    low = middle;
+                } else {
+                    high = middle;
+                    ladderDensities.swap(middleDensities);
+                    ladderMaxima.swap(middleMaxima);
+                }
             }
+            setBandwidthRung(high);
+            gridPoints = &ladderGrid;
+            densities = &ladderDensities;
+            maxima = &ladderMaxima;
+        }
 
-            std::cout << "\nNumber of local maxima found: " << maximaPD.size() << "\n";
+        std::vector<std::pair<Point<double, PD>, double>> maximaPD;
+        maximaPD.reserve(maxima->size());
+        for (std::size_t i : *maxima) {
+            maximaPD.emplace_back((*gridPoints)[i], (*densities)[i]);
+        }
 
-            if (this->m_k != 0 && maximaPD.size() < this->m_k) {
-                maximaPD.clear();
+        if (this->m_k != 0 && maximaPD.size() > this->m_k) {
+            std::vector<Point<double, PD>> tmpCentroids;
+            tmpCentroids.reserve(maximaPD.size());
+            for (const auto& pair : maximaPD) {
+                tmpCentroids.push_back(pair.first);
+            }
+            MostDistanceClass<PD> mostDistanceClass(tmpCentroids, this->m_k);
+            mostDistanceClass.findCentroid(returnVec);
+            return;
+        }
 
-                this->m_h.diagonal() *= 0.40;
+        returnVec.reserve(maximaPD.size());
+        int i = 0;
+        for (const auto& pair : maximaPD) {
+            returnVec.emplace_back(pair.first);
+            returnVec[i].setID(i);
+            i++;
+        }
+    }
 
-                SelfAdjointEigenSolver<MatrixXd> solver(this->m_h);
-                this->m_h_sqrt_inv = solver.operatorInverseSqrt();
-                this->m_h_det_sqrt = sqrt(this->m_h.determinant());
 
-                this->m_transformedPoints.resize(this->m_data.size());
-                #pragma omp parallel for
-                for (size_t i = 0; i < this->m_data.size(); ++i) {
-                    this->m_transformedPoints[i] = this->m_h_sqrt_inv * this->pointToVector(this->m_data[i]);
-                }
+    template<std::size_t PD>
+    void KDE<PD>::setBandwidthRung(int rung) {
+        const double scale = std::pow(KDE_BANDWIDTH_SHRINK, rung);
+        if (scale != m_bandwidthScale) {
+            this->shrinkBandwidth(scale / m_bandwidthScale, this->m_data);
+            m_bandwidthScale = scale;
+        }
+    }
 
-            } else {
-                if (this->m_k != 0 && maximaPD.size() > this->m_k) {
-                    std::vector<Point<double, PD>> tmpCentroids;
-                    tmpCentroids.reserve(maximaPD.size());
-                    for (const auto& pair : maximaPD) {
-                        tmpCentroids.push_back(pair.first);
-                    }
-                    MostDistanceClass<PD> mostDistanceClass(tmpCentroids, this->m_k);
-                    mostDistanceClass.findCentroid(returnVec);
-                    break;
-                }
 
-                returnVec.reserve(maximaPD.size());
-                int i = 0;
-                for (const auto& pair : maximaPD) {
-                    returnVec.emplace_back(pair.first);
-                    returnVec[i].setID(i);
-                    i++;
-                }
-                break;
-            }
-            countCicle++;
+    template<std::size_t PD>
+    std::unique_ptr<BinnedKDE<PD>> KDE<PD>::binDensities(const std::vector<Point<double, PD>>& gridPoints) const {
+        if (m_sparseGrid || !this->useBinnedDensities(this->m_data.size()) || gridPoints.empty()) {
+            return nullptr;
         }
+        std::array<double, PD> step;
+        std::copy(m_step.begin(), m_step.end(), step.begin());
+        return std::make_unique<BinnedKDE<PD>>(this->m_data, gridPoints[0].coordinates, step, m_extents);
     }
 
-
-    // Check if a point is a local maximum
     template<std::size_t PD>
-    bool KDE<PD>::isLocalMaximum(const std::vector<Point<double, PD>>& gridPoints, const std::vector<double>& densities, size_t index, 
-            std::vector<std::size_t>& neighborsParallel, std::vector<double>& offsetsParallel) {
+    std::vector<double> KDE<PD>::computeDensities(const std::vector<Point<double, PD>>& gridPoints, const BinnedKDE<PD>* binned) {
+        if (binned && binned->resolves(this->m_h)) {
+            return binned->densities(this->m_h);
+        }
 
-        double currentDensity = densities[index];       // Get the density of the current point
+        // Sums over the dataset for each grid point, in parallel and in grid order, so that
+        // the truncated sums of consecutive points visit the same subtrees
+        this->prepareSums(this->m_data.size());
+        std::vector<double> densities(gridPoints.size());
+        double maxError = 0.0;
+        #pragma omp parallel for reduction(max : maxError)
+        for (size_t i = 0; i < gridPoints.size(); ++i) {
+            densities[i] = this->gridDensity(gridPoints[i], maxError);
+        }
+        this->m_maxTruncationError = maxError;
+        return densities;
+    }
+
+    // Check if a point is a local maximum, visiting its box of neighbors by index arithmetic
+    template<std::size_t PD>
+    bool KDE<PD>::isLocalMaximum(const std::vector<double>& densities, std::size_t index) const {
+        const double currentDensity = densities[index];
 
-        neighborsParallel.clear();
-        offsetsParallel.resize(PD, 0);
+        // A zero density is a node out of reach of the data, flat around it
+        if (currentDensity == 0.0) {
+            return false;
+        }
 
-        // Generate neighbors for the current point
-        generateNeighbors(gridPoints, gridPoints[index], 0, neighborsParallel, offsetsParallel);
+        // Bounds of the box of neighbors in each dimension, clipped to the grid
+        std::array<std::size_t, PD> low, high, current;
+        std::size_t remainder = index;
+        for (std::size_t dim = 0; dim < PD; ++dim) {
+            const std::size_t coordinate = remainder % m_extents[dim];
+            remainder /= m_extents[dim];
+            low[dim] = coordinate >= static_cast<std::size_t>(m_ray) ? coordinate - m_ray : 0;
+            high[dim] = std::min(coordinate + m_ray, m_extents[dim] - 1);
+        }
 
-        // Compare the density of the current point with its neighbors, 
-        for (const auto& neighborIndex : neighborsParallel) {
-            if (densities[neighborIndex] > currentDensity) {
+        // Odometer over the box, the first dimension varying fastest
+        current = low;
+        while (true) {
+            std::size_t neighbor = 0;
+            for (std::size_t dim = 0; dim < PD; ++dim) {
+                neighbor += current[dim] * m_strides[dim];
+            }
+            if (densities[neighbor] > currentDensity) {
                 return false; // Not a local maximum
             }
+
+            std::size_t dim = 0;
+            while (dim < PD && current[dim] == high[dim]) {
+                current[dim] = low[dim];
+                dim++;
+            }
+            if (dim == PD) {
+                return true; // The point is a local maximum
+            }
+            current[dim]++;
+        }
+    }
+
+    // Separable maximum filter over the box of every grid point, then comparison with the densities
+    template<std::size_t PD>
+    std::vector<std::size_t> KDE<PD>::findLocalMaximaIndices(const std::vector<double>& densities) const {
+        if (m_sparseGrid) {
+            return findSparseLocalMaximaIndices(densities);
         }
 
-        return true; // The point is a local maximum
+        std::vector<double> boxMax(densities), previous(densities.size());
+
+        for (std::size_t dim = 0; dim < PD; ++dim) {
+            previous.swap(boxMax);
+            boxMax = previous;
+
+            // The grid is a sequence of blocks of m_extents[dim] slices of m_strides[dim] values:
+            // for an offset, the slices with a neighbor in the block form one contiguous range
+            const std::size_t stride = m_strides[dim];
+            const std::size_t extent = m_extents[dim];
+            const std::size_t blockSize = stride * extent;
+            const std::size_t numBlocks = densities.size() / blockSize;
+            for (int offset = -m_ray; offset <= m_ray; ++offset) {
+                if (offset == 0 || static_cast<std::size_t>(std::abs(offset)) >= extent) {
+                    continue;
+                }
+                const std::size_t begin = offset < 0 ? -offset * stride : 0;
+                const std::size_t end = offset < 0 ? blockSize : blockSize - offset * stride;
+                const std::ptrdiff_t shift = static_cast<std::ptrdiff_t>(offset) * static_cast<std::ptrdiff_t>(stride);
+
+                #pragma omp parallel for
+                for (std::size_t b = 0; b < numBlocks; ++b) {
+                    double* out = boxMax.data() + b * blockSize;
+                    const double* in = previous.data() + b * blockSize + shift;
+                    #pragma omp simd
+                    for (std::size_t t = begin; t < end; ++t) {
+                        out[t] = std::max(out[t], in[t]);
+                    }
+                }
+            }
+        }
+
+        std::vector<std::size_t> maxima;
+        for (std::size_t i = 0; i < densities.size(); ++i) {
+            if (densities[i] >= boxMax[i] && densities[i] != 0.0) {
+                maxima.push_back(i);
+            }
+        }
+        return maxima;
     }
 
+    // Nodes nearest to the data, then those within the margin of them, as dense indices
     template<std::size_t PD>
-    void KDE<PD>::generateNeighbors(const std::vector<Point<double, PD>>& grid, const Point<double, PD>& currentPoint, int dim, std::vector<size_t>& neighbors, std::vector<double>& offsets) {
-        // Base case: All dimensions processed
-        if (dim == PD) {
-            // Generate the neighbor by applying the current offsets
-            Point<double, PD> neighbor = currentPoint;
-            for (std::size_t i = 0; i < PD; ++i) {
-                neighbor.coordinates[i] += offsets[i];
+    std::vector<Point<double, PD>> KDE<PD>::generateSparseGrid(const std::vector<double>& minValues) {
+        std::vector<std::size_t> occupied(this->m_data.size());
+        #pragma omp parallel for
+        for (std::size_t i = 0; i < this->m_data.size(); ++i) {
+            std::size_t node = 0;
+            for (std::size_t dim = 0; dim < PD; ++dim) {
+                const double position = m_step[dim] > 0 ? (this->m_data[i].coordinates[dim] - minValues[dim]) / m_step[dim] : 0.0;
+                const std::size_t coordinate = std::min(static_cast<std::size_t>(std::max(std::round(position), 0.0)), m_extents[dim] - 1);
+                node += coordinate * m_strides[dim];
+            }
+            occupied[i] = node;
+        }
+        std::sort(occupied.begin(), occupied.end());
+        occupied.erase(std::unique(occupied.begin(), occupied.end()), occupied.end());
+
+        m_sparseNodes.clear();
+        for (std::size_t node : occupied) {
+            std::array<std::size_t, PD> low, high, current;
+            for (std::size_t dim = 0; dim < PD; ++dim) {
+                const std::size_t coordinate = (node / m_strides[dim]) % m_extents[dim];
+                low[dim] = coordinate >= KDE_SPARSE_MARGIN ? coordinate - KDE_SPARSE_MARGIN : 0;
+                high[dim] = std::min<std::size_t>(coordinate + KDE_SPARSE_MARGIN, m_extents[dim] - 1);
             }
 
-            // Check if the neighbor exists in the grid
-            for (std::size_t idx = 0; idx < grid.size(); ++idx) {
-                if (grid[idx] == neighbor) {  
-                    neighbors.push_back(idx); // Add neighbor index to the list
+            // Odometer over the margin box, the first dimension varying fastest
+            current = low;
+            while (true) {
+                std::size_t neighbor = 0;
+                for (std::size_t dim = 0; dim < PD; ++dim) {
+                    neighbor += current[dim] * m_strides[dim];
+                }
+                m_sparseNodes.push_back(neighbor);
+
+                std::size_t dim = 0;
+                while (dim < PD && current[dim] == high[dim]) {
+                    current[dim] = low[dim];
+                    dim++;
+                }
+                if (dim == PD) {
                     break;
                 }
+                current[dim]++;
+            }
+        }
+        std::sort(m_sparseNodes.begin(), m_sparseNodes.end());
+        m_sparseNodes.erase(std::unique(m_sparseNodes.begin(), m_sparseNodes.end()), m_sparseNodes.end());
+
+        m_sparseSlots.clear();
+        m_sparseSlots.reserve(m_sparseNodes.size());
+        std::vector<Point<double, PD>> grid(m_sparseNodes.size());
+        for (std::size_t i = 0; i < m_sparseNodes.size(); ++i) {
+            m_sparseSlots.emplace(m_sparseNodes[i], i);
+            for (std::size_t dim = 0; dim < PD; ++dim) {
+                grid[i].coordinates[dim] = minValues[dim] + ((m_sparseNodes[i] / m_strides[dim]) % m_extents[dim]) * m_step[dim];
             }
-            return;
         }
+        return grid;
+    }
 
-        // Recursive case: Iterate over all possible offsets for the current dimension
-        for (double offset = -m_rs[dim]; offset <= m_rs[dim]; offset = offset + m_step[dim]) {
-            offsets[dim] = offset; // Set the offset for the current dimension
-            generateNeighbors(grid, currentPoint, dim + 1, neighbors, offsets); // Recurse for the next dimension
+    // Box of every kept node looked up in the hash, the nodes missing from it are skipped
+    template<std::size_t PD>
+    std::vector<std::size_t> KDE<PD>::findSparseLocalMaximaIndices(const std::vector<double>& densities) const {
+        std::vector<std::size_t> maxima;
+
+        #pragma omp parallel
+        {
+            std::vector<std::size_t> localMaxima;
+
+            #pragma omp for schedule(static) nowait
+            for (std::size_t i = 0; i < m_sparseNodes.size(); ++i) {
+                std::array<std::size_t, PD> low, high, current;
+                for (std::size_t dim = 0; dim < PD; ++dim) {
+                    const std::size_t coordinate = (m_sparseNodes[i] / m_strides[dim]) % m_extents[dim];
+                    low[dim] = coordinate >= static_cast<std::size_t>(m_ray) ? coordinate - m_ray : 0;
+                    high[dim] = std::min(coordinate + m_ray, m_extents[dim] - 1);
+                }
+
+                bool isMaximum = densities[i] != 0.0;
+                current = low;
+                while (isMaximum) {
+                    std::size_t neighbor = 0;
+                    for (std::size_t dim = 0; dim < PD; ++dim) {
+                        neighbor += current[dim] * m_strides[dim];
+                    }
+                    const auto slot = m_sparseSlots.find(neighbor);
+                    if (slot != m_sparseSlots.end() && densities[slot->second] > densities[i]) {
+                        isMaximum = false;
+                    }
+
+                    std::size_t dim = 0;
+                    while (dim < PD && current[dim] == high[dim]) {
+                        current[dim] = low[dim];
+                        dim++;
+                    }
+                    if (dim == PD) {
+                        break;
+                    }
+                    current[dim]++;
+                }
+                if (isMaximum) {
+                    localMaxima.push_back(i);
+                }
+            }
+
+            #pragma omp critical
+            maxima.insert(maxima.end(), localMaxima.begin(), localMaxima.end());
         }
+
+        std::sort(maxima.begin(), maxima.end());
+        return maxima;
     }
 
 // Explicit template instantiation
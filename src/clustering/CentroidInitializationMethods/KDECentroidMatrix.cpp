@@ -1,5 +1,10 @@
 #include "clustering/CentroidInitializationMethods/KDECentroidMatrix.hpp"
 
+#include <memory>
+#include <algorithm>
+#include <tuple>
+#include <omp.h>
+
 #define RAY_MIN 3
 #define RANGE_MIN 9
 
@@ -62,101 +67,52 @@ Grid3D KDE3D::generateGrid()
     // Compute the range, step size, and number of points for each dimension
     for (size_t dim = 0; dim < PDS; ++dim)
     {
-        m_range[dim] = maxValues[dim] - minValues[dim];                         // Range of values in the dimension
-        m_step[dim] = m_range[dim] / range_number_division;                     // Step size based on the division factor
-        m_numPoints[dim] = static_cast<size_t>(m_range[dim] / m_step[dim]) + 1; // Number of grid points in the dimension
+        m_range[dim] = maxValues[dim] - minValues[dim];                                                    // Range of values in the dimension
+        m_step[dim] = m_range[dim] / range_number_division;                                                // Step size based on the division factor
+        m_numPoints[dim] = m_step[dim] > 0 ? static_cast<size_t>(m_range[dim] / m_step[dim]) + 1 : 1; // Number of grid points in the dimension
     }
 
-    // Initialize a 3D grid structure with the computed number of points
-    Grid3D grid(
-        m_numPoints[0],
-        std::vector<std::vector<Point<double, PDS>>>(
-            m_numPoints[1],
-            std::vector<Point<double, PDS>>(m_numPoints[2])));
-
-    // Fill the grid with points at regular intervals
-    for (size_t x = 0; x < m_numPoints[0]; ++x)
-    {
-        for (size_t y = 0; y < m_numPoints[1]; ++y)
-        {
-            for (size_t z = 0; z < m_numPoints[2]; ++z)
-            {
-                Point<double, PDS> point;
-
-                // Calculate the coordinates for the current grid point
-                point.coordinates[0] = minValues[0] + x * m_step[0];
-                point.coordinates[1] = minValues[1] + y * m_step[1];
-                point.coordinates[2] = minValues[2] + z * m_step[2];
-
-                // Assign the point to the corresponding grid position
-                grid[x][y][z] = point;
-            }
-        }
-    }
-
-    return grid; // Return the 3D grid structure
+    // The nodes are implicit, only the geometry of the grid is kept
+    Grid3D grid;
+    grid.origin = minValues;
+    grid.step = m_step;
+    grid.extents = m_numPoints;
+    return grid;
 }
 
 // Find local maxima in the grid
-void KDE3D::findLocalMaxima(const Grid3D &gridPoints, std::vector<CentroidPoint<double, PDS>> &returnVec)
+void KDE3D::findLocalMaxima(const Grid3D &grid, std::vector<CentroidPoint<double, PDS>> &returnVec)
 {
-    // Define grid dimensions
-    std::size_t Xgrid, Ygrid, Zgrid;
     std::vector<std::pair<Point<double, PDS>, double>> maximaPD;
 
-    Xgrid = gridPoints.size();
-    Ygrid = gridPoints[0].size();
-    Zgrid = gridPoints[0][0].size();
-
-    // Initialize 3D density array
-    Densities3D densities(Xgrid, std::vector<std::vector<double>>(Ygrid, std::vector<double>(Zgrid, 0.0)));
+    // Large datasets are binned once, then every bandwidth only costs a convolution
+    std::unique_ptr<BinnedKDE<PDS>> binned;
+    if (useBinnedDensities(this->m_data.size()))
+    {
+        binned = std::make_unique<BinnedKDE<PDS>>(this->m_data, grid.origin, grid.step, grid.extents);
+    }
 
     int countCicle = 0; // Counter for iterations
 
     while (true)
     {
-// Compute KDE density for each grid point in parallel
-#pragma omp parallel for collapse(PDS)
-        for (size_t x = 0; x < Xgrid; ++x)
+        const Densities3D densities = computeDensities(grid, binned.get());
+        for (std::size_t index : findLocalMaximaIndices(grid, densities))
         {
-            for (size_t y = 0; y < Ygrid; ++y)
-            {
-                for (size_t z = 0; z < Zgrid; ++z)
-                {
-                    densities[x][y][z] = kdeValue(gridPoints[x][y][z]);
-                }
-            }
+            maximaPD.emplace_back(grid.point(index), densities[index]);
         }
 
-        // Thread-local storage for local maxima
-        std::vector<std::vector<std::pair<Point<double, PDS>, double>>> threadLocalMaxima(omp_get_max_threads());
-
-// Find local maxima in parallel
-#pragma omp parallel
+        // Fewer modes than clusters even with the narrowest bandwidth of the ladder: the
+        // maxima are completed with the farthest points
+        if (maximaPD.size() < this->m_k && countCicle == KDE_BANDWIDTH_RUNGS - 1)
         {
-            int threadID = omp_get_thread_num();
-            auto &localMaxima = threadLocalMaxima[threadID]; // Access thread-local maxima vector
-
-#pragma omp for collapse(PDS)
-            for (size_t x = 0; x < Xgrid; ++x)
+            for (const auto &pair : maximaPD)
             {
-                for (size_t y = 0; y < Ygrid; ++y)
-                {
-                    for (size_t z = 0; z < Zgrid; ++z)
-                    {
-                        if (isLocalMaximum(gridPoints, densities, x, y, z))
-                        { // Check if current point is a local maximum
-                            localMaxima.emplace_back(gridPoints[x][y][z], densities[x][y][z]);
-                        }
-                    }
-                }
+                returnVec.push_back(CentroidPoint<double, PDS>(pair.first));
+                returnVec.back().setID(returnVec.size() - 1);
             }
-        }
-
-        // Merge thread-local maxima into the global maxima vector
-        for (const auto &localMaxima : threadLocalMaxima)
-        {
-            maximaPD.insert(maximaPD.end(), localMaxima.begin(), localMaxima.end());
+            completeWithFarthestPoints(this->m_data, this->m_k, returnVec);
+            break;
         }
 
         // Check if bandwidth adjustment is necessary
@@ -164,21 +120,8 @@ void KDE3D::findLocalMaxima(const Grid3D &gridPoints, std::vector<CentroidPoint<
         {
             maximaPD.clear(); // Clear maxima to retry
 
-            // Reduce the bandwidth matrix (scale diagonals by 85%)
-            m_h.diagonal() *= 0.40;
-
-            // Recompute derived parameters for the updated bandwidth
-            SelfAdjointEigenSolver<MatrixXd> solver(m_h);
-            m_h_sqrt_inv = solver.operatorInverseSqrt();
-            m_h_det_sqrt = sqrt(m_h.determinant());
-
-            // Update transformed points with new bandwidth
-            m_transformedPoints.clear();
-            for (const auto &xi : this->m_data)
-            {
-                Eigen::VectorXd transformed = m_h_sqrt_inv * this->pointToVector(xi);
-                m_transformedPoints.push_back(transformed);
-            }
+            // Reduce the bandwidth matrix (scale diagonals by 40%)
+            shrinkBandwidth(KDE_BANDWIDTH_SHRINK, this->m_data);
         }
         else
         {
@@ -218,35 +161,136 @@ void KDE3D::findLocalMaxima(const Grid3D &gridPoints, std::vector<CentroidPoint<
     return;
 }
 
-// Check if a point is a local maximum
-bool KDE3D::isLocalMaximum(const Grid3D &gridPoints, const Densities3D &densities, size_t x, size_t y, size_t z)
+Densities3D KDE3D::computeDensities(const Grid3D &grid, const BinnedKDE<PDS> *binned)
 {
-    double currentDensity = densities[x][y][z];
-    for (int dx = -RAY_MIN; dx <= RAY_MIN; ++dx)
+    // The binned densities already have the layout of the grid
+    if (binned && binned->resolves(m_h))
     {
-        for (int dy = -RAY_MIN; dy <= RAY_MIN; ++dy)
+        return binned->densities(m_h);
+    }
+
+    // Compute KDE density for each grid point in parallel, truncated for large datasets
+    prepareSums(m_data.size());
+    Densities3D densities(grid.size());
+    double maxError = 0.0;
+#pragma omp parallel for collapse(PDS) reduction(max : maxError)
+    for (size_t z = 0; z < grid.extents[2]; ++z)
+    {
+        for (size_t y = 0; y < grid.extents[1]; ++y)
         {
-            for (int dz = -RAY_MIN; dz <= RAY_MIN; ++dz)
+            for (size_t x = 0; x < grid.extents[0]; ++x)
             {
+                densities[grid.index(x, y, z)] = gridDensity(grid.point(x, y, z), maxError);
+            }
+        }
+    }
+    m_maxTruncationError = maxError;
+    return densities;
+}
+
+std::vector<std::size_t> KDE3D::findLocalMaximaIndices(const Grid3D &grid, const Densities3D &densities) const
+{
+    const std::size_t planeSize = grid.extents[0] * grid.extents[1];
+    const std::size_t numPlanes = grid.extents[2];
+    const std::size_t window = 2 * RAY_MIN + 1;
+    std::vector<std::vector<std::size_t>> threadLocalMaxima(omp_get_max_threads());
+
+#pragma omp parallel
+    {
+        // Contiguous slab of planes of the thread
+        const std::size_t numThreads = omp_get_num_threads();
+        const std::size_t threadID = omp_get_thread_num();
+        const std::size_t first = numPlanes * threadID / numThreads;
+        const std::size_t last = numPlanes * (threadID + 1) / numThreads;
+        auto &localMaxima = threadLocalMaxima[threadID];
+
+        // Box maxima of the planes within RAY_MIN of the current one, plane z in slot z % window
+        std::vector<double> ring(window * planeSize), rowMax(planeSize), boxMax(planeSize);
+        std::size_t nextPlane = first > RAY_MIN ? first - RAY_MIN : 0;
+        for (std::size_t z = first; z < last; ++z)
+        {
+            const std::size_t lowest = z > RAY_MIN ? z - RAY_MIN : 0;
+            const std::size_t highest = std::min<std::size_t>(z + RAY_MIN, numPlanes - 1);
+            for (; nextPlane <= highest; ++nextPlane)
+            {
+                planeBoxMax(grid, densities.data() + nextPlane * planeSize, rowMax, ring.data() + (nextPlane % window) * planeSize);
+            }
 
-                if (dx == 0 && dy == 0 && dz == 0)
+            // Maximum of the box of every node of the plane
+            std::copy_n(ring.data() + (lowest % window) * planeSize, planeSize, boxMax.data());
+            for (std::size_t p = lowest + 1; p <= highest; ++p)
+            {
+                const double *slot = ring.data() + (p % window) * planeSize;
+                for (std::size_t t = 0; t < planeSize; ++t)
                 {
-                    continue;
+                    boxMax[t] = std::max(boxMax[t], slot[t]);
                 }
+            }
 
-                size_t nx = x + dx;
-                size_t ny = y + dy;
-                size_t nz = z + dz;
-
-                if (nx < gridPoints.size() && ny < gridPoints[nx].size() && nz < gridPoints[nx][ny].size())
+            // A node is a local maximum if no node of its box is strictly denser, and if it
+            // is not of zero density, out of reach of the data
+            const double *plane = densities.data() + z * planeSize;
+            for (std::size_t t = 0; t < planeSize; ++t)
+            {
+                if (plane[t] >= boxMax[t] && plane[t] != 0.0)
                 {
-                    if (densities[nx][ny][nz] > currentDensity)
-                    {
-                        return false;
-                    }
+                    localMaxima.push_back(z * planeSize + t);
                 }
             }
         }
     }
-    return true;
+
+    // Merge thread-local maxima, ordered by the indices (x, y, z)
+    std::vector<std::size_t> maxima;
+    for (const auto &localMaxima : threadLocalMaxima)
+    {
+        maxima.insert(maxima.end(), localMaxima.begin(), localMaxima.end());
+    }
+    const auto key = [&grid](std::size_t index)
+    {
+        return std::make_tuple(index % grid.extents[0], (index / grid.extents[0]) % grid.extents[1], index / (grid.extents[0] * grid.extents[1]));
+    };
+    std::sort(maxima.begin(), maxima.end(), [&key](std::size_t a, std::size_t b)
+              { return key(a) < key(b); });
+    return maxima;
+}
+
+void KDE3D::planeBoxMax(const Grid3D &grid, const double *plane, std::vector<double> &rowMax, double *boxMax)
+{
+    const std::size_t rowSize = grid.extents[0];
+    const std::size_t planeSize = rowSize * grid.extents[1];
+
+    // Maxima along x, over every offset within the row
+    std::copy_n(plane, planeSize, rowMax.data());
+    for (std::size_t j = 1; j <= RAY_MIN && j < rowSize; ++j)
+    {
+        for (std::size_t row = 0; row < planeSize; row += rowSize)
+        {
+            double *out = rowMax.data() + row;
+            const double *in = plane + row;
+            for (std::size_t x = j; x < rowSize; ++x)
+            {
+                out[x] = std::max(out[x], in[x - j]);
+            }
+            for (std::size_t x = 0; x + j < rowSize; ++x)
+            {
+                out[x] = std::max(out[x], in[x + j]);
+            }
+        }
+    }
+
+    // Maxima of those along y, whole rows shifted at once
+    std::copy_n(rowMax.data(), planeSize, boxMax);
+    for (std::size_t j = 1; j <= RAY_MIN && j < grid.extents[1]; ++j)
+    {
+        const std::size_t shift = j * rowSize;
+        for (std::size_t t = shift; t < planeSize; ++t)
+        {
+            boxMax[t] = std::max(boxMax[t], rowMax[t - shift]);
+        }
+        for (std::size_t t = 0; t + shift < planeSize; ++t)
+        {
+            boxMax[t] = std::max(boxMax[t], rowMax[t + shift]);
+        }
+    }
 }
@@ -0,0 +1,106 @@
+#include "clustering/CentroidInitializationMethods/KMeansPlusPlus.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+template <std::size_t PD>
+KMeansPlusPlus<PD>::KMeansPlusPlus(const std::vector<Point<double, PD>> &data, int k, std::uint64_t seed)
+    : CentroidInitMethod<double, PD>(data, k), m_seed(seed) {
+    if (this->m_k > data.size()) {
+        throw std::invalid_argument("k-means++ needs at least as many points as clusters");
+    }
+}
+
+template <std::size_t PD>
+KMeansPlusPlus<PD>::KMeansPlusPlus(const std::vector<Point<double, PD>> &data)
+    : CentroidInitMethod<double, PD>(data) {}
+
+template <std::size_t PD>
+void KMeansPlusPlus<PD>::findCentroid(std::vector<CentroidPoint<double, PD>> &centroids) {
+    const std::size_t n = this->m_data.size();
+    if (this->m_k == 0 || this->m_k > n) {
+        throw std::invalid_argument("k-means++ needs a number of clusters between 1 and the number of points");
+    }
+
+    const std::size_t numBlocks = (n + KMEANS_PP_BLOCK_SIZE - 1) / KMEANS_PP_BLOCK_SIZE;
+    std::vector<double> squaredDistances(n, std::numeric_limits<double>::infinity());
+    std::vector<double> blockSums(numBlocks);
+
+    centroids.clear();
+    centroids.reserve(this->m_k);
+    std::size_t chosen = std::min(static_cast<std::size_t>(uniform(0) * n), n - 1);
+    for (std::size_t draw = 1;; ++draw) {
+        centroids.emplace_back(this->m_data[chosen]);
+        centroids.back().setID(centroids.size() - 1);
+        if (centroids.size() == this->m_k) {
+            break;
+        }
+
+        // Squared distances to the nearest centroid, updated with the last one, and their sums per block
+        const std::array<double, PD> center = this->m_data[chosen].coordinates;
+        #pragma omp parallel for schedule(static)
+        for (std::size_t b = 0; b < numBlocks; ++b) {
+            const std::size_t end = std::min(n, (b + 1) * KMEANS_PP_BLOCK_SIZE);
+            double sum = 0.0;
+            for (std::size_t i = b * KMEANS_PP_BLOCK_SIZE; i < end; ++i) {
+                double distance = 0.0;
+                for (std::size_t d = 0; d < PD; ++d) {
+                    const double delta = this->m_data[i].coordinates[d] - center[d];
+                    distance += delta * delta;
+                }
+                squaredDistances[i] = std::min(squaredDistances[i], distance);
+                sum += squaredDistances[i];
+            }
+            blockSums[b] = sum;
+        }
+
+        double total = 0.0;
+        for (double sum : blockSums) {
+            total += sum;
+        }
+
+        // Every point is on a centroid: the next one is drawn uniformly
+        if (!(total > 0.0)) {
+            chosen = std::min(static_cast<std::size_t>(uniform(draw) * n), n - 1);
+            continue;
+        }
+
+        // Block, then point, where the prefix sums pass the target; rounding can leave the
+        // target past the last sum, then the last point of positive weight is taken
+        double target = uniform(draw) * total;
+        std::size_t block = 0;
+        while (block + 1 < numBlocks && (blockSums[block] <= target || blockSums[block] == 0.0)) {
+            target -= blockSums[block];
+            ++block;
+        }
+        while (blockSums[block] == 0.0) {
+            --block;
+        }
+        const std::size_t begin = block * KMEANS_PP_BLOCK_SIZE;
+        const std::size_t end = std::min(n, begin + KMEANS_PP_BLOCK_SIZE);
+        chosen = end;
+        for (std::size_t i = begin; i < end; ++i) {
+            if (squaredDistances[i] > 0.0) {
+                chosen = i;
+                if (squaredDistances[i] > target) {
+                    break;
+                }
+                target -= squaredDistances[i];
+            }
+        }
+    }
+}
+
+template <std::size_t PD>
+double KMeansPlusPlus<PD>::uniform(std::uint64_t draw) const {
+    // SplitMix64 finalizer of the seed and the draw, top 53 bits as a fraction
+    std::uint64_t x = m_seed + (draw + 1) * 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return (x >> 11) * (1.0 / 9007199254740992.0);
+}
+
+template class KMeansPlusPlus<2>;
+template class KMeansPlusPlus<3>;
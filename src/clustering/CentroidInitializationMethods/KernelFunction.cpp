@@ -63,3 +63,8 @@ double Kernel::cosine(const VectorXd& u) {
     }
     return 0.0;
 }
+
+// Only the Gaussian coefficient depends on the dimension
+double Kernel::coefficient(KernelType type, std::size_t dims) {
+    return type == KernelType::GAUSSIAN ? 1.0 / std::pow(2 * M_PI, dims / 2.0) : 1.0;
+}
@@ -0,0 +1,189 @@
+#include "clustering/CentroidInitializationMethods/MeanShift.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <cmath>
+#include <iterator>
+#include <random>
+
+template <std::size_t PD>
+MeanShift<PD>::MeanShift(const std::vector<Point<double, PD>> &data, int k)
+    : CentroidInitMethod<double, PD>(data, k) {
+    if (this->m_k > data.size()) {
+        throw std::invalid_argument("Mean shift needs at least as many points as clusters");
+    }
+    this->m_h = this->bandwidth_RuleOfThumb(this->m_data);
+}
+
+template <std::size_t PD>
+MeanShift<PD>::MeanShift(const std::vector<Point<double, PD>> &data)
+    : CentroidInitMethod<double, PD>(data) {
+    this->m_h = this->bandwidth_RuleOfThumb(this->m_data);
+}
+
+template <std::size_t PD>
+void MeanShift<PD>::findCentroid(std::vector<CentroidPoint<double, PD>> &centroids) {
+    std::vector<std::pair<Point<double, PD>, double>> modes = findModes();
+
+    // Too few modes: the bandwidth smooths clusters together, shrink it as KDE does.
+    // Data on fewer distinct points than clusters never has k modes, so the shrinks stop
+    // once every distinct point is a mode
+    if (this->m_k != 0 && modes.size() < this->m_k) {
+        std::vector<std::array<double, PD>> coordinates(this->m_data.size());
+        std::transform(this->m_data.begin(), this->m_data.end(), coordinates.begin(), [](const Point<double, PD> &p) { return p.coordinates; });
+        std::sort(coordinates.begin(), coordinates.end());
+        const std::size_t distinct = std::unique(coordinates.begin(), coordinates.end()) - coordinates.begin();
+
+        for (int shrinks = 0; shrinks < MEAN_SHIFT_MAX_SHRINKS && modes.size() < std::min<std::size_t>(this->m_k, distinct); ++shrinks) {
+            this->shrinkBandwidth(KDE_BANDWIDTH_SHRINK, this->m_data);
+            modes = findModes();
+        }
+    }
+
+    // Too many modes: keep the densest
+    if (this->m_k != 0 && modes.size() > this->m_k) {
+        modes.resize(this->m_k);
+    }
+
+    centroids.clear();
+    centroids.reserve(std::max<std::size_t>(modes.size(), this->m_k));
+    for (const auto &mode : modes) {
+        centroids.emplace_back(mode.first);
+        centroids.back().setID(centroids.size() - 1);
+    }
+
+    // Still too few modes: the farthest points complete them, as in KDE
+    if (this->m_k != 0) {
+        this->completeWithFarthestPoints(this->m_data, this->m_k, centroids);
+    }
+}
+
+template <std::size_t PD>
+std::vector<std::pair<Point<double, PD>, double>> MeanShift<PD>::findModes() {
+    const std::size_t n = this->m_transformedPoints.cols();
+    if (n == 0) {
+        return {};
+    }
+
+    // Kd-tree over the transformed points, where the kernel has unit bandwidth
+    m_tree.reset();
+    m_indexed.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t d = 0; d < PD; ++d) {
+            m_indexed[i].coordinates[d] = this->m_transformedPoints(d, i);
+        }
+    }
+    m_tree = std::make_unique<KdTree<double, PD>>(m_indexed);
+
+    // Seeds sampled from the dataset, at least one per cluster. The sample is random rather
+    // than strided, which could alias with the order of the points, but seeded for repeatability
+    const std::size_t numSeeds = std::min(n, std::max<std::size_t>(MEAN_SHIFT_MAX_SEEDS, this->m_k));
+    std::vector<std::size_t> indices(n), sampled;
+    std::iota(indices.begin(), indices.end(), 0);
+    std::sample(indices.begin(), indices.end(), std::back_inserter(sampled), numSeeds, std::mt19937(MEAN_SHIFT_RANDOM_SEED));
+    std::vector<std::array<double, PD>> seeds(numSeeds);
+    std::vector<double> densities(numSeeds);
+
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (std::size_t s = 0; s < numSeeds; ++s) {
+        const std::size_t i = sampled[s];
+        for (std::size_t d = 0; d < PD; ++d) {
+            seeds[s][d] = this->m_transformedPoints(d, i);
+        }
+        densities[s] = climb(seeds[s]);
+    }
+
+    // Merge the converged seeds, the densest first
+    std::vector<std::size_t> order(numSeeds);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&densities](std::size_t a, std::size_t b) { return densities[a] > densities[b]; });
+    std::vector<std::size_t> kept;
+    for (std::size_t s : order) {
+        bool merged = false;
+        for (std::size_t m : kept) {
+            double squaredDistance = 0.0;
+            for (std::size_t d = 0; d < PD; ++d) {
+                squaredDistance += (seeds[s][d] - seeds[m][d]) * (seeds[s][d] - seeds[m][d]);
+            }
+            if (squaredDistance < MEAN_SHIFT_MERGE_RADIUS * MEAN_SHIFT_MERGE_RADIUS) {
+                merged = true;
+                break;
+            }
+        }
+        if (!merged) {
+            kept.push_back(s);
+        }
+    }
+
+    // Back to the coordinates of the data, x = H^(1/2) u, with the density of the modes
+    const Eigen::Matrix<double, PD, PD> sqrtBandwidth = Eigen::Matrix<double, PD, PD>(this->m_h_sqrt_inv).inverse();
+    const double normalization = Kernel::coefficient(KernelType::GAUSSIAN, PD) / (n * this->m_h_det_sqrt);
+    std::vector<std::pair<Point<double, PD>, double>> modes;
+    modes.reserve(kept.size());
+    for (std::size_t s : kept) {
+        const Eigen::Matrix<double, PD, 1> mode = sqrtBandwidth * Eigen::Map<const Eigen::Matrix<double, PD, 1>>(seeds[s].data());
+        Point<double, PD> point;
+        for (std::size_t d = 0; d < PD; ++d) {
+            point.coordinates[d] = mode[d];
+        }
+        modes.emplace_back(point, densities[s] * normalization);
+    }
+    return modes;
+}
+
+template <std::size_t PD>
+double MeanShift<PD>::climb(std::array<double, PD> &seed) const {
+    // Neighbors within the cutoff plus a slack of the last search center, one contiguous row
+    // per dimension, reused across the iterations while the seed stays within the slack
+    thread_local std::vector<const Point<double, PD> *> found;
+    thread_local Eigen::Array<double, PD, Eigen::Dynamic, Eigen::RowMajor> neighbors;
+    thread_local Eigen::ArrayXd squaredDistances, weights;
+    std::array<double, PD> center = seed;
+    bool searched = false;
+
+    double density = 0.0;
+    for (int iteration = 0; iteration < MEAN_SHIFT_MAX_ITERATIONS; ++iteration) {
+        double squaredDrift = 0.0;
+        for (std::size_t d = 0; d < PD; ++d) {
+            squaredDrift += (seed[d] - center[d]) * (seed[d] - center[d]);
+        }
+        if (!searched || squaredDrift > MEAN_SHIFT_SLACK * MEAN_SHIFT_SLACK) {
+            center = seed;
+            m_tree->radiusSearch(center, MEAN_SHIFT_CUTOFF + MEAN_SHIFT_SLACK, found);
+            neighbors.resize(PD, found.size());
+            for (std::size_t j = 0; j < found.size(); ++j) {
+                for (std::size_t d = 0; d < PD; ++d) {
+                    neighbors(d, j) = found[j]->coordinates[d];
+                }
+            }
+            searched = true;
+        }
+
+        // Gaussian weights of the neighbors within the cutoff of the seed
+        squaredDistances = (neighbors.row(0) - seed[0]).square().transpose();
+        for (std::size_t d = 1; d < PD; ++d) {
+            squaredDistances += (neighbors.row(d) - seed[d]).square().transpose();
+        }
+        weights = (squaredDistances <= MEAN_SHIFT_CUTOFF * MEAN_SHIFT_CUTOFF).select((-0.5 * squaredDistances).exp(), 0.0);
+        density = weights.sum();
+        if (density == 0.0) {
+            break;
+        }
+
+        // Move to their weighted mean
+        double squaredShift = 0.0;
+        for (std::size_t d = 0; d < PD; ++d) {
+            const double mean = (neighbors.row(d).transpose() * weights).sum() / density;
+            squaredShift += (mean - seed[d]) * (mean - seed[d]);
+            seed[d] = mean;
+        }
+        if (squaredShift < MEAN_SHIFT_TOLERANCE * MEAN_SHIFT_TOLERANCE) {
+            break;
+        }
+    }
+    return density;
+}
+
+template class MeanShift<2>;
+template class MeanShift<3>;
@@ -2,8 +2,9 @@
 
 template <typename PT, std::size_t PD, class M>
 KMeans<PT, PD, M>::KMeans(std::size_t clusters, PT treshold,
-                          M *metric, int centroidsInitializationMethod, int kInitializationMethod)
-    : metric(metric), treshold(treshold), numClusters(clusters)
+                          M *metric, int centroidsInitializationMethod, int kInitializationMethod,
+                          std::uint64_t seed)
+    : metric(metric), treshold(treshold), numClusters(clusters), seed(seed)
 {
   initializeCentroids(centroidsInitializationMethod, kInitializationMethod);
 }
@@ -25,11 +26,14 @@ std::vector<CentroidPoint<PT, PD>> &KMeans<PT, PD, M>::getCentroids()
 template <typename PT, std::size_t PD, class M>
 void KMeans<PT, PD, M>::initializeCentroids(int centroidsInitializationMethod, int kInitializationMethod)
 {
-  if (centroidsInitializationMethod < 0 || centroidsInitializationMethod > 3)
+  if (centroidsInitializationMethod < 0 || centroidsInitializationMethod > 5)
   {
     throw std::invalid_argument("Not a valid centroids initialization method!");
   }
 
+  // Grid and densities of the KDE search of k, reused by the KDE centroid initialization
+  std::shared_ptr<const KDEAnalysis<PD>> kdeAnalysis;
+
   if (numClusters == 0)
   {
     std::unique_ptr<Kinit<PT, PD, M>> kinit;
@@ -44,6 +48,8 @@ void KMeans<PT, PD, M>::initializeCentroids(int centroidsInitializationMethod, i
       throw std::invalid_argument("Invalid k initialization method");
 
     numClusters = kinit->findK(); // `unique_ptr` dealloca automaticamente alla fine del blocco
+    if (kInitializationMethod == Enums::KInit::KDE_METHOD)
+      kdeAnalysis = static_cast<KDEMethod<PT, PD, M> *>(kinit.get())->getAnalysis();
   }
 
   std::unique_ptr<CentroidInitMethod<double, PD>> cim;
@@ -52,9 +58,17 @@ void KMeans<PT, PD, M>::initializeCentroids(int centroidsInitializationMethod, i
   if (centroidsInitializationMethod == Enums::CentroidInit::RANDOM)
     cim = std::make_unique<RandomCentroidInit<PT, PD>>(points, numClusters);
   else if (centroidsInitializationMethod == Enums::CentroidInit::KDE)
-    cim = std::make_unique<KDE<PD>>(points, numClusters);
+  {
+    auto kde = std::make_unique<KDE<PD>>(points, numClusters);
+    kde->setAnalysis(kdeAnalysis);
+    cim = std::move(kde);
+  }
   else if (centroidsInitializationMethod == Enums::CentroidInit::MOSTDISTANT)
     cim = std::make_unique<MostDistanceClass<PD>>(points, numClusters);
+  else if (centroidsInitializationMethod == Enums::CentroidInit::MEANSHIFT)
+    cim = std::make_unique<MeanShift<PD>>(points, numClusters);
+  else if (centroidsInitializationMethod == Enums::CentroidInit::KMEANSPP)
+    cim = std::make_unique<KMeansPlusPlus<PD>>(points, numClusters, seed);
   else if constexpr (PD == 3)
     cim = std::make_unique<KDE3D>(points, numClusters);
   else
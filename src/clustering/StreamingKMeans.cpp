@@ -0,0 +1,261 @@
+#include "clustering/StreamingKMeans.hpp"
+
+#include <cmath>
+#include <future>
+#include <limits>
+#include <fstream>
+#include <stdexcept>
+#include <omp.h>
+
+#include "utils/PointFile.hpp"
+
+template <typename PT, std::size_t PD>
+StreamingKMeans<PT, PD>::StreamingKMeans(std::size_t clusters, PT treshold, PointBlockSource<PT, PD> *source,
+                                         std::size_t maxIterations)
+    : numClusters(clusters), treshold(treshold), source(source), maxIterations(maxIterations)
+{
+  if (numClusters == 0)
+  {
+    throw std::invalid_argument("The number of clusters must be positive");
+  }
+}
+
+template <typename PT, std::size_t PD>
+void StreamingKMeans<PT, PD>::setCentroids(const std::vector<CentroidPoint<PT, PD>> &initial)
+{
+  if (initial.size() != numClusters)
+  {
+    throw std::invalid_argument("Expected " + std::to_string(numClusters) + " initial centroids");
+  }
+  centroids.resize(numClusters * PD);
+  for (std::size_t k = 0; k < numClusters; ++k)
+  {
+    std::copy(initial[k].coordinates.begin(), initial[k].coordinates.end(), centroids.begin() + k * PD);
+  }
+}
+
+template <typename PT, std::size_t PD>
+std::vector<CentroidPoint<PT, PD>> StreamingKMeans<PT, PD>::getCentroids() const
+{
+  std::vector<CentroidPoint<PT, PD>> result(centroids.size() / PD);
+  for (std::size_t k = 0; k < result.size(); ++k)
+  {
+    std::copy(centroids.begin() + k * PD, centroids.begin() + (k + 1) * PD, result[k].coordinates.begin());
+  }
+  return result;
+}
+
+template <typename PT, std::size_t PD>
+template <typename F>
+void StreamingKMeans<PT, PD>::forEachBlock(F process)
+{
+  // Double buffering: the reader thread fills one block while the other is processed
+  std::vector<PT> current, next;
+  source->rewind();
+  std::size_t count = source->read(current);
+  while (count > 0)
+  {
+    std::future<std::size_t> pending = std::async(std::launch::async, [&]()
+                                                  { return source->read(next); });
+    process(current, count);
+    count = pending.get();
+    std::swap(current, next);
+  }
+}
+
+template <typename PT, std::size_t PD>
+std::vector<Point<PT, PD>> StreamingKMeans<PT, PD>::samplePoints(std::size_t count, unsigned int seed)
+{
+  std::mt19937_64 gen(seed);
+  std::size_t seen = 0;
+  std::vector<Point<PT, PD>> sample;
+  sample.reserve(count);
+  forEachBlock([&](const std::vector<PT> &block, std::size_t blockCount)
+  {
+    for (std::size_t i = 0; i < blockCount; ++i, ++seen)
+    {
+      const std::size_t slot = seen < count ? seen : std::uniform_int_distribution<std::size_t>(0, seen)(gen);
+      if (slot < count)
+      {
+        std::array<PT, PD> coordinates;
+        std::copy(block.begin() + i * PD, block.begin() + (i + 1) * PD, coordinates.begin());
+        if (slot == sample.size())
+        {
+          sample.emplace_back(coordinates, seen);
+        }
+        else
+        {
+          sample[slot] = Point<PT, PD>(coordinates, seen);
+        }
+      }
+    }
+  });
+  numPoints = seen;
+  return sample;
+}
+
+template <typename PT, std::size_t PD>
+void StreamingKMeans<PT, PD>::sampleCentroids(unsigned int seed)
+{
+  const std::vector<Point<PT, PD>> sample = samplePoints(numClusters, seed);
+  centroids.assign(numClusters * PD, 0);
+  for (std::size_t k = 0; k < sample.size(); ++k)
+  {
+    std::copy(sample[k].coordinates.begin(), sample[k].coordinates.end(), centroids.begin() + k * PD);
+  }
+}
+
+template <typename PT, std::size_t PD>
+PT StreamingKMeans<PT, PD>::assignBlock(const std::vector<PT> &block, std::size_t count, std::int32_t *labels,
+                                        std::vector<PT> *sums, std::vector<std::size_t> *counts) const
+{
+  PT total = 0;
+  #pragma omp parallel reduction(+ : total)
+  {
+    std::vector<PT> localSums(sums ? numClusters * PD : 0, 0);
+    std::vector<std::size_t> localCounts(counts ? numClusters : 0, 0);
+
+    #pragma omp for
+    for (std::int64_t i = 0; i < count; ++i)
+    {
+      const PT *point = block.data() + i * PD;
+      std::size_t best = 0;
+      PT bestDistance = std::numeric_limits<PT>::max();
+      for (std::size_t k = 0; k < numClusters; ++k)
+      {
+        const PT *centroid = centroids.data() + k * PD;
+        PT distance = 0;
+        for (std::size_t d = 0; d < PD; ++d)
+        {
+          distance += (point[d] - centroid[d]) * (point[d] - centroid[d]);
+        }
+        if (distance < bestDistance)
+        {
+          bestDistance = distance;
+          best = k;
+        }
+      }
+
+      total += bestDistance;
+      if (labels)
+      {
+        labels[i] = static_cast<std::int32_t>(best);
+      }
+      if (sums)
+      {
+        for (std::size_t d = 0; d < PD; ++d)
+        {
+          localSums[best * PD + d] += point[d];
+        }
+      }
+      if (counts)
+      {
+        localCounts[best]++;
+      }
+    }
+
+    #pragma omp critical
+    {
+      for (std::size_t j = 0; j < localSums.size(); ++j)
+      {
+        (*sums)[j] += localSums[j];
+      }
+      for (std::size_t k = 0; k < localCounts.size(); ++k)
+      {
+        (*counts)[k] += localCounts[k];
+      }
+    }
+  }
+  return total;
+}
+
+template <typename PT, std::size_t PD>
+void StreamingKMeans<PT, PD>::fit(unsigned int seed)
+{
+  if (centroids.empty())
+  {
+    sampleCentroids(seed);
+    if (numPoints < numClusters)
+    {
+      throw std::runtime_error("The dataset has fewer points than clusters");
+    }
+  }
+
+  for (iterations = 1; iterations <= maxIterations; ++iterations)
+  {
+    std::vector<PT> sums(numClusters * PD, 0);
+    std::vector<std::size_t> counts(numClusters, 0);
+    inertia = 0;
+    forEachBlock([&](const std::vector<PT> &block, std::size_t count)
+    {
+      inertia += assignBlock(block, count, nullptr, &sums, &counts);
+    });
+    numPoints = 0;
+    for (std::size_t count : counts)
+    {
+      numPoints += count;
+    }
+
+    // An empty cluster keeps its centroid
+    PT shift = 0;
+    for (std::size_t k = 0; k < numClusters; ++k)
+    {
+      if (counts[k] == 0)
+      {
+        continue;
+      }
+      PT distance = 0;
+      for (std::size_t d = 0; d < PD; ++d)
+      {
+        const PT mean = sums[k * PD + d] / counts[k];
+        distance += (mean - centroids[k * PD + d]) * (mean - centroids[k * PD + d]);
+        centroids[k * PD + d] = mean;
+      }
+      shift += std::sqrt(distance);
+    }
+
+    if (shift / numClusters <= treshold)
+    {
+      break;
+    }
+  }
+  iterations = std::min(iterations, maxIterations);
+}
+
+template <typename PT, std::size_t PD>
+void StreamingKMeans<PT, PD>::writeLabels(const std::string &path)
+{
+  std::ofstream out(path, std::ios::binary);
+  if (!out)
+  {
+    throw std::runtime_error("Cannot write point file: " + path);
+  }
+
+  // The number of points is known from the previous passes, the header is patched if it changed
+  std::size_t written = 0;
+  std::vector<std::int32_t> labels;
+  PointFile::writeHeader<std::int32_t>(out, numPoints, 1);
+  inertia = 0;
+  forEachBlock([&](const std::vector<PT> &block, std::size_t count)
+  {
+    labels.resize(count);
+    inertia += assignBlock(block, count, labels.data(), nullptr, nullptr);
+    writeValues(out, labels.data(), count);
+    written += count;
+  });
+  PointFile::writeColumnPadding<std::int32_t>(out, written);
+
+  if (written != numPoints)
+  {
+    numPoints = written;
+    out.seekp(0);
+    PointFile::writeHeader<std::int32_t>(out, numPoints, 1);
+  }
+  if (!out.flush())
+  {
+    throw std::runtime_error("Cannot write point file: " + path);
+  }
+}
+
+template class StreamingKMeans<double, 2>;
+template class StreamingKMeans<double, 3>;
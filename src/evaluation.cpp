@@ -17,7 +17,7 @@ int main(int argc, char* argv[])
 {
     if (argc < 3) {
         std::cout << "Usage: " << argv[0] << " <num_initialization_method> <metric>" << endl;
-        std::cout << "  <num_initialization_method> : Initialization method for centroids (0: random, 1: KDE, 2: most distant, 3: Static KDE - 3D point)" << endl;
+        std::cout << "  <num_initialization_method> : Initialization method for centroids (0: random, 1: KDE, 2: most distant, 3: Static KDE - 3D point, 4: mean shift, 5: k-means++)" << endl;
         std::cout << "  <metric>                     : Distance metric (0: Euclidean, 1: Dijkstra, 2: Heat)" << endl;
         return 1;
     }
@@ -34,10 +34,11 @@ std::unique_ptr<KdNode<PT, PD>> KdTree<PT, PD>::buildTree(typename std::vector<P
         }
     }
 
-    // If there is only one point, store it in the node
+    // If there is only one point, point the node to it (its place is final, the
+    // partitions above have been done and the sibling ranges are disjoint)
     if (count == 1)
     {
-        node->myPoint = std::make_unique<Point<PT, PD>>(*begin);
+        node->myPoint = &*begin;
         return node;
     }
 
@@ -83,6 +84,42 @@ void KdTree<PT, PD>::clearTree(std::unique_ptr<KdNode<PT, PD>>& node) {
     node.reset();  // Explicitly delete the node
 }
 
+// Collects the points within a ball, pruning the cells that do not intersect it
+template <typename PT, std::size_t PD>
+void KdTree<PT, PD>::radiusSearch(const std::array<PT, PD>& center, PT radius, std::vector<const Point<PT, PD>*>& result) const
+{
+    result.clear();
+    radiusSearch(root.get(), center, radius * radius, result);
+}
+
+template <typename PT, std::size_t PD>
+void KdTree<PT, PD>::radiusSearch(const KdNode<PT, PD>* node, const std::array<PT, PD>& center, PT squaredRadius,
+                                  std::vector<const Point<PT, PD>*>& result) const
+{
+    if (!node)
+        return;
+
+    // Squared distance from the center to the bounding box of the node
+    PT squaredDistance = 0;
+    for (std::size_t i = 0; i < PD; ++i)
+    {
+        const PT below = node->cellMin[i] - center[i];
+        const PT above = center[i] - node->cellMax[i];
+        const PT gap = std::max<PT>(0, std::max(below, above));
+        squaredDistance += gap * gap;
+    }
+    if (squaredDistance > squaredRadius)
+        return;
+
+    if (node->myPoint)
+    {
+        result.push_back(node->myPoint);
+        return;
+    }
+    radiusSearch(node->left.get(), center, squaredRadius, result);
+    radiusSearch(node->right.get(), center, squaredRadius, result);
+}
+
 
 // Explicit instantiation for supported types
 template class KdTree<double, 2>;
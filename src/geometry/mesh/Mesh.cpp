@@ -1,43 +1,372 @@
-#include "objload.h"
 #include "geometry/mesh/Mesh.hpp"
+#include "geometry/mesh/ObjReader.hpp"
+#include "geometry/mesh/MeshExporter.hpp"
+#include "utils/Hash.hpp"
+#include "utils/MappedFile.hpp"
+#include "utils/BinaryIO.hpp"
+#include "utils/RadixSort.hpp"
+#include "geometry/point/SpatialOrder.hpp"
 #include <fstream> // For file output
 #include <sstream> // For stringstream
+#include <algorithm>
+#include <omp.h>
+
+#define MESH_CACHE_MAGIC 0x48534d4b // "KMSH"
+#define MESH_CACHE_VERSION 4
+
+std::string Mesh::cacheDirectory = defaultCacheDirectory("kmeans_mesh_cache");
+
+namespace
+{
+  std::uint64_t hashFile(const std::string &path)
+  {
+    MappedFile file(path);
+    return fnv1a(file.data(), file.size());
+  }
+
+  // Gathers the elements in the given order, `stride` values per element
+  template <typename T>
+  std::vector<T> permute(const std::vector<T> &values, const std::vector<std::uint32_t> &order, int stride)
+  {
+    std::vector<T> permuted(values.size());
+    #pragma omp parallel for
+    for (std::int64_t i = 0; i < order.size(); ++i)
+    {
+      std::copy(values.begin() + order[i] * stride, values.begin() + (order[i] + 1) * stride, permuted.begin() + i * stride);
+    }
+    return permuted;
+  }
+
+  // The position of each element in the given order
+  std::vector<std::uint32_t> inversePermutation(const std::vector<std::uint32_t> &order)
+  {
+    std::vector<std::uint32_t> rank(order.size());
+    #pragma omp parallel for
+    for (std::int64_t i = 0; i < order.size(); ++i)
+    {
+      rank[order[i]] = i;
+    }
+    return rank;
+  }
+
+  // Fixed-size fields at the start of a cache file
+  struct CacheHeader
+  {
+    std::uint64_t sourceSize;
+    std::int64_t sourceMtime;
+    std::uint64_t sourceHash;
+    std::uint64_t numVertices;
+    std::uint64_t numFaces;
+    std::uint32_t numAdjacencyBlocks;
+  };
+
+  // Reads the header of a cache file, false if the format does not match
+  bool readCacheHeader(BinaryReader &reader, CacheHeader &header)
+  {
+    if (reader.readValue<std::uint32_t>() != MESH_CACHE_MAGIC || reader.readValue<std::uint32_t>() != MESH_CACHE_VERSION)
+    {
+      return false;
+    }
+    header.sourceSize = reader.readValue<std::uint64_t>();
+    header.sourceMtime = reader.readValue<std::int64_t>();
+    header.sourceHash = reader.readValue<std::uint64_t>();
+    header.numVertices = reader.readValue<std::uint64_t>();
+    header.numFaces = reader.readValue<std::uint64_t>();
+    header.numAdjacencyBlocks = reader.readValue<std::uint32_t>();
+    return true;
+  }
+
+  // Size of the vertex and face arrays that follow the header
+  std::uint64_t cacheGeometrySize(const CacheHeader &header)
+  {
+    return header.numVertices * 3 * sizeof(double) + header.numFaces * (3 * sizeof(VertId) + 7 * sizeof(double));
+  }
+
+  // Face adjacency of one mode in a cache file: the mode, the number of neighbors, then the CSR arrays
+  struct AdjacencyBlock
+  {
+    std::uint32_t mode;
+    const char *data; // Start of the block, mode included
+    std::size_t size;
+  };
+
+  std::vector<AdjacencyBlock> readAdjacencyBlocks(BinaryReader &reader, const CacheHeader &header)
+  {
+    std::vector<AdjacencyBlock> blocks(header.numAdjacencyBlocks);
+    for (AdjacencyBlock &block : blocks)
+    {
+      const std::size_t fieldsSize = sizeof(std::uint32_t) + sizeof(std::uint64_t);
+      block.data = reader.take(fieldsSize);
+      std::uint64_t numIndices;
+      std::memcpy(&block.mode, block.data, sizeof(std::uint32_t));
+      std::memcpy(&numIndices, block.data + sizeof(std::uint32_t), sizeof(std::uint64_t));
+      const std::size_t arraysSize = (header.numFaces + 1) * sizeof(std::uint32_t) + numIndices * sizeof(FaceId);
+      reader.take(arraysSize);
+      block.size = fieldsSize + arraysSize;
+    }
+    return blocks;
+  }
+
+  // Copies the CSR arrays of a block, false if they are inconsistent
+  bool readAdjacencyBlock(const AdjacencyBlock &block, std::uint64_t numFaces, std::vector<std::uint32_t> &offsets, std::vector<FaceId> &indices)
+  {
+    BinaryReader reader(block.data, block.size);
+    reader.readValue<std::uint32_t>();
+    indices.resize(reader.readValue<std::uint64_t>());
+    offsets.resize(numFaces + 1);
+    reader.readValues(offsets.data(), offsets.size());
+    reader.readValues(indices.data(), indices.size());
+    return offsets.front() == 0 && offsets.back() == indices.size();
+  }
+
+  // The adjacency blocks of a cache file, empty if the file holds another mesh
+  std::vector<AdjacencyBlock> locateAdjacencyBlocks(const MappedFile &file, std::uint64_t sourceHash, std::uint64_t numFaces)
+  {
+    BinaryReader reader(file.data(), verifyChecksum(file.data(), file.size()));
+    CacheHeader header;
+    if (!readCacheHeader(reader, header) || header.sourceHash != sourceHash || header.numFaces != numFaces)
+    {
+      return {};
+    }
+    reader.take(cacheGeometrySize(header));
+    return readAdjacencyBlocks(reader, header);
+  }
+}
 
 Mesh::Mesh(const std::string path)
 {
+  std::error_code ec;
+  if (!cacheDirectory.empty() && std::filesystem::is_regular_file(path, ec))
+  {
+    const std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+    const std::string key = canonical.string();
+    binaryCachePath = (std::filesystem::path(cacheDirectory) / (hashToString(fnv1a(key.data(), key.size())) + ".kmesh")).string();
+    sourceSize = std::filesystem::file_size(path, ec);
+    sourceMtime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+
+    if (readBinary(binaryCachePath, path))
+    {
+      return;
+    }
+  }
+
   try
   {
-    std::ifstream in(path.c_str());
-    auto model = obj::parseObjModel(in);
+    ObjData obj = ObjReader::read(path);
 
-    meshVertices.reserve(model.vertex.size() / 3);
-    std::vector<Point<double, 3>> localMeshVertices(model.vertex.size() / 3);
+    std::vector<Point<double, 3>> localMeshVertices(obj.numVertices());
     #pragma omp parallel for
-    for (int i = 0; i < model.vertex.size(); i += 3)
+    for (int i = 0; i < localMeshVertices.size(); ++i)
     {
-      std::array<double, 3> coords = {model.vertex[i], model.vertex[i + 1], model.vertex[i + 2]};
-      localMeshVertices[i / 3] = Point<double, 3>(coords, i / 3);
+      std::array<double, 3> coords = {obj.vertices[3 * i], obj.vertices[3 * i + 1], obj.vertices[3 * i + 2]};
+      localMeshVertices[i] = Point<double, 3>(coords, i);
     }
     meshVertices = std::move(localMeshVertices);
 
-    const auto faces = model.faces.at("default");
-    const auto &faceVertices = faces.first;
+    // The triangles of all the groups, in file order
+    faceVertices = std::move(obj.triangles);
+    computeFaceGeometry();
+  }
+  catch (const std::exception &e)
+  {
+    throw std::runtime_error("Failed to load file");
+  }
 
-    meshFaces.reserve(faces.first.size() / 3);
-    std::vector<Face> localMeshFaces(faceVertices.size() / 3);
+  if (!binaryCachePath.empty())
+  {
+    sourceHash = hashFile(path);
+    writeBinary(binaryCachePath);
+  }
+}
+
+bool Mesh::readBinary(const std::string &path, const std::string &sourcePath)
+{
+  if (!std::filesystem::is_regular_file(path))
+  {
+    return false;
+  }
+
+  bool touched = false;
+  try
+  {
+    MappedFile file(path);
+    BinaryReader reader(file.data(), verifyChecksum(file.data(), file.size()));
+    CacheHeader header;
+    if (!readCacheHeader(reader, header))
+    {
+      return false;
+    }
+
+    // Same size and modification time, or same content if the source file has been touched
+    if (header.sourceSize != sourceSize)
+    {
+      return false;
+    }
+    touched = header.sourceMtime != sourceMtime;
+    if (touched && hashFile(sourcePath) != header.sourceHash)
+    {
+      return false;
+    }
+    sourceHash = header.sourceHash;
+
+    const std::uint64_t numVertices = header.numVertices;
+    const std::uint64_t numFaces = header.numFaces;
+    const char *vertexData = reader.take(numVertices * 3 * sizeof(double));
+    std::vector<VertId> localFaceVertices(3 * numFaces);
+    std::vector<double> localFaceAreas(numFaces), localFaceNormals(3 * numFaces), localFaceBaricenters(3 * numFaces);
+    reader.readValues(localFaceVertices.data(), localFaceVertices.size());
+    reader.readValues(localFaceAreas.data(), localFaceAreas.size());
+    reader.readValues(localFaceNormals.data(), localFaceNormals.size());
+    reader.readValues(localFaceBaricenters.data(), localFaceBaricenters.size());
+
+    // The adjacency of the current mode, the other modes are read by buildFaceAdjacency
+    std::vector<std::uint32_t> localAdjacencyOffsets;
+    std::vector<FaceId> localAdjacencyIndices;
+    std::set<AdjacencyMode> localCachedModes;
+    for (const AdjacencyBlock &block : readAdjacencyBlocks(reader, header))
+    {
+      localCachedModes.insert(static_cast<AdjacencyMode>(block.mode));
+      if (block.mode == static_cast<std::uint32_t>(adjacencyMode) &&
+          !readAdjacencyBlock(block, numFaces, localAdjacencyOffsets, localAdjacencyIndices))
+      {
+        return false;
+      }
+    }
+
+    std::vector<Point<double, 3>> localMeshVertices(numVertices);
     #pragma omp parallel for
-    for (int j = 0; j < faceVertices.size(); j = j + 3)
+    for (std::int64_t i = 0; i < numVertices; ++i)
     {
-      FaceId faceId(j / 3);
-      Face face = Face({VertId(faceVertices[j].v), VertId(faceVertices[j + 1].v), VertId(faceVertices[j + 2].v)}, meshVertices, faceId);
+      std::array<double, 3> coords;
+      std::memcpy(coords.data(), vertexData + i * 3 * sizeof(double), 3 * sizeof(double));
+      localMeshVertices[i] = Point<double, 3>(coords, i);
+    }
 
-      localMeshFaces[j / 3] = face;
+    meshVertices = std::move(localMeshVertices);
+    faceVertices = std::move(localFaceVertices);
+    faceAreas = std::move(localFaceAreas);
+    faceNormals = std::move(localFaceNormals);
+    faceBaricenters = std::move(localFaceBaricenters);
+    adjacencyOffsets = std::move(localAdjacencyOffsets);
+    adjacencyIndices = std::move(localAdjacencyIndices);
+    builtAdjacencyMode = adjacencyMode;
+    cachedAdjacencyModes = std::move(localCachedModes);
+  }
+  catch (const std::exception &e)
+  {
+    std::cerr << "Ignoring mesh cache file " << path << ": " << e.what() << std::endl;
+    meshVertices.clear();
+    faceVertices.clear();
+    faceAreas.clear();
+    faceNormals.clear();
+    faceBaricenters.clear();
+    adjacencyOffsets.clear();
+    adjacencyIndices.clear();
+    return false;
+  }
+
+  // Record the new modification time, to skip the content check next time
+  if (touched)
+  {
+    writeBinary(path);
+  }
+  return true;
+}
+
+bool Mesh::readCachedAdjacency()
+{
+  try
+  {
+    MappedFile file(binaryCachePath);
+    for (const AdjacencyBlock &block : locateAdjacencyBlocks(file, sourceHash, numFaces()))
+    {
+      if (block.mode == static_cast<std::uint32_t>(adjacencyMode))
+      {
+        std::vector<std::uint32_t> offsets;
+        std::vector<FaceId> indices;
+        if (!readAdjacencyBlock(block, numFaces(), offsets, indices))
+        {
+          return false;
+        }
+        adjacencyOffsets = std::move(offsets);
+        adjacencyIndices = std::move(indices);
+        builtAdjacencyMode = adjacencyMode;
+        return true;
+      }
     }
-    meshFaces = std::move(localMeshFaces);
   }
   catch (const std::exception &e)
   {
-    throw std::runtime_error("Failed to load file");
+    std::cerr << "Ignoring mesh cache file " << binaryCachePath << ": " << e.what() << std::endl;
+  }
+  return false;
+}
+
+void Mesh::writeBinary(const std::string &path)
+{
+  const bool hasAdjacency = adjacencyOffsets.size() == numFaces() + 1;
+
+  // The adjacency of the other modes is carried over from the current file
+  std::vector<char> otherBlocks;
+  std::set<AdjacencyMode> modes;
+  if (hasAdjacency)
+  {
+    modes.insert(builtAdjacencyMode);
+  }
+  const bool carryOver = std::any_of(cachedAdjacencyModes.begin(), cachedAdjacencyModes.end(), [&](AdjacencyMode mode)
+                                     { return !modes.count(mode); });
+  if (carryOver)
+  {
+    try
+    {
+      MappedFile file(path);
+      for (const AdjacencyBlock &block : locateAdjacencyBlocks(file, sourceHash, numFaces()))
+      {
+        if (modes.insert(static_cast<AdjacencyMode>(block.mode)).second)
+        {
+          otherBlocks.insert(otherBlocks.end(), block.data, block.data + block.size);
+        }
+      }
+    }
+    catch (const std::exception &)
+    {
+      // The other modes are rebuilt when needed
+    }
+  }
+
+  const bool written = writeFileAtomically(path, [&](std::ofstream &out)
+  {
+    writeValue<std::uint32_t>(out, MESH_CACHE_MAGIC);
+    writeValue<std::uint32_t>(out, MESH_CACHE_VERSION);
+    writeValue<std::uint64_t>(out, sourceSize);
+    writeValue<std::int64_t>(out, sourceMtime);
+    writeValue<std::uint64_t>(out, sourceHash);
+    writeValue<std::uint64_t>(out, meshVertices.size());
+    writeValue<std::uint64_t>(out, numFaces());
+    writeValue<std::uint32_t>(out, modes.size());
+
+    for (const auto &vertex : meshVertices)
+    {
+      writeValues(out, vertex.coordinates.data(), 3);
+    }
+    writeValues(out, faceVertices.data(), faceVertices.size());
+    writeValues(out, faceAreas.data(), faceAreas.size());
+    writeValues(out, faceNormals.data(), faceNormals.size());
+    writeValues(out, faceBaricenters.data(), faceBaricenters.size());
+
+    if (hasAdjacency)
+    {
+      writeValue<std::uint32_t>(out, static_cast<std::uint32_t>(builtAdjacencyMode));
+      writeValue<std::uint64_t>(out, adjacencyIndices.size());
+      writeValues(out, adjacencyOffsets.data(), adjacencyOffsets.size());
+      writeValues(out, adjacencyIndices.data(), adjacencyIndices.size());
+    }
+    writeValues(out, otherBlocks.data(), otherBlocks.size());
+  });
+
+  if (written)
+  {
+    cachedAdjacencyModes = std::move(modes);
   }
 }
 
@@ -65,6 +394,9 @@ int Mesh::createSegmentationFromSegFile(const std::filesystem::path &path)
     throw std::runtime_error("Failed to open file");
   }
 
+  // The lines of the file follow the file order of the faces
+  const std::vector<FaceId> faces = facesInFileOrder();
+
   std::string line;
   int faceId = 0;
   int maxCluster = 0;
@@ -77,7 +409,7 @@ int Mesh::createSegmentationFromSegFile(const std::filesystem::path &path)
       break;
     } // error
 
-    this->setFaceCluster(FaceId(faceId), cluster);
+    this->setFaceCluster(faceId < faces.size() ? faces[faceId] : FaceId(faceId), cluster);
 
     if (cluster > maxCluster)
     {
@@ -89,171 +421,393 @@ int Mesh::createSegmentationFromSegFile(const std::filesystem::path &path)
   return maxCluster + 1;
 }
 
-void Mesh::buildFaceAdjacency()
+bool Mesh::hasFaceAdjacency() const
 {
-    faceAdjacency.clear();
+  return adjacencyOffsets.size() == numFaces() + 1 && builtAdjacencyMode == adjacencyMode;
+}
 
-    std::unordered_map<VertId, std::set<FaceId>> vertexToFaces;
+void Mesh::buildFaceAdjacency()
+{
+  // Meshes without vertices (coarse levels) only have an explicit adjacency
+  if (hasFaceAdjacency() || numFaces() == 0 || faceVertices[0] == NO_VERTEX)
+  {
+    return;
+  }
 
-    #pragma omp parallel
-    {
-        std::unordered_map<VertId, std::set<FaceId>> vertexToFacesThreadLocal;
+  // The cache file may hold the adjacency of this mode
+  if (!binaryCachePath.empty() && cachedAdjacencyModes.count(adjacencyMode) && readCachedAdjacency())
+  {
+    return;
+  }
 
-        #pragma omp for nowait
-        for (size_t i = 0; i < meshFaces.size(); i++)
-        {
-            const auto &face = meshFaces[i];
-            for (VertId vertex : face.vertices)
-            {
-                vertexToFacesThreadLocal[vertex].insert(face.baricenter.id);
-            }
-        }
+  const int numFaces = this->numFaces();
+  const bool edges = adjacencyMode == AdjacencyMode::EDGE;
 
-        #pragma omp critical
-        {
-            for (const auto &[vertex, faces] : vertexToFacesThreadLocal)
-            {
-                vertexToFaces[vertex].insert(faces.begin(), faces.end());
-            }
-        }
+  // One (key, corner) pair per face corner, the key being the vertex or the edge
+  // leaving the corner, and the corner being 3 * face + index in the face
+  std::vector<std::uint64_t> keys(3 * numFaces);
+  std::vector<std::uint32_t> corners(3 * numFaces);
+  #pragma omp parallel for
+  for (int f = 0; f < numFaces; ++f)
+  {
+    for (int c = 0; c < 3; ++c)
+    {
+      const std::uint64_t v1 = faceVertices[3 * f + c], v2 = faceVertices[3 * f + (c + 1) % 3];
+      keys[3 * f + c] = edges ? (std::min(v1, v2) << 32 | std::max(v1, v2)) : v1;
+      corners[3 * f + c] = 3 * f + c;
     }
+  }
+  radixSortPairs(keys, corners);
 
-    std::vector<std::vector<FaceId>> tempFaceAdjacency(meshFaces.size());
-
-    #pragma omp parallel for
-    for (size_t i = 0; i < meshFaces.size(); i++)
+  // Group the corners with the same key, and number the groups
+  std::vector<std::uint32_t> groupOffsets;
+  std::vector<std::uint32_t> cornerGroup(3 * numFaces);
+  groupOffsets.reserve(keys.empty() ? 1 : 2 * numFaces);
+  for (std::size_t i = 0; i < keys.size(); ++i)
+  {
+    if (i == 0 || keys[i] != keys[i - 1])
     {
-        const auto &face = meshFaces[i];
-        std::set<FaceId> adjacentFacesSet;
+      groupOffsets.push_back(i);
+    }
+    cornerGroup[corners[i]] = groupOffsets.size() - 1;
+  }
+  groupOffsets.push_back(keys.size());
 
-        for (VertId vertex : face.vertices)
+  // The neighbors of a face are the faces in the groups of its corners
+  auto collectNeighbors = [&](int f, std::vector<FaceId> &neighbors)
+  {
+    neighbors.clear();
+    for (int c = 0; c < 3; ++c)
+    {
+      const std::uint32_t group = cornerGroup[3 * f + c];
+      for (std::uint32_t i = groupOffsets[group]; i < groupOffsets[group + 1]; ++i)
+      {
+        const FaceId g = corners[i] / 3;
+        if (g != FaceId(f))
         {
-            const auto &connectedFaces = vertexToFaces[vertex];
-            adjacentFacesSet.insert(connectedFaces.begin(), connectedFaces.end());
+          neighbors.push_back(g);
         }
+      }
+    }
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+  };
 
-        adjacentFacesSet.erase(face.baricenter.id);
-        tempFaceAdjacency[i] = std::vector<FaceId>(adjacentFacesSet.begin(), adjacentFacesSet.end());
+  // Count, then fill the compressed rows
+  adjacencyOffsets.assign(numFaces + 1, 0);
+  #pragma omp parallel
+  {
+    std::vector<FaceId> neighbors;
+    #pragma omp for
+    for (int f = 0; f < numFaces; ++f)
+    {
+      collectNeighbors(f, neighbors);
+      adjacencyOffsets[f + 1] = neighbors.size();
     }
+  }
+  for (int f = 0; f < numFaces; ++f)
+  {
+    adjacencyOffsets[f + 1] += adjacencyOffsets[f];
+  }
 
-    for (size_t i = 0; i < meshFaces.size(); i++)
+  adjacencyIndices.resize(adjacencyOffsets.back());
+  #pragma omp parallel
+  {
+    std::vector<FaceId> neighbors;
+    #pragma omp for
+    for (int f = 0; f < numFaces; ++f)
     {
-        faceAdjacency[meshFaces[i].baricenter.id] = std::move(tempFaceAdjacency[i]);
+      collectNeighbors(f, neighbors);
+      std::copy(neighbors.begin(), neighbors.end(), adjacencyIndices.begin() + adjacencyOffsets[f]);
     }
+  }
+  builtAdjacencyMode = adjacencyMode;
+
+  // Store the adjacency with the cached mesh, next to the ones of the other modes, so it
+  // is not computed again on the next load; the cache only misses the adjacency of this mode here
+  if (!binaryCachePath.empty())
+  {
+    writeBinary(binaryCachePath);
+  }
 }
 
-void Mesh::exportToObj(const std::string &filepath, int cluster)
+void Mesh::reorderSpatially()
 {
-  std::ofstream objFile(filepath);
+  const int numFaces = this->numFaces();
 
-  if (!objFile.is_open())
+  // Vertices by position, the face vertex indices follow them
+  if (!meshVertices.empty())
   {
-    std::cerr << "Failed to open file: " << filepath << std::endl;
-    return;
+    std::vector<double> coordinates(3 * meshVertices.size());
+    #pragma omp parallel for
+    for (int v = 0; v < meshVertices.size(); ++v)
+    {
+      std::copy(meshVertices[v].coordinates.begin(), meshVertices[v].coordinates.end(), coordinates.begin() + 3 * v);
+    }
+    const std::vector<std::uint32_t> vertexOrder = SpatialOrder::mortonOrder(coordinates.data(), meshVertices.size(), 3);
+    const std::vector<std::uint32_t> vertexRank = inversePermutation(vertexOrder);
+
+    std::vector<Point<double, 3>> sortedVertices(meshVertices.size());
+    #pragma omp parallel for
+    for (int v = 0; v < sortedVertices.size(); ++v)
+    {
+      sortedVertices[v] = meshVertices[vertexOrder[v]];
+      sortedVertices[v].id = v;
+    }
+    meshVertices = std::move(sortedVertices);
+
+    // Compose with a previous reordering, to keep pointing to the file order
+    std::vector<VertId> fileVertexIds(meshVertices.size());
+    #pragma omp parallel for
+    for (int v = 0; v < fileVertexIds.size(); ++v)
+    {
+      fileVertexIds[v] = getOriginalVertexId(vertexOrder[v]);
+    }
+    originalVertexIds = std::move(fileVertexIds);
+
+    #pragma omp parallel for
+    for (std::int64_t i = 0; i < faceVertices.size(); ++i)
+    {
+      if (faceVertices[i] != NO_VERTEX)
+      {
+        faceVertices[i] = vertexRank[faceVertices[i]];
+      }
+    }
   }
 
-  // Write the vertices to the file (in .obj format)
-  for (const auto &vertex : meshVertices)
+  // Faces by baricenter
+  const std::vector<std::uint32_t> order = SpatialOrder::mortonOrder(faceBaricenters.data(), numFaces, 3);
+  const std::vector<std::uint32_t> rank = inversePermutation(order);
+  faceVertices = permute(faceVertices, order, 3);
+  faceAreas = permute(faceAreas, order, 1);
+  faceNormals = permute(faceNormals, order, 3);
+  faceBaricenters = permute(faceBaricenters, order, 3);
+
+  std::unordered_map<FaceId, int> clusters;
+  clusters.reserve(faceClusters.size());
+  for (const auto &[face, cluster] : faceClusters)
   {
-    objFile << "v " << vertex.coordinates[0] << " " << vertex.coordinates[1] << " " << vertex.coordinates[2] << std::endl;
+    clusters[rank[face]] = cluster;
   }
+  faceClusters = std::move(clusters);
 
-  for (FaceId faceId = 0; faceId < meshFaces.size(); ++faceId)
+  // Move the rows of the adjacency, and renumber and sort their neighbors
+  if (adjacencyOffsets.size() == numFaces + 1)
   {
-    if (getFaceCluster(faceId) == cluster)
-    { // Check if the cluster ID is 0
-      const Face &face = meshFaces[faceId];
-
-      // Write the face in OBJ format (note that OBJ uses 1-based indexing)
-      objFile << "f";
-      for (const auto &vertId : face.vertices)
+    std::vector<std::uint32_t> offsets(numFaces + 1, 0);
+    for (int f = 0; f < numFaces; ++f)
+    {
+      offsets[f + 1] = offsets[f] + adjacencyOffsets[order[f] + 1] - adjacencyOffsets[order[f]];
+    }
+    std::vector<FaceId> indices(adjacencyIndices.size());
+    #pragma omp parallel for
+    for (int f = 0; f < numFaces; ++f)
+    {
+      std::uint32_t position = offsets[f];
+      for (std::uint32_t i = adjacencyOffsets[order[f]]; i < adjacencyOffsets[order[f] + 1]; ++i)
       {
-        objFile << " " << (vertId + 1); // OBJ indices are 1-based
+        indices[position++] = rank[adjacencyIndices[i]];
       }
-      objFile << std::endl;
+      std::sort(indices.begin() + offsets[f], indices.begin() + offsets[f + 1]);
+    }
+    adjacencyOffsets = std::move(offsets);
+    adjacencyIndices = std::move(indices);
+  }
+
+  for (auto &[mode, modeLandmarks] : landmarks)
+  {
+    for (FaceId &face : modeLandmarks.faces)
+    {
+      face = rank[face];
+    }
+    for (std::vector<double> &distances : modeLandmarks.distances)
+    {
+      distances = permute(distances, order, 1);
     }
   }
 
-  objFile.close();
-  std::cout << "Exported mesh to " << filepath << std::endl;
+  // Compose with a previous reordering, to keep pointing to the file order
+  std::vector<FaceId> fileIds(numFaces);
+  #pragma omp parallel for
+  for (int f = 0; f < numFaces; ++f)
+  {
+    fileIds[f] = getOriginalFaceId(order[f]);
+  }
+  originalFaceIds = std::move(fileIds);
+
+  // The cache holds the mesh in file order
+  binaryCachePath.clear();
 }
 
-const int Mesh::getFaceCluster(FaceId face) const
+std::vector<VertId> Mesh::verticesInFileOrder() const
 {
-  try
+  std::vector<VertId> vertices(meshVertices.size());
+  #pragma omp parallel for
+  for (int v = 0; v < vertices.size(); ++v)
+  {
+    vertices[getOriginalVertexId(v)] = v;
+  }
+  return vertices;
+}
+
+std::vector<FaceId> Mesh::facesInFileOrder() const
+{
+  std::vector<FaceId> faces(numFaces());
+  #pragma omp parallel for
+  for (int f = 0; f < faces.size(); ++f)
   {
-      return faceClusters.at(face);
+    faces[getOriginalFaceId(f)] = f;
   }
-  catch (const std::out_of_range &e)
+  return faces;
+}
+
+void Mesh::exportToObj(const std::string &filepath, int cluster) const
+{
+  if (MeshExporter::writeObj(*this, filepath, cluster))
+  {
+    std::cout << "Exported mesh to " << filepath << std::endl;
+  }
+}
+
+void Mesh::exportToGroupedObj(const std::string &filepath) const
+{
+  if (MeshExporter::writeGroupedObj(*this, filepath))
+  {
+    std::cout << "Exported grouped mesh to " << filepath << std::endl;
+  }
+}
+
+void Mesh::exportToPly(const std::string &filepath) const
+{
+  if (MeshExporter::writePly(*this, filepath))
+  {
+    std::cout << "Exported segmented mesh to " << filepath << std::endl;
+  }
+}
+
+void Mesh::exportToSeg(const std::string &filepath) const
+{
+  if (MeshExporter::writeSeg(*this, filepath))
   {
-      return -1;
+    std::cout << "Exported segmentation to " << filepath << std::endl;
   }
 }
 
-std::vector<Point<double, 3>> Mesh::getMeshFacesPoints()
+const int Mesh::getFaceCluster(FaceId face) const
+{
+  const auto it = faceClusters.find(face);
+  return it != faceClusters.end() ? it->second : -1;
+}
+
+std::vector<Point<double, 3>> Mesh::getMeshFacesPoints() const
 {
-    std::vector<Point<double, 3>> faces;
-    for (const auto &face : meshFaces)
+    std::vector<Point<double, 3>> faces(numFaces());
+    #pragma omp parallel for
+    for (int f = 0; f < faces.size(); ++f)
     {
-        faces.push_back(face.baricenter);
+        faces[f] = Point<double, 3>({faceBaricenters[3 * f], faceBaricenters[3 * f + 1], faceBaricenters[3 * f + 2]}, f);
     }
     return faces;
 }
 
-void Mesh::exportToGroupedObj(const std::string &filepath) const
+Face Mesh::getFace(const FaceId face) const
 {
-  std::ofstream objFile(filepath);
+    const Point<double, 3> baricenter({faceBaricenters[3 * face], faceBaricenters[3 * face + 1], faceBaricenters[3 * face + 2]});
+    const Point<double, 3> normal({faceNormals[3 * face], faceNormals[3 * face + 1], faceNormals[3 * face + 2]});
+    return Face({faceVertices[3 * face], faceVertices[3 * face + 1], faceVertices[3 * face + 2]}, faceAreas[face], baricenter, normal, face);
+}
 
-  if (!objFile.is_open())
+void Mesh::addVertex(const Point<double, 3> &vertex)
+{
+  meshVertices.push_back(vertex);
+  if (!originalVertexIds.empty())
   {
-    std::cerr << "Failed to open file: " << filepath << std::endl;
-    return;
+    originalVertexIds.push_back(originalVertexIds.size());
   }
+}
 
-  // Write the vertices to the file (in .obj format)
-  objFile << "# Vertices\n";
-  for (const auto &vertex : meshVertices)
+void Mesh::addFace(const Face &face)
+{
+  faceVertices.insert(faceVertices.end(), face.vertices.begin(), face.vertices.end());
+  faceAreas.push_back(face.area);
+  faceNormals.insert(faceNormals.end(), face.normal.coordinates.begin(), face.normal.coordinates.end());
+  faceBaricenters.insert(faceBaricenters.end(), face.baricenter.coordinates.begin(), face.baricenter.coordinates.end());
+  if (!originalFaceIds.empty())
   {
-    objFile << "v " << vertex.coordinates[0] << " "
-            << vertex.coordinates[1] << " "
-            << vertex.coordinates[2] << std::endl;
+    originalFaceIds.push_back(originalFaceIds.size());
   }
+  adjacencyOffsets.clear();
+  adjacencyIndices.clear();
+  landmarks.clear(); // Their distance fields no longer cover every face
+}
 
-  // Initialize current cluster and group
-  int currentCluster = -1;
-
-  objFile << "# Faces grouped by clusters\n";
-  for (FaceId faceId = 0; faceId < meshFaces.size(); ++faceId)
+void Mesh::computeFaceGeometry()
+{
+  const int numFaces = faceVertices.size() / 3;
+  faceAreas.resize(numFaces);
+  faceNormals.resize(3 * numFaces);
+  faceBaricenters.resize(3 * numFaces);
+
+  // Same computation as the Face constructor, on the flat arrays
+  #pragma omp parallel for
+  for (int f = 0; f < numFaces; ++f)
   {
-    int cluster = getFaceCluster(faceId);
+    const auto &v0 = meshVertices[faceVertices[3 * f]].coordinates;
+    const auto &v1 = meshVertices[faceVertices[3 * f + 1]].coordinates;
+    const auto &v2 = meshVertices[faceVertices[3 * f + 2]].coordinates;
 
-    // If cluster changes, write a new group
-    if (cluster != currentCluster)
+    double e1[3], e2[3];
+    for (int d = 0; d < 3; ++d)
     {
-      currentCluster = cluster;
-      objFile << "\ng cluster_" << currentCluster << std::endl;
+      e1[d] = v1[d] - v0[d];
+      e2[d] = v2[d] - v0[d];
     }
+    const double cross[3] = {e1[1] * e2[2] - e1[2] * e2[1],
+                             e1[2] * e2[0] - e1[0] * e2[2],
+                             e1[0] * e2[1] - e1[1] * e2[0]};
+    const double norm = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
 
-    // Write the face in OBJ format (note that OBJ uses 1-based indexing)
-    const Face &face = meshFaces[faceId];
-    objFile << "f";
-    for (const auto &vertId : face.vertices)
+    faceAreas[f] = 0.5 * norm;
+    for (int d = 0; d < 3; ++d)
     {
-      objFile << " " << (vertId + 1); // OBJ indices are 1-based
+      faceNormals[3 * f + d] = cross[d] / norm;
+      faceBaricenters[3 * f + d] = (v0[d] + v1[d] + v2[d]) / 3;
     }
-    objFile << std::endl;
   }
+}
 
-  objFile.close();
-  std::cout << "Exported grouped mesh to " << filepath << std::endl;
+void Mesh::setFaceAdjacency(const std::vector<std::vector<FaceId>> &adjacency)
+{
+  adjacencyOffsets.assign(adjacency.size() + 1, 0);
+  for (FaceId f = 0; f < adjacency.size(); ++f)
+  {
+    adjacencyOffsets[f + 1] = adjacencyOffsets[f] + adjacency[f].size();
+  }
+  adjacencyIndices.resize(adjacencyOffsets.back());
+  #pragma omp parallel for
+  for (int f = 0; f < adjacency.size(); ++f)
+  {
+    std::copy(adjacency[f].begin(), adjacency[f].end(), adjacencyIndices.begin() + adjacencyOffsets[f]);
+  }
+  builtAdjacencyMode = adjacencyMode;
+  landmarks.erase(adjacencyMode); // Computed on the previous adjacency
 }
 
-void Mesh::addVertex(const Point<double, 3> &vertex)
+void Mesh::setLandmarks(std::vector<FaceId> faces, std::vector<std::vector<double>> distances)
 {
-  meshVertices.push_back(vertex);
+  landmarks[adjacencyMode] = {std::move(faces), std::move(distances)};
 }
 
-void Mesh::addFace(const Face &face)
+const std::vector<FaceId> &Mesh::getLandmarkFaces() const
+{
+  static const Landmarks none;
+  const auto it = landmarks.find(adjacencyMode);
+  return it != landmarks.end() ? it->second.faces : none.faces;
+}
+
+const std::vector<std::vector<double>> &Mesh::getLandmarkDistances() const
 {
-  meshFaces.push_back(face);
+  static const Landmarks none;
+  const auto it = landmarks.find(adjacencyMode);
+  return it != landmarks.end() ? it->second.distances : none.distances;
 }
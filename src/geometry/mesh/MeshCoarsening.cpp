@@ -0,0 +1,161 @@
+#include "geometry/mesh/MeshCoarsening.hpp"
+
+namespace
+{
+  // Heavier edges join close faces with similar orientation
+  double matchingWeight(const Mesh &mesh, FaceId f1, FaceId f2)
+  {
+    const Span<const double> b1 = mesh.getFaceBaricenter(f1), b2 = mesh.getFaceBaricenter(f2);
+    const Span<const double> n1 = mesh.getFaceNormal(f1), n2 = mesh.getFaceNormal(f2);
+    double dist2 = 0, dot = 0;
+    for (int d = 0; d < 3; ++d)
+    {
+      const double diff = b1[d] - b2[d];
+      dist2 += diff * diff;
+      dot += n1[d] * n2[d];
+    }
+    return (1.0 + dot) / (std::sqrt(dist2) + 1e-12);
+  }
+}
+
+Mesh MeshCoarsening::coarsen(Mesh &mesh, std::vector<FaceId> &parent, unsigned int seed)
+{
+  const int numFaces = mesh.numFaces();
+  std::vector<int> match(numFaces, -1);
+
+  std::vector<FaceId> order(numFaces);
+  for (int i = 0; i < numFaces; ++i)
+  {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), std::mt19937(seed));
+
+  // Greedy heavy-edge matching
+  for (FaceId f : order)
+  {
+    if (match[f] >= 0)
+    {
+      continue;
+    }
+
+    int best = -1;
+    double bestWeight = -1;
+    for (FaceId g : mesh.getFaceAdjacencyAt(f))
+    {
+      if (match[g] >= 0)
+      {
+        continue;
+      }
+      const double weight = matchingWeight(mesh, f, g);
+      if (weight > bestWeight)
+      {
+        bestWeight = weight;
+        best = g;
+      }
+    }
+
+    match[f] = best >= 0 ? best : f;
+    if (best >= 0)
+    {
+      match[best] = f;
+    }
+  }
+
+  // Number the super-faces
+  parent.assign(numFaces, 0);
+  std::vector<std::array<FaceId, 2>> children;
+  children.reserve(numFaces / 2 + 1);
+  for (FaceId f = 0; f < numFaces; ++f)
+  {
+    if (FaceId(match[f]) >= f)
+    {
+      parent[f] = parent[match[f]] = children.size();
+      children.push_back({f, FaceId(match[f])});
+    }
+  }
+
+  std::vector<Face> coarseFaces(children.size());
+  #pragma omp parallel for
+  for (int c = 0; c < children.size(); ++c)
+  {
+    const FaceId f1 = children[c][0], f2 = children[c][1];
+    const bool single = f1 == f2;
+    const double area1 = mesh.getFaceArea(f1), area2 = mesh.getFaceArea(f2);
+    const Span<const double> b1 = mesh.getFaceBaricenter(f1), b2 = mesh.getFaceBaricenter(f2);
+    const Span<const double> n1 = mesh.getFaceNormal(f1), n2 = mesh.getFaceNormal(f2);
+
+    const double area = single ? area1 : area1 + area2;
+    Point<double, 3> baricenter, normal;
+    for (int d = 0; d < 3; ++d)
+    {
+      if (single || area <= 0)
+      {
+        baricenter.coordinates[d] = b1[d];
+        normal.coordinates[d] = n1[d];
+      }
+      else
+      {
+        baricenter.coordinates[d] = (area1 * b1[d] + area2 * b2[d]) / area;
+        normal.coordinates[d] = area1 * n1[d] + area2 * n2[d];
+      }
+    }
+    const double normalNorm = normal.norm();
+    if (normalNorm > 0)
+    {
+      normal = normal / normalNorm;
+    }
+
+    coarseFaces[c] = Face({NO_VERTEX, NO_VERTEX, NO_VERTEX}, area, baricenter, normal, c);
+  }
+
+  // Two super-faces are adjacent if any of their faces are
+  std::vector<std::vector<FaceId>> coarseAdjacency(children.size());
+  #pragma omp parallel for
+  for (int c = 0; c < children.size(); ++c)
+  {
+    auto &neighbors = coarseAdjacency[c];
+    for (FaceId child : children[c])
+    {
+      for (FaceId g : mesh.getFaceAdjacencyAt(child))
+      {
+        if (parent[g] != FaceId(c))
+        {
+          neighbors.push_back(parent[g]);
+        }
+      }
+    }
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+  }
+
+  Mesh coarse;
+  for (auto &face : coarseFaces)
+  {
+    coarse.addFace(face);
+  }
+  coarse.setAdjacencyMode(mesh.getAdjacencyMode());
+  coarse.setFaceAdjacency(coarseAdjacency);
+  return coarse;
+}
+
+void MeshCoarsening::buildHierarchy(Mesh &mesh, int targetFaces, std::vector<Mesh> &levels, std::vector<std::vector<FaceId>> &parents)
+{
+  levels.clear();
+  parents.clear();
+
+  mesh.buildFaceAdjacency();
+  Mesh *current = &mesh;
+  while (current->numFaces() > targetFaces)
+  {
+    std::vector<FaceId> parent;
+    Mesh coarse = coarsen(*current, parent, levels.size());
+    if (coarse.numFaces() > COARSENING_MIN_REDUCTION * current->numFaces())
+    {
+      break;
+    }
+
+    levels.push_back(std::move(coarse));
+    parents.push_back(std::move(parent));
+    current = &levels.back();
+  }
+}
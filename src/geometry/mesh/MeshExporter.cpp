@@ -0,0 +1,245 @@
+#include "geometry/mesh/MeshExporter.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <omp.h>
+
+namespace
+{
+  // Appends the shortest decimal representation of a number
+  template <typename T>
+  void appendNumber(std::string &buffer, T value)
+  {
+    char digits[32];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, result.ptr);
+  }
+
+  // Appends the bytes of a value
+  template <typename T>
+  void appendBytes(std::string &buffer, const T &value)
+  {
+    buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  // Writes `count` records appended to a buffer by `format(i, buffer)`. Blocks of records
+  // are formatted in parallel, a few per thread at a time, and written in order.
+  template <typename Format>
+  void writeBlocks(std::ofstream &out, std::size_t count, Format format)
+  {
+    const std::size_t numBlocks = (count + EXPORT_BLOCK_SIZE - 1) / EXPORT_BLOCK_SIZE;
+    const std::size_t blocksPerRound = static_cast<std::size_t>(omp_get_max_threads()) * EXPORT_BLOCKS_PER_THREAD;
+    std::vector<std::string> buffers(std::min(numBlocks, blocksPerRound));
+
+    for (std::size_t first = 0; first < numBlocks; first += blocksPerRound)
+    {
+      const std::size_t last = std::min(numBlocks, first + blocksPerRound);
+      #pragma omp parallel for schedule(dynamic)
+      for (std::int64_t b = first; b < last; ++b)
+      {
+        std::string &buffer = buffers[b - first];
+        buffer.clear();
+        const std::size_t end = std::min(count, (b + 1) * std::size_t(EXPORT_BLOCK_SIZE));
+        for (std::size_t i = b * EXPORT_BLOCK_SIZE; i < end; ++i)
+        {
+          format(i, buffer);
+        }
+      }
+
+      for (std::size_t b = first; b < last; ++b)
+      {
+        out.write(buffers[b - first].data(), buffers[b - first].size());
+      }
+    }
+  }
+
+  bool openFile(std::ofstream &out, const std::string &path, std::ios::openmode mode = std::ios::out)
+  {
+    out.open(path, mode);
+    if (!out.is_open())
+    {
+      std::cerr << "Failed to open file: " << path << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  // The vertices in file order
+  void writeObjVertices(std::ofstream &out, const Mesh &mesh)
+  {
+    Span<const Point<double, 3>> vertices = mesh.getMeshVertices();
+    const std::vector<VertId> order = mesh.verticesInFileOrder();
+    writeBlocks(out, order.size(), [&](std::size_t i, std::string &buffer)
+    {
+      buffer += 'v';
+      for (int d = 0; d < 3; ++d)
+      {
+        buffer += ' ';
+        appendNumber(buffer, vertices[order[i]].coordinates[d]);
+      }
+      buffer += '\n';
+    });
+  }
+
+  void writeObjFaces(std::ofstream &out, const Mesh &mesh, const FaceId *faces, std::size_t count)
+  {
+    writeBlocks(out, count, [&](std::size_t i, std::string &buffer)
+    {
+      // OBJ indices are 1-based
+      buffer += 'f';
+      for (VertId v : mesh.getFaceVertices(faces[i]))
+      {
+        buffer += ' ';
+        appendNumber(buffer, mesh.getOriginalVertexId(v) + 1);
+      }
+      buffer += '\n';
+    });
+  }
+}
+
+std::vector<int> MeshExporter::fileOrderLabels(const Mesh &mesh, const std::vector<FaceId> &faces)
+{
+  std::vector<int> labels(faces.size());
+  #pragma omp parallel for
+  for (std::int64_t i = 0; i < faces.size(); ++i)
+  {
+    labels[i] = mesh.getFaceCluster(faces[i]);
+  }
+  return labels;
+}
+
+bool MeshExporter::writeObj(const Mesh &mesh, const std::string &path, int cluster)
+{
+  std::ofstream out;
+  if (!openFile(out, path))
+  {
+    return false;
+  }
+
+  const std::vector<FaceId> faces = mesh.facesInFileOrder();
+  const std::vector<int> labels = fileOrderLabels(mesh, faces);
+  std::vector<FaceId> clusterFaces;
+  for (std::size_t i = 0; i < faces.size(); ++i)
+  {
+    if (labels[i] == cluster)
+    {
+      clusterFaces.push_back(faces[i]);
+    }
+  }
+
+  writeObjVertices(out, mesh);
+  writeObjFaces(out, mesh, clusterFaces.data(), clusterFaces.size());
+  return static_cast<bool>(out.flush());
+}
+
+bool MeshExporter::writeGroupedObj(const Mesh &mesh, const std::string &path)
+{
+  std::ofstream out;
+  if (!openFile(out, path))
+  {
+    return false;
+  }
+
+  const std::vector<FaceId> faces = mesh.facesInFileOrder();
+  const std::vector<int> labels = fileOrderLabels(mesh, faces);
+
+  // Counting sort of the faces by cluster, -1 (no cluster) included
+  int minLabel = 0, maxLabel = -1;
+  if (!labels.empty())
+  {
+    const auto [minIt, maxIt] = std::minmax_element(labels.begin(), labels.end());
+    minLabel = *minIt;
+    maxLabel = *maxIt;
+  }
+  std::vector<std::size_t> groupOffsets(maxLabel - minLabel + 2, 0);
+  for (int label : labels)
+  {
+    groupOffsets[label - minLabel + 1]++;
+  }
+  for (std::size_t g = 1; g < groupOffsets.size(); ++g)
+  {
+    groupOffsets[g] += groupOffsets[g - 1];
+  }
+  std::vector<FaceId> grouped(faces.size());
+  std::vector<std::size_t> positions(groupOffsets.begin(), groupOffsets.end() - 1);
+  for (std::size_t i = 0; i < faces.size(); ++i)
+  {
+    grouped[positions[labels[i] - minLabel]++] = faces[i];
+  }
+
+  out << "# Vertices\n";
+  writeObjVertices(out, mesh);
+
+  out << "# Faces grouped by clusters\n";
+  for (std::size_t g = 0; g + 1 < groupOffsets.size(); ++g)
+  {
+    if (groupOffsets[g + 1] > groupOffsets[g])
+    {
+      out << "\ng cluster_" << minLabel + static_cast<int>(g) << "\n";
+      writeObjFaces(out, mesh, grouped.data() + groupOffsets[g], groupOffsets[g + 1] - groupOffsets[g]);
+    }
+  }
+  return static_cast<bool>(out.flush());
+}
+
+bool MeshExporter::writePly(const Mesh &mesh, const std::string &path)
+{
+  std::ofstream out;
+  if (!openFile(out, path, std::ios::out | std::ios::binary))
+  {
+    return false;
+  }
+
+  const std::vector<FaceId> faces = mesh.facesInFileOrder();
+  const std::vector<int> labels = fileOrderLabels(mesh, faces);
+  Span<const Point<double, 3>> vertices = mesh.getMeshVertices();
+
+  const std::uint16_t one = 1;
+  const bool littleEndian = *reinterpret_cast<const unsigned char *>(&one) == 1;
+  out << "ply\n"
+      << "format " << (littleEndian ? "binary_little_endian" : "binary_big_endian") << " 1.0\n"
+      << "element vertex " << vertices.size() << "\n"
+      << "property double x\n"
+      << "property double y\n"
+      << "property double z\n"
+      << "element face " << faces.size() << "\n"
+      << "property list uchar int vertex_indices\n"
+      << "property int label\n"
+      << "end_header\n";
+
+  const std::vector<VertId> vertexOrder = mesh.verticesInFileOrder();
+  writeBlocks(out, vertexOrder.size(), [&](std::size_t i, std::string &buffer)
+  {
+    buffer.append(reinterpret_cast<const char *>(vertices[vertexOrder[i]].coordinates.data()), 3 * sizeof(double));
+  });
+  writeBlocks(out, faces.size(), [&](std::size_t i, std::string &buffer)
+  {
+    appendBytes(buffer, static_cast<unsigned char>(3));
+    for (VertId v : mesh.getFaceVertices(faces[i]))
+    {
+      appendBytes(buffer, static_cast<std::int32_t>(mesh.getOriginalVertexId(v)));
+    }
+    appendBytes(buffer, static_cast<std::int32_t>(labels[i]));
+  });
+  return static_cast<bool>(out.flush());
+}
+
+bool MeshExporter::writeSeg(const Mesh &mesh, const std::string &path)
+{
+  std::ofstream out;
+  if (!openFile(out, path))
+  {
+    return false;
+  }
+
+  const std::vector<int> labels = fileOrderLabels(mesh, mesh.facesInFileOrder());
+  writeBlocks(out, labels.size(), [&](std::size_t i, std::string &buffer)
+  {
+    appendNumber(buffer, labels[i]);
+    buffer += '\n';
+  });
+  return static_cast<bool>(out.flush());
+}
@@ -0,0 +1,298 @@
+#include "geometry/mesh/ObjReader.hpp"
+#include "utils/MappedFile.hpp"
+#include "utils/LineChunks.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+  enum class Statement
+  {
+    VERTEX,
+    FACE,
+    GROUP,
+    OTHER
+  };
+
+  // A line-aligned part of the file, with its counts and its place in the output
+  struct Chunk : LineChunk
+  {
+    std::size_t numVertices = 0;
+    std::size_t numTriangles = 0;
+    std::size_t vertexOffset = 0;
+    std::size_t triangleOffset = 0;
+    std::vector<std::pair<std::size_t, std::string>> groupChanges; // (first local triangle, group name)
+    std::string error;
+  };
+
+  bool isBlank(char c)
+  {
+    return c == ' ' || c == '\t' || c == '\r';
+  }
+
+  const char *skipBlanks(const char *p, const char *end)
+  {
+    while (p < end && isBlank(*p))
+    {
+      ++p;
+    }
+    return p;
+  }
+
+  const char *skipToken(const char *p, const char *end)
+  {
+    while (p < end && !isBlank(*p))
+    {
+      ++p;
+    }
+    return p;
+  }
+
+  // Reads the keyword of a line and moves `p` after it
+  Statement readStatement(const char *&p, const char *end)
+  {
+    p = skipBlanks(p, end);
+    const char *keyword = p;
+    p = skipToken(p, end);
+    if (p - keyword != 1)
+    {
+      return Statement::OTHER;
+    }
+    switch (*keyword)
+    {
+    case 'v':
+      return Statement::VERTEX;
+    case 'f':
+      return Statement::FACE;
+    case 'g':
+      return Statement::GROUP;
+    default:
+      return Statement::OTHER;
+    }
+  }
+
+  std::size_t countTokens(const char *p, const char *end)
+  {
+    std::size_t count = 0;
+    for (p = skipBlanks(p, end); p < end; p = skipBlanks(skipToken(p, end), end))
+    {
+      ++count;
+    }
+    return count;
+  }
+
+  bool parseDouble(const char *&p, const char *end, double &value)
+  {
+    p = skipBlanks(p, end);
+    if (p < end && *p == '+')
+    {
+      ++p;
+    }
+    const auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc())
+    {
+      return false;
+    }
+    p = result.ptr;
+    return true;
+  }
+
+  void countChunk(Chunk &chunk)
+  {
+    forEachLine(chunk.begin, chunk.end, [&](const char *p, const char *end)
+    {
+      switch (readStatement(p, end))
+      {
+      case Statement::VERTEX:
+        chunk.numVertices++;
+        break;
+      case Statement::FACE:
+      {
+        const std::size_t corners = countTokens(p, end);
+        chunk.numTriangles += corners >= 3 ? corners - 2 : 0;
+        break;
+      }
+      default:
+        break;
+      }
+      return true;
+    });
+  }
+
+  void parseChunk(Chunk &chunk, std::size_t totalVertices, ObjData &obj)
+  {
+    double *vertices = obj.vertices.data() + 3 * chunk.vertexOffset;
+    VertId *triangles = obj.triangles.data() + 3 * chunk.triangleOffset;
+    std::size_t numVertices = 0, numTriangles = 0;
+    std::vector<VertId> corners;
+
+    forEachLine(chunk.begin, chunk.end, [&](const char *p, const char *end)
+    {
+      switch (readStatement(p, end))
+      {
+      case Statement::VERTEX:
+        for (int d = 0; d < 3; ++d)
+        {
+          if (!parseDouble(p, end, vertices[3 * numVertices + d]))
+          {
+            chunk.error = "Invalid vertex coordinates";
+            return false;
+          }
+        }
+        numVertices++;
+        break;
+
+      case Statement::FACE:
+      {
+        corners.clear();
+        for (p = skipBlanks(p, end); p < end; p = skipBlanks(skipToken(p, end), end))
+        {
+          // Only the vertex index matters, the texture and normal indices are skipped
+          std::int64_t index = 0;
+          const auto result = std::from_chars(p, end, index);
+          if (result.ec != std::errc() || index == 0)
+          {
+            chunk.error = "Invalid face vertex";
+            return false;
+          }
+
+          const std::int64_t verticesBefore = chunk.vertexOffset + numVertices;
+          const std::int64_t vertex = index > 0 ? index - 1 : verticesBefore + index;
+          if (vertex < 0 || vertex >= static_cast<std::int64_t>(totalVertices))
+          {
+            chunk.error = "Face vertex index out of range";
+            return false;
+          }
+          corners.push_back(static_cast<VertId>(vertex));
+        }
+
+        // Fan triangulation around the first corner
+        for (std::size_t c = 1; c + 1 < corners.size(); ++c)
+        {
+          triangles[3 * numTriangles] = corners[0];
+          triangles[3 * numTriangles + 1] = corners[c];
+          triangles[3 * numTriangles + 2] = corners[c + 1];
+          numTriangles++;
+        }
+        break;
+      }
+
+      case Statement::GROUP:
+      {
+        p = skipBlanks(p, end);
+        while (end > p && isBlank(end[-1]))
+        {
+          --end;
+        }
+        chunk.groupChanges.emplace_back(numTriangles, p < end ? std::string(p, end) : std::string(OBJ_DEFAULT_GROUP));
+        break;
+      }
+
+      default:
+        break;
+      }
+      return true;
+    });
+  }
+}
+
+ObjData ObjReader::read(const std::string &path)
+{
+  MappedFile file(path);
+  return parse(file.data(), file.size());
+}
+
+ObjData ObjReader::parse(const char *data, std::size_t size, std::size_t minChunkSize)
+{
+  // Split into line-aligned chunks, a few per thread to balance the load
+  const std::vector<LineChunk> lineChunks = splitLineChunks(data, size, minChunkSize, OBJ_CHUNKS_PER_THREAD);
+  const std::size_t numChunks = lineChunks.size();
+  std::vector<Chunk> chunks(numChunks);
+  for (std::size_t c = 0; c < numChunks; ++c)
+  {
+    static_cast<LineChunk &>(chunks[c]) = lineChunks[c];
+  }
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int c = 0; c < numChunks; ++c)
+  {
+    countChunk(chunks[c]);
+  }
+
+  // Place every chunk in the output arrays
+  std::size_t totalVertices = 0, totalTriangles = 0;
+  for (Chunk &chunk : chunks)
+  {
+    chunk.vertexOffset = totalVertices;
+    chunk.triangleOffset = totalTriangles;
+    totalVertices += chunk.numVertices;
+    totalTriangles += chunk.numTriangles;
+  }
+
+  ObjData obj;
+  obj.vertices.resize(3 * totalVertices);
+  obj.triangles.resize(3 * totalTriangles);
+  obj.triangleGroups.resize(totalTriangles);
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int c = 0; c < numChunks; ++c)
+  {
+    parseChunk(chunks[c], totalVertices, obj);
+  }
+
+  for (const Chunk &chunk : chunks)
+  {
+    if (!chunk.error.empty())
+    {
+      throw std::runtime_error("Invalid OBJ file: " + chunk.error);
+    }
+  }
+
+  // Number the groups in order of appearance, skipping the ones without triangles
+  std::unordered_map<std::string, int> groupIds;
+  std::string currentGroup = OBJ_DEFAULT_GROUP;
+  std::vector<std::vector<std::pair<std::size_t, int>>> groupRuns(numChunks); // (first local triangle, group index)
+  for (std::size_t c = 0; c < numChunks; ++c)
+  {
+    const Chunk &chunk = chunks[c];
+    std::size_t runBegin = 0;
+    for (std::size_t i = 0; i <= chunk.groupChanges.size(); ++i)
+    {
+      const std::size_t runEnd = i < chunk.groupChanges.size() ? chunk.groupChanges[i].first : chunk.numTriangles;
+      if (runEnd > runBegin)
+      {
+        auto [it, inserted] = groupIds.emplace(currentGroup, obj.groups.size());
+        if (inserted)
+        {
+          obj.groups.push_back(currentGroup);
+        }
+        groupRuns[c].emplace_back(runBegin, it->second);
+      }
+      if (i < chunk.groupChanges.size())
+      {
+        currentGroup = chunk.groupChanges[i].second;
+        runBegin = runEnd;
+      }
+    }
+  }
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int c = 0; c < numChunks; ++c)
+  {
+    const auto &runs = groupRuns[c];
+    for (std::size_t r = 0; r < runs.size(); ++r)
+    {
+      const std::size_t runEnd = r + 1 < runs.size() ? runs[r + 1].first : chunks[c].numTriangles;
+      std::fill(obj.triangleGroups.begin() + chunks[c].triangleOffset + runs[r].first,
+                obj.triangleGroups.begin() + chunks[c].triangleOffset + runEnd, runs[r].second);
+    }
+  }
+
+  return obj;
+}
@@ -3,18 +3,10 @@
 // Constructor
 template <typename PT, std::size_t PD>
 EuclideanMetric<PT, PD>::EuclideanMetric(std::vector<Point<PT, PD>> data, double threshold) {
-    this->data = data;
+    this->data = std::move(data);
     this->treshold = threshold;
 
-    #ifdef USE_CUDA
-        if (this->data.size() > MIN_NUM_POINTS_CUDA) {
-            kdtree = nullptr;
-        } else {
-            kdtree = std::make_unique<KdTree<PT, PD>>(this->data);
-        }
-    #else
-        kdtree = std::make_unique<KdTree<PT, PD>>(this->data);
-    #endif
+    buildTree();
 }
 
 template <typename PT, std::size_t PD>
@@ -22,8 +14,26 @@ EuclideanMetric<PT, PD>::EuclideanMetric(Mesh &mesh, double percentage_threshold
 : mesh(&mesh)
 {
     this->treshold = percentage_threshold;
-    this->data = data;
-    
+    this->data = std::move(data);
+
+    buildTree();
+}
+
+template<typename PT, std::size_t PD>
+std::vector<Point<PT, PD>>& EuclideanMetric<PT, PD>::getPoints(){
+    return this->data;
+}
+
+template <typename PT, std::size_t PD>
+void EuclideanMetric<PT, PD>::setPoints(std::vector<Point<PT, PD>> data) {
+    // The leaves of the tree point into the previous points
+    kdtree.reset();
+    Metric<PT, PD>::setPoints(std::move(data));
+    buildTree();
+}
+
+template <typename PT, std::size_t PD>
+void EuclideanMetric<PT, PD>::buildTree() {
     #ifdef USE_CUDA
         if (this->data.size() > MIN_NUM_POINTS_CUDA) {
             kdtree = nullptr;
@@ -35,11 +45,6 @@ EuclideanMetric<PT, PD>::EuclideanMetric(Mesh &mesh, double percentage_threshold
     #endif
 }
 
-template<typename PT, std::size_t PD>
-std::vector<Point<PT, PD>>& EuclideanMetric<PT, PD>::getPoints(){
-    return this->data;
-}
-
 // Calculating the Euclidean distance between two points
 template <typename PT, std::size_t PD>
 PT EuclideanMetric<PT, PD>::distanceTo(const Point<PT, PD> &a, const Point<PT, PD> &b) {
@@ -236,18 +241,20 @@ template <typename PT, std::size_t PD>
 void EuclideanMetric<PT, PD>::storeCentroids() {
     if (mesh == nullptr) return;
     
+    // The data points are the face baricenters, with the face as id (the kd-tree reorders them)
     const size_t numFaces = mesh->numFaces();
-    for (FaceId faceId = 0; faceId < numFaces; ++faceId)
+    if (this->data.size() != numFaces) return;
+    for (Point<PT, PD> &point : this->data)
     {
+        const FaceId faceId = point.id;
         int centroidIndex = mesh->getFaceCluster(faceId);
         // Check if the cluster is valid: greater or equal to 0 and less than the size of the centroids vector
         if (centroidIndex < 0 || static_cast<size_t>(centroidIndex) >= this->centroids->size()) {
             std::cerr << "Warning: Face " << faceId << " has not a valid cluster (" << centroidIndex << "). Skipping." << std::endl;
             continue;
         }
-        Point<PT, PD>& baricenter = mesh->getFace(faceId).baricenter;
         CentroidPoint<PT, PD>& c = (this->centroids)->at(centroidIndex);
-        baricenter.setCentroid(c);
+        point.setCentroid(c);
     }
 
 }
@@ -264,7 +271,9 @@ void EuclideanMetric<PT, PD>::updateFaceClusters() {
     for (FaceId faceId = 0; faceId < numFaces; ++faceId) {
         double minDistance = std::numeric_limits<double>::max();
         int closestCentroid = -1;
-        const Point<PT, PD>& faceCenter = mesh->getFace(faceId).baricenter;
+        const Span<const double> baricenter = mesh->getFaceBaricenter(faceId);
+        Point<PT, PD> faceCenter;
+        std::copy(baricenter.begin(), baricenter.end(), faceCenter.coordinates.begin());
         
         for (size_t i = 0; i < numCentroids; ++i) {
             double distance = this->distanceTo(faceCenter, (*this->centroids)[i]);
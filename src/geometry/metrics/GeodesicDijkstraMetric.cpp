@@ -7,7 +7,7 @@ GeodesicDijkstraMetric<PT, PD>::GeodesicDijkstraMetric(Mesh &mesh, double percen
     : mesh(&mesh)
 {
   this->threshold = percentage_threshold;
-  this->data = data;
+  this->data = std::move(data);
 }
 
 template <typename PT, std::size_t PD>
@@ -20,15 +20,13 @@ double GeodesicDijkstraMetric<PT, PD>::setupAvg(){
   #pragma omp parallel for reduction(+:result, totalPairs)
   for (FaceId faceId = 0; faceId < dimension; ++faceId) {
       FaceId currentId = faceId;
-      const auto& currFace = mesh->getFace(currentId);
-      const auto& currBaricenter = currFace.baricenter;
+      const PT *currBaricenter = mesh->getFaceBaricenter(currentId).data();
 
-      const std::vector<FaceId>& adjacentFaces = mesh->getFaceAdjacencyAt(currentId);
+      const Span<const FaceId> adjacentFaces = mesh->getFaceAdjacencyAt(currentId);
 
       for (size_t faceIdy = 0; faceIdy < adjacentFaces.size(); ++faceIdy) {
           if (currentId < adjacentFaces[faceIdy]) { 
-              const auto& adjFace = mesh->getFace(adjacentFaces[faceIdy]); 
-              const auto& adjBaricenter = adjFace.baricenter; 
+              const PT *adjBaricenter = mesh->getFaceBaricenter(adjacentFaces[faceIdy]).data();
 
               double distance = computeEuclideanDistance(currBaricenter, adjBaricenter);
               result += distance;
@@ -41,19 +39,19 @@ double GeodesicDijkstraMetric<PT, PD>::setupAvg(){
 }
 
 template <typename PT, std::size_t PD>
-double GeodesicDijkstraMetric<PT, PD>::dihedralAngle(const Face& f1, const Face& f2) const {
+double GeodesicDijkstraMetric<PT, PD>::dihedralAngle(const FaceId f1, const FaceId f2) const {
     // Compute the normal vectors of the two faces
-    Point<PT, PD> n1 = f1.normal;
-    Point<PT, PD> n2 = f2.normal;
+    const Span<const double> n1 = mesh->getFaceNormal(f1);
+    const Span<const double> n2 = mesh->getFaceNormal(f2);
 
     // Compute the dot product of the normal vectors
-    double dot_product = n1.coordinates[0] * n2.coordinates[0] + 
-                         n1.coordinates[1] * n2.coordinates[1] + 
-                         n1.coordinates[2] * n2.coordinates[2];
+    double dot_product = n1[0] * n2[0] + 
+                         n1[1] * n2[1] + 
+                         n1[2] * n2[2];
 
     // Compute the norms (magnitudes) of the normal vectors
-    double norm1 = n1.norm();
-    double norm2 = n2.norm();
+    double norm1 = std::sqrt(n1[0] * n1[0] + n1[1] * n1[1] + n1[2] * n1[2]);
+    double norm2 = std::sqrt(n2[0] * n2[0] + n2[1] * n2[1] + n2[2] * n2[2]);
 
     // Compute the cosine of the dihedral angle using the dot product formula
     double cos_theta = dot_product / (norm1 * norm2);
@@ -75,15 +73,157 @@ template <typename PT, std::size_t PD>
 void GeodesicDijkstraMetric<PT, PD>::setup()
 {
   this->avgDistances = setupAvg();
+  const size_t numCentroids = this->centroids->size();
+  std::vector<FaceId> seedFaces(numCentroids);
+
   #pragma omp parallel for
-  for (int centroidId = 0; centroidId < this->centroids->size(); ++centroidId)
+  for (int centroidId = 0; centroidId < numCentroids; ++centroidId)
   {
     const auto &centroid = this->centroids->at(centroidId);
     FaceId closestFaceId = findClosestFace(centroid);
     // set the coordinates of the centroid as the baricenter of the closest face
-    this->centroids->at(centroidId).coordinates = mesh->getFace(closestFaceId).baricenter.coordinates;
-    std::vector<PT> current_distances = computeDistances(closestFaceId);
-    this->distances[FaceId(centroidId)] = current_distances;
+    const Span<const double> baricenter = mesh->getFaceBaricenter(closestFaceId);
+    std::copy(baricenter.begin(), baricenter.end(), this->centroids->at(centroidId).coordinates.begin());
+    seedFaces[centroidId] = closestFaceId;
+  }
+
+  this->distances.assign(numCentroids, std::vector<PT>());
+  this->boundedClusters.clear();
+
+  if (numLandmarks > 0 && numCentroids > 1)
+  {
+    setupLandmarks();
+    setupWithLandmarks(seedFaces);
+    return;
+  }
+
+  this->distances = computeDistancesBatch(seedFaces);
+}
+
+template <typename PT, std::size_t PD>
+void GeodesicDijkstraMetric<PT, PD>::setupLandmarks()
+{
+  const size_t numFaces = mesh->numFaces();
+  const size_t wanted = std::min(numLandmarks, numFaces);
+  const auto &cached = mesh->getLandmarkDistances();
+  if (mesh->getLandmarkFaces().size() >= wanted && (cached.empty() || cached.front().size() == numFaces))
+    return;
+
+  std::vector<FaceId> landmarkFaces;
+  std::vector<std::vector<double>> landmarkDistances;
+  std::vector<PT> minDistances(numFaces, std::numeric_limits<PT>::max());
+
+  // Farthest-point sampling: each landmark is the face farthest from the previous ones
+  FaceId next = 0;
+  while (landmarkFaces.size() < wanted)
+  {
+    std::vector<PT> field = computeDistancesWithin(next, std::numeric_limits<PT>::max());
+
+    #pragma omp parallel for
+    for (FaceId faceId = 0; faceId < numFaces; ++faceId)
+    {
+      minDistances[faceId] = std::min(minDistances[faceId], field[faceId]);
+    }
+
+    landmarkFaces.push_back(next);
+    landmarkDistances.emplace_back(field.begin(), field.end());
+
+    next = std::max_element(minDistances.begin(), minDistances.end()) - minDistances.begin();
+    if (minDistances[next] == 0)
+      break; // Every face is already a landmark
+  }
+
+  mesh->setLandmarks(std::move(landmarkFaces), std::move(landmarkDistances));
+}
+
+template <typename PT, std::size_t PD>
+void GeodesicDijkstraMetric<PT, PD>::setupWithLandmarks(const std::vector<FaceId> &seedFaces)
+{
+  const size_t numFaces = mesh->numFaces();
+  const size_t numCentroids = seedFaces.size();
+  const auto &landmarkDistances = mesh->getLandmarkDistances();
+  const size_t numCachedLandmarks = landmarkDistances.size();
+
+  // Distances between every seed and every landmark, read from the cached fields
+  std::vector<std::vector<PT>> seedToLandmark(numCentroids, std::vector<PT>(numCachedLandmarks));
+  for (size_t c = 0; c < numCentroids; ++c)
+  {
+    for (size_t l = 0; l < numCachedLandmarks; ++l)
+    {
+      seedToLandmark[c][l] = landmarkDistances[l][seedFaces[c]];
+    }
+  }
+
+  this->boundedClusters.assign(numFaces, -1);
+  std::vector<PT> radius(numCentroids, PT(-1));
+
+  #pragma omp parallel
+  {
+    std::vector<PT> localRadius(numCentroids, PT(-1));
+    std::vector<PT> lowerBounds(numCentroids);
+
+    #pragma omp for nowait
+    for (FaceId faceId = 0; faceId < numFaces; ++faceId)
+    {
+      PT bestUpper = std::numeric_limits<PT>::infinity();
+      for (size_t c = 0; c < numCentroids; ++c)
+      {
+        PT lower = 0, upper = std::numeric_limits<PT>::infinity();
+        for (size_t l = 0; l < numCachedLandmarks; ++l)
+        {
+          const PT seedDist = seedToLandmark[c][l];
+          const PT faceDist = landmarkDistances[l][faceId];
+          lower = std::max(lower, std::abs(seedDist - faceDist));
+          upper = std::min(upper, seedDist + faceDist);
+        }
+        lowerBounds[c] = lower;
+        bestUpper = std::min(bestUpper, upper);
+      }
+
+      // A seed can win the face only if its lower bound does not exceed the best upper bound
+      const PT cutoff = bestUpper * (1 + 1e-9);
+      int numCandidates = 0, candidate = -1;
+      for (size_t c = 0; c < numCentroids; ++c)
+      {
+        if (lowerBounds[c] <= cutoff)
+        {
+          numCandidates++;
+          candidate = c;
+        }
+      }
+
+      if (numCandidates == 1)
+      {
+        this->boundedClusters[faceId] = candidate;
+        continue;
+      }
+
+      for (size_t c = 0; c < numCentroids; ++c)
+      {
+        if (lowerBounds[c] <= cutoff)
+        {
+          localRadius[c] = std::max(localRadius[c], cutoff);
+        }
+      }
+    }
+
+    #pragma omp critical
+    {
+      for (size_t c = 0; c < numCentroids; ++c)
+      {
+        radius[c] = std::max(radius[c], localRadius[c]);
+      }
+    }
+  }
+
+  // Only the seeds that are still candidates somewhere are expanded, up to the farthest such face
+  #pragma omp parallel for schedule(dynamic)
+  for (int c = 0; c < numCentroids; ++c)
+  {
+    if (radius[c] >= 0)
+    {
+      this->distances[c] = computeDistancesWithin(seedFaces[c], radius[c]);
+    }
   }
 }
 
@@ -101,10 +241,7 @@ FaceId GeodesicDijkstraMetric<PT, PD>::findClosestFace(const Point<PT, PD> &cent
         #pragma omp for nowait
         for (FaceId faceId = 0; faceId < mesh->numFaces(); ++faceId)
         {
-            const auto &face = mesh->getFace(faceId);
-            const auto &baricenter = face.baricenter;
-
-            double distance = computeEuclideanDistance(centroid, baricenter);
+            double distance = computeEuclideanDistance(centroid.coordinates.data(), mesh->getFaceBaricenter(faceId).data());
 
             if (distance < localMinDistance)
             {
@@ -157,13 +294,25 @@ void GeodesicDijkstraMetric<PT, PD>::fit_cpu()
       double minDistance = std::numeric_limits<double>::max();
       int closestCentroid = -1;
 
-      for (size_t centroidIndex = 0; centroidIndex < numCentroids; ++centroidIndex)
+      if (!this->boundedClusters.empty() && this->boundedClusters[faceId] >= 0)
       {
-        double distance = this->distances[FaceId(centroidIndex)][faceId];
-        if (distance < minDistance)
+        // The landmark bounds already proved which seed is the closest
+        closestCentroid = this->boundedClusters[faceId];
+      }
+      else
+      {
+        for (size_t centroidIndex = 0; centroidIndex < numCentroids; ++centroidIndex)
         {
-          minDistance = distance;
-          closestCentroid = centroidIndex;
+          // Seeds without a distance field cannot be the closest to this face
+          if (this->distances[centroidIndex].empty())
+            continue;
+
+          double distance = this->distances[centroidIndex][faceId];
+          if (distance < minDistance)
+          {
+            minDistance = distance;
+            closestCentroid = centroidIndex;
+          }
         }
       }
 
@@ -189,11 +338,11 @@ void GeodesicDijkstraMetric<PT, PD>::fit_cpu()
         for (FaceId faceId = 0; faceId < numFaces; ++faceId)
         {
             int centroidIndex = mesh->getFaceCluster(faceId);
-            const auto &baricenter = mesh->getFace(faceId).baricenter;
+            const Span<const double> baricenter = mesh->getFaceBaricenter(faceId);
 
             for (size_t dim = 0; dim < PD; ++dim)
             {
-                localCentroids[centroidIndex].coordinates[dim] += baricenter.coordinates[dim];
+                localCentroids[centroidIndex].coordinates[dim] += baricenter[dim];
             }
             localCounts[centroidIndex]++;
         }
@@ -255,11 +404,17 @@ bool GeodesicDijkstraMetric<PT, PD>::checkConvergence(int iter) {
 
 template <typename PT, std::size_t PD>
 double GeodesicDijkstraMetric<PT, PD>::computeEuclideanDistance(const Point<PT, PD> &a, const Point<PT, PD> &b) const
+{
+  return computeEuclideanDistance(a.coordinates.data(), b.coordinates.data());
+}
+
+template <typename PT, std::size_t PD>
+double GeodesicDijkstraMetric<PT, PD>::computeEuclideanDistance(const PT *a, const PT *b) const
 {
   double sum = 0.0;
   for (std::size_t i = 0; i < PD; ++i)
   {
-    sum += std::pow(a.coordinates[i] - b.coordinates[i], 2);
+    sum += std::pow(a[i] - b[i], 2);
   }
   return std::sqrt(sum);
 }
@@ -267,19 +422,32 @@ double GeodesicDijkstraMetric<PT, PD>::computeEuclideanDistance(const Point<PT,
 template <typename PT, std::size_t PD>
 std::vector<PT> GeodesicDijkstraMetric<PT, PD>::computeDistances(const FaceId startFace) const
 {
+  return computeDistancesWithin(startFace, std::numeric_limits<PT>::max());
+}
 
-  // Initialize Dijkstra's algorithm
-  std::vector<PT> curr_distances(mesh->numFaces()); // Minimum distance from startFace
-  std::unordered_map<FaceId, bool> visited;         // Keep track of visited faces
-  std::priority_queue<std::pair<PT, FaceId>, std::vector<std::pair<PT, FaceId>>, std::greater<>> pq;
+template <typename PT, std::size_t PD>
+std::vector<std::vector<PT>> GeodesicDijkstraMetric<PT, PD>::computeDistancesBatch(const std::vector<FaceId> &startFaces) const
+{
+  std::vector<std::vector<PT>> batch(startFaces.size());
 
-  // Initialize curr_distances and visited flags
-  for (int i = 0; i < mesh->numFaces(); ++i)
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < startFaces.size(); ++i)
   {
-    curr_distances[i] = std::numeric_limits<PT>::max();
-    visited[i] = false;
+    batch[i] = computeDistances(startFaces[i]);
   }
 
+  return batch;
+}
+
+template <typename PT, std::size_t PD>
+std::vector<PT> GeodesicDijkstraMetric<PT, PD>::computeDistancesWithin(const FaceId startFace, const PT radius) const
+{
+
+  // Initialize Dijkstra's algorithm
+  std::vector<PT> curr_distances(mesh->numFaces(), std::numeric_limits<PT>::max()); // Minimum distance from startFace
+  std::vector<char> visited(mesh->numFaces(), false);                               // Keep track of visited faces
+  std::priority_queue<std::pair<PT, FaceId>, std::vector<std::pair<PT, FaceId>>, std::greater<>> pq;
+
   curr_distances[startFace] = 0;
   pq.push({0, startFace});
 
@@ -289,6 +457,10 @@ std::vector<PT> GeodesicDijkstraMetric<PT, PD>::computeDistances(const FaceId st
     auto [currentDistance, currentFace] = pq.top();
     pq.pop();
 
+    // Every face left in the queue is farther than the radius
+    if (currentDistance > radius)
+      break;
+
     // Check if the face has already been visited
     if (visited[currentFace])
       continue;
@@ -297,12 +469,10 @@ std::vector<PT> GeodesicDijkstraMetric<PT, PD>::computeDistances(const FaceId st
     // Iterate over the neighbors of the current face
     for (const auto &neighbor : mesh->getFaceAdjacencyAt(currentFace))
     {
-      const auto &neighborFace = mesh->getFace(neighbor);
-
       // Compute distance between baricenters
-      const auto &currentBaricenter = mesh->getFace(currentFace).baricenter;
-      const auto &neighborBaricenter = neighborFace.baricenter;
-      PT weight = computeEuclideanDistance(currentBaricenter, neighborBaricenter) + dihedralAngle(mesh->getFace(currentFace), neighborFace);
+      const PT *currentBaricenter = mesh->getFaceBaricenter(currentFace).data();
+      const PT *neighborBaricenter = mesh->getFaceBaricenter(neighbor).data();
+      PT weight = computeEuclideanDistance(currentBaricenter, neighborBaricenter) + dihedralAngle(currentFace, neighbor);
 
       // Update the distance if a shorter path is found
       if (curr_distances[currentFace] + weight < curr_distances[neighbor])
@@ -341,7 +511,7 @@ void GeodesicDijkstraMetric<PT, PD>::fit_gpu()
     for (int d = 0; d < dim; d++)
     {
       h_faceBaricenter[f * dim + d] = static_cast<float>(
-          mesh->getFace(f).baricenter.coordinates[d]);
+          mesh->getFaceBaricenter(f)[d]);
     }
   }
 
@@ -408,24 +578,25 @@ void GeodesicDijkstraMetric<PT, PD>::fit_gpu()
 
 template <typename PT, std::size_t PD>
 void GeodesicDijkstraMetric<PT, PD>::storeCentroids(){
+  // The data points are the face baricenters, in face order
+  if (this->data.size() != mesh->numFaces())
+  {
+    this->data = mesh->getMeshFacesPoints();
+  }
   const size_t numFaces = mesh->numFaces();
   for (FaceId faceId = 0; faceId < numFaces; ++faceId)
   {
     int centroidIndex = mesh->getFaceCluster(faceId);
-    Point<PT, PD>& baricenter = mesh->getFace(faceId).baricenter;
     CentroidPoint<PT, PD>& c = (this->centroids)->at(centroidIndex);
-    baricenter.setCentroid(c);
+    this->data[faceId].setCentroid(c);
   }
 }
 
 template <typename PT, std::size_t PD>
 std::vector<Point<PT, PD>>& GeodesicDijkstraMetric<PT, PD>::getPoints(){
-  (this->data).clear();
-  const size_t numFaces = mesh->numFaces();
-  for (FaceId faceId = 0; faceId < numFaces; ++faceId)
+  if (this->data.size() != mesh->numFaces())
   {
-    Point<PT, PD>& baricenter = mesh->getFace(faceId).baricenter;
-    this->data.push_back(baricenter);
+    this->data = mesh->getMeshFacesPoints();
   }
   return this->data;
 }
@@ -2,9 +2,13 @@
 
 template <typename PT, std::size_t PD>
 GeodesicHeatMetric<PT, PD>::GeodesicHeatMetric(Mesh &mesh, double percentage_threshold, std::vector<Point<PT, PD>> data)
-    : GeodesicDijkstraMetric<PT, PD>(mesh, percentage_threshold, data)
+    : GeodesicDijkstraMetric<PT, PD>(mesh, percentage_threshold, std::move(data))
 {
-    const std::vector<Point<double, 3>> vertices = mesh.getVertices();
+    // Heat distances are approximate and do not satisfy the triangle inequality,
+    // so the landmark bounds of the Dijkstra metric cannot be used here
+    this->numLandmarks = 0;
+
+    const std::vector<Point<double, 3>> &vertices = mesh.getVertices();
     Eigen::MatrixXd V(vertices.size(), 3);
     #pragma omp parallel for
     for (int i = 0; i < vertices.size(); i++)
@@ -15,100 +19,362 @@ GeodesicHeatMetric<PT, PD>::GeodesicHeatMetric(Mesh &mesh, double percentage_thr
         }
     }
 
+    const Span<const VertId> triangles = mesh.getTriangles();
     Eigen::MatrixXi F(mesh.numFaces(), 3);
     #pragma omp parallel for
     for (FaceId faceId = 0; faceId < mesh.numFaces(); ++faceId)
     {
-        const auto &face = mesh.getFace(faceId);
         for (int i = 0; i < 3; i++)
         {
-            F(faceId, i) = face.vertices[i];
+            F(faceId, i) = triangles[3 * faceId + i];
         }
     }
     
-    Eigen::SparseMatrix<PT> L, M;
-    VectorXS dblA;
+    assert(F.cols() == 3 && "Only triangles are supported");
+    const PT h = igl::avg_edge_length(V, F);
+    const PT t = h * h;
+
+    // Content hash of the mesh and of the time step, used as key of both caches
+    std::uint64_t key = fnv1a(V.data(), V.size() * sizeof(double));
+    key = fnv1a(F.data(), F.size() * sizeof(int), key);
+    key = fnv1a(&t, sizeof(t), key);
 
-    #pragma omp parallel
+    // The solvers kept in memory also depend on the backend
+    HeatSolverType type;
     {
-        #pragma omp single nowait
-        igl::cotmatrix(V, F, L);
+        std::lock_guard<std::mutex> lock(memoMutex);
+        type = HeatSolver<PT>::resolve(solverType, V.rows());
+    }
+    const std::uint64_t solverKey = fnv1a(&type, sizeof(type), key);
 
-        #pragma omp single nowait
-        igl::massmatrix(V, F, igl::MASSMATRIX_TYPE_DEFAULT, M);
+    {
+        std::lock_guard<std::mutex> lock(memoMutex);
+        for (auto it = memo.begin(); it != memo.end(); ++it)
+        {
+            if (it->first == solverKey)
+            {
+                solver = it->second;
+                memo.splice(memo.begin(), memo, it);
+                return;
+            }
+        }
+    }
+
+    HeatOperators<PT> ops;
+    if (!loadOperators(key, ops))
+    {
+        #pragma omp parallel
+        {
+            #pragma omp single nowait
+            igl::cotmatrix(V, F, ops.L);
 
-        #pragma omp single nowait
-        igl::doublearea(V, F, dblA);
+            #pragma omp single nowait
+            igl::massmatrix(V, F, igl::MASSMATRIX_TYPE_DEFAULT, ops.M);
 
-        #pragma omp single nowait
-        igl::grad(V, F, data_heat.Grad);
+            #pragma omp single nowait
+            igl::doublearea(V, F, ops.dblA);
+
+            #pragma omp single nowait
+            igl::grad(V, F, ops.Grad);
+        }
+
+        Eigen::MatrixXi O;
+        igl::boundary_facets(F, O);
+        igl::unique(O, ops.b);
+
+        saveOperators(key, ops);
     }
 
-    const PT h = igl::avg_edge_length(V, F);
-    const PT t = h * h;
+    solver = HeatSolver<PT>::create(type, std::move(ops), t, mesh.numFaces());
 
-    assert(F.cols() == 3 && "Only triangles are supported");
-    data_heat.ng = data_heat.Grad.rows() / F.rows();
-    assert(data_heat.ng == 3 || data_heat.ng == 2);
-    data_heat.Div = -0.25 * data_heat.Grad.transpose() * dblA.colwise().replicate(data_heat.ng).asDiagonal();
-
-    Eigen::SparseMatrix<PT> Q = M - t * L;
-    Eigen::MatrixXi O;
-    igl::boundary_facets(F, O);
-    igl::unique(O, data_heat.b);
-    
-    Eigen::SparseMatrix<PT> _;
-    bool success1 = false, success2 = false, success3 = false;
-    #pragma omp parallel sections
+    std::lock_guard<std::mutex> lock(memoMutex);
+    memo.emplace_front(solverKey, solver);
+    if (memo.size() > HEAT_MEMO_SIZE)
+    {
+        memo.pop_back();
+    }
+}
+
+namespace
+{
+    const std::uint32_t HEAT_CACHE_MAGIC = 0x54414548; // "HEAT"
+
+    template <typename Scalar>
+    void writeSparse(std::ofstream &out, Eigen::SparseMatrix<Scalar> matrix)
     {
-        #pragma omp section
+        matrix.makeCompressed();
+        writeValue<std::int64_t>(out, matrix.rows());
+        writeValue<std::int64_t>(out, matrix.cols());
+        writeValue<std::int64_t>(out, matrix.nonZeros());
+        writeValues(out, matrix.outerIndexPtr(), matrix.outerSize() + 1);
+        writeValues(out, matrix.innerIndexPtr(), matrix.nonZeros());
+        writeValues(out, matrix.valuePtr(), matrix.nonZeros());
+    }
+
+    template <typename Vector>
+    void writeVector(std::ofstream &out, const Vector &vector)
+    {
+        writeValue<std::int64_t>(out, vector.size());
+        writeValues(out, vector.data(), vector.size());
+    }
+
+    template <typename Scalar>
+    void readSparse(BinaryReader &reader, Eigen::SparseMatrix<Scalar> &matrix)
+    {
+        const std::int64_t rows = reader.readValue<std::int64_t>();
+        const std::int64_t cols = reader.readValue<std::int64_t>();
+        const std::int64_t nnz = reader.readValue<std::int64_t>();
+        if (rows < 0 || cols < 0 || nnz < 0)
         {
-            success1 = igl::min_quad_with_fixed_precompute(Q, Eigen::VectorXi(), _, true, data_heat.Neumann);
+            throw std::runtime_error("Corrupted heat cache file");
         }
-        
-        #pragma omp section
+        matrix.resize(rows, cols);
+        matrix.resizeNonZeros(nnz);
+        reader.readValues(matrix.outerIndexPtr(), cols + 1);
+        reader.readValues(matrix.innerIndexPtr(), nnz);
+        reader.readValues(matrix.valuePtr(), nnz);
+    }
+
+    template <typename Vector>
+    void readVector(BinaryReader &reader, Vector &vector)
+    {
+        const std::int64_t size = reader.readValue<std::int64_t>();
+        if (size < 0)
         {
-            success2 = true;
-            if (data_heat.b.size() > 0)
-            {
-                success2 = igl::min_quad_with_fixed_precompute(Q, data_heat.b, _, true, data_heat.Dirichlet);
-            }
+            throw std::runtime_error("Corrupted heat cache file");
         }
+        vector.resize(size);
+        reader.readValues(vector.data(), size);
+    }
+}
+
+template <typename PT, std::size_t PD>
+std::string GeodesicHeatMetric<PT, PD>::cacheDirectory = defaultCacheDirectory("kmeans_heat_cache");
+
+template <typename PT, std::size_t PD>
+std::uintmax_t GeodesicHeatMetric<PT, PD>::cacheSizeLimit = HEAT_CACHE_MAX_BYTES;
+
+template <typename PT, std::size_t PD>
+HeatSolverType GeodesicHeatMetric<PT, PD>::solverType = HeatSolverType::AUTO;
+
+template <typename PT, std::size_t PD>
+std::mutex GeodesicHeatMetric<PT, PD>::memoMutex;
+
+template <typename PT, std::size_t PD>
+std::list<std::pair<std::uint64_t, std::shared_ptr<const HeatSolver<PT>>>> GeodesicHeatMetric<PT, PD>::memo;
+
+template <typename PT, std::size_t PD>
+void GeodesicHeatMetric<PT, PD>::setCacheDirectory(const std::string &directory)
+{
+    std::lock_guard<std::mutex> lock(memoMutex);
+    cacheDirectory = directory;
+}
+
+template <typename PT, std::size_t PD>
+void GeodesicHeatMetric<PT, PD>::setCacheSizeLimit(std::uintmax_t bytes)
+{
+    std::lock_guard<std::mutex> lock(memoMutex);
+    cacheSizeLimit = bytes;
+}
+
+template <typename PT, std::size_t PD>
+void GeodesicHeatMetric<PT, PD>::setSolverType(HeatSolverType type)
+{
+    std::lock_guard<std::mutex> lock(memoMutex);
+    solverType = type;
+}
+
+template <typename PT, std::size_t PD>
+void GeodesicHeatMetric<PT, PD>::clearMemoryCache()
+{
+    std::lock_guard<std::mutex> lock(memoMutex);
+    memo.clear();
+}
+
+template <typename PT, std::size_t PD>
+std::string GeodesicHeatMetric<PT, PD>::cacheFile(std::uint64_t key)
+{
+    std::lock_guard<std::mutex> lock(memoMutex);
+    if (cacheDirectory.empty())
+    {
+        return std::string();
+    }
+    return (std::filesystem::path(cacheDirectory) / (hashToString(key) + ".heat")).string();
+}
 
-        #pragma omp section
+template <typename PT, std::size_t PD>
+bool GeodesicHeatMetric<PT, PD>::loadOperators(std::uint64_t key, HeatOperators<PT> &ops)
+{
+    const std::string path = cacheFile(key);
+    std::error_code ec;
+    if (path.empty() || !std::filesystem::is_regular_file(path, ec))
+    {
+        return false;
+    }
+
+    try
+    {
+        MappedFile file(path);
+        BinaryReader reader(file.data(), verifyChecksum(file.data(), file.size()));
+        if (reader.readValue<std::uint32_t>() != HEAT_CACHE_MAGIC ||
+            reader.readValue<std::uint32_t>() != HEAT_CACHE_VERSION ||
+            reader.readValue<std::uint32_t>() != sizeof(PT) ||
+            reader.readValue<std::uint64_t>() != key)
         {
-            const Eigen::Matrix<PT, 1, Eigen::Dynamic> M_diag_tr = M.diagonal().transpose();
-            const Eigen::SparseMatrix<PT> Aeq = M_diag_tr.sparseView();
-            L *= -0.5;
-            success3 = igl::min_quad_with_fixed_precompute(L, Eigen::VectorXi(), Aeq, true, data_heat.Poisson);
+            return false;
         }
+        readSparse(reader, ops.L);
+        readSparse(reader, ops.M);
+        readSparse(reader, ops.Grad);
+        readVector(reader, ops.dblA);
+        readVector(reader, ops.b);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Ignoring heat cache file " << path << ": " << e.what() << std::endl;
+        return false;
     }
 
-    if (!success1 || !success2 || !success3)
+    touchCacheFile(path);
+    return true;
+}
+
+template <typename PT, std::size_t PD>
+void GeodesicHeatMetric<PT, PD>::saveOperators(std::uint64_t key, const HeatOperators<PT> &ops)
+{
+    const std::string path = cacheFile(key);
+    if (path.empty())
+    {
+        return;
+    }
+
+    const bool written = writeFileAtomically(path, [&](std::ofstream &out)
+    {
+        writeValue<std::uint32_t>(out, HEAT_CACHE_MAGIC);
+        writeValue<std::uint32_t>(out, HEAT_CACHE_VERSION);
+        writeValue<std::uint32_t>(out, sizeof(PT));
+        writeValue<std::uint64_t>(out, key);
+        writeSparse(out, ops.L);
+        writeSparse(out, ops.M);
+        writeSparse(out, ops.Grad);
+        writeVector(out, ops.dblA);
+        writeVector(out, ops.b);
+    });
+
+    // Least recently used eviction, the new file is kept
+    if (written)
     {
-        throw std::runtime_error("Error in heat_geodesics_precompute");
+        std::uintmax_t limit;
+        {
+            std::lock_guard<std::mutex> lock(memoMutex);
+            limit = cacheSizeLimit;
+        }
+        pruneCacheDirectory(std::filesystem::path(path).parent_path().string(), ".heat", limit, path);
     }
 }
 
 template <typename PT, std::size_t PD>
 std::vector<PT> GeodesicHeatMetric<PT, PD>::computeDistances(const FaceId startFace) const
 {
-    Eigen::VectorXi gamma(1); 
-    gamma << this->mesh->getFace(startFace).vertices[0];
-    Eigen::VectorXd dist;
-    igl::heat_geodesics_solve(data_heat, gamma, dist);
+    // A single source is not the solve of any centroid, it starts cold and leaves the warm start alone
+    HeatWarmStart<PT> cold;
+    return solveDistances({startFace}, cold)[0];
+}
 
-    std::vector<PT> distFaces(this->mesh->numFaces());
+template <typename PT, std::size_t PD>
+std::vector<std::vector<PT>> GeodesicHeatMetric<PT, PD>::computeDistancesBatch(const std::vector<FaceId> &startFaces) const
+{
+    if (this->centroids != nullptr && startFaces.size() == this->centroids->size())
+    {
+        return solveDistances(startFaces, warmStart);
+    }
+    HeatWarmStart<PT> cold;
+    return solveDistances(startFaces, cold);
+}
+
+template <typename PT, std::size_t PD>
+std::vector<std::vector<PT>> GeodesicHeatMetric<PT, PD>::solveDistances(const std::vector<FaceId> &startFaces, HeatWarmStart<PT> &warm) const
+{
+    typedef Eigen::Matrix<PT, Eigen::Dynamic, Eigen::Dynamic> MatrixXS;
+
+    const Eigen::SparseMatrix<PT> &Grad = solver->gradient();
+    const int ng = solver->gradientDimension();
+    const int numVertices = Grad.cols();
+    const int numSources = startFaces.size();
+    const int numFaces = this->mesh->numFaces();
+
+    // One column of heat sources per starting face
+    MatrixXS u0 = MatrixXS::Zero(numVertices, numSources);
+    for (int s = 0; s < numSources; ++s)
+    {
+        for (VertId v : this->mesh->getFaceVertices(startFaces[s]))
+        {
+            u0(v, s) = 1;
+        }
+    }
+
+    // Heat diffusion, averaging Neumann and Dirichlet solutions on meshes with boundary
+    const MatrixXS u = solver->diffuse(u0, warm);
+
+    // Normalized gradient of every heat column
+    MatrixXS grad_u = Grad * u;
+    const int m = Grad.rows() / ng;
+    #pragma omp parallel for collapse(2)
+    for (int s = 0; s < numSources; ++s)
+    {
+        for (int i = 0; i < m; ++i)
+        {
+            // Stable norm: the gradient can be tiny far from the sources
+            PT ma = 0;
+            for (int d = 0; d < ng; ++d)
+            {
+                ma = std::max(ma, std::fabs(grad_u(d * m + i, s)));
+            }
+            PT norm = 0;
+            for (int d = 0; d < ng; ++d)
+            {
+                const PT gui = grad_u(d * m + i, s) / ma;
+                norm += gui * gui;
+            }
+            norm = ma * std::sqrt(norm);
+
+            for (int d = 0; d < ng; ++d)
+            {
+                grad_u(d * m + i, s) = (ma == 0 || norm == 0 || norm != norm) ? 0 : grad_u(d * m + i, s) / norm;
+            }
+        }
+    }
+
+    // Poisson solve recovering the distances from the divergence of the normalized gradients
+    const MatrixXS div_X = -solver->divergence() * grad_u;
+    MatrixXS dist = solver->poisson(div_X, warm);
+
+    std::vector<std::vector<PT>> distFaces(numSources, std::vector<PT>(numFaces));
     #pragma omp parallel for
-    for (FaceId faceId = 0; faceId < this->mesh->numFaces(); ++faceId)
+    for (int s = 0; s < numSources; ++s)
     {
-        const auto &face = this->mesh->getFace(faceId);
+        // Shift the distances to be zero at the sources, and make them positive
+        const Span<const VertId> sources = this->mesh->getFaceVertices(startFaces[s]);
+        PT shift = 0;
+        for (VertId v : sources)
+        {
+            shift += dist(v, s);
+        }
+        dist.col(s).array() -= shift / sources.size();
+        if (dist.col(s).mean() < 0)
+        {
+            dist.col(s) = -dist.col(s);
+        }
 
-        for (int i = 0; i < 3; i++)
+        for (FaceId faceId = 0; faceId < numFaces; ++faceId)
         {
-            distFaces[faceId] += dist[face.vertices[i]];
+            const Span<const VertId> vertices = this->mesh->getFaceVertices(faceId);
+            for (int i = 0; i < 3; i++)
+            {
+                distFaces[s][faceId] += dist(vertices[i], s);
+            }
+            distFaces[s][faceId] /= 3;
         }
-        distFaces[faceId] /= 3;
     }
 
     return distFaces;
@@ -0,0 +1,231 @@
+#include "geometry/metrics/HeatSolver.hpp"
+
+template <typename PT>
+HeatSolver<PT>::HeatSolver(HeatOperators<PT> &ops, int numFaces)
+{
+    Grad = std::move(ops.Grad);
+    ng = Grad.rows() / numFaces;
+    assert(ng == 3 || ng == 2);
+    Div = -0.25 * Grad.transpose() * ops.dblA.colwise().replicate(ng).asDiagonal();
+}
+
+template <typename PT>
+HeatSolverType HeatSolver<PT>::resolve(HeatSolverType type, int numVertices)
+{
+    if (type != HeatSolverType::AUTO)
+    {
+        return type;
+    }
+    return numVertices >= HEAT_ITERATIVE_MIN_VERTICES ? HeatSolverType::ITERATIVE : HeatSolverType::DIRECT;
+}
+
+template <typename PT>
+std::shared_ptr<const HeatSolver<PT>> HeatSolver<PT>::create(HeatSolverType type, HeatOperators<PT> ops, PT t, int numFaces)
+{
+    if (resolve(type, ops.L.rows()) == HeatSolverType::ITERATIVE)
+    {
+        return std::make_shared<IterativeHeatSolver<PT>>(std::move(ops), t, numFaces);
+    }
+    return std::make_shared<DirectHeatSolver<PT>>(std::move(ops), t, numFaces);
+}
+
+template <typename PT>
+DirectHeatSolver<PT>::DirectHeatSolver(HeatOperators<PT> ops, PT t, int numFaces)
+    : HeatSolver<PT>(ops, numFaces), b(std::move(ops.b))
+{
+    Eigen::SparseMatrix<PT> Q = ops.M - t * ops.L;
+    Eigen::SparseMatrix<PT> _;
+    bool success1 = false, success2 = false, success3 = false;
+    #pragma omp parallel sections
+    {
+        #pragma omp section
+        {
+            success1 = igl::min_quad_with_fixed_precompute(Q, Eigen::VectorXi(), _, true, Neumann);
+        }
+
+        #pragma omp section
+        {
+            success2 = true;
+            if (b.size() > 0)
+            {
+                success2 = igl::min_quad_with_fixed_precompute(Q, b, _, true, Dirichlet);
+            }
+        }
+
+        #pragma omp section
+        {
+            const Eigen::Matrix<PT, 1, Eigen::Dynamic> M_diag_tr = ops.M.diagonal().transpose();
+            const Eigen::SparseMatrix<PT> Aeq = M_diag_tr.sparseView();
+            ops.L *= -0.5;
+            success3 = igl::min_quad_with_fixed_precompute(ops.L, Eigen::VectorXi(), Aeq, true, Poisson);
+        }
+    }
+
+    if (!success1 || !success2 || !success3)
+    {
+        throw std::runtime_error("Error in heat_geodesics_precompute");
+    }
+}
+
+template <typename PT>
+typename DirectHeatSolver<PT>::MatrixXS DirectHeatSolver<PT>::diffuse(const MatrixXS &u0, HeatWarmStart<PT> &/* warm */) const
+{
+    MatrixXS u;
+    igl::min_quad_with_fixed_solve(Neumann, u0, MatrixXS(), MatrixXS(), u);
+    if (Dirichlet.n)
+    {
+        MatrixXS uD;
+        igl::min_quad_with_fixed_solve(Dirichlet, u0, MatrixXS::Zero(b.size(), u0.cols()).eval(), MatrixXS(), uD);
+        u += uD;
+        u *= 0.5;
+    }
+    return u;
+}
+
+template <typename PT>
+typename DirectHeatSolver<PT>::MatrixXS DirectHeatSolver<PT>::poisson(const MatrixXS &divergence, HeatWarmStart<PT> &/* warm */) const
+{
+    MatrixXS dist;
+    igl::min_quad_with_fixed_solve(Poisson, (-divergence).eval(), MatrixXS(), MatrixXS::Zero(1, divergence.cols()).eval(), dist);
+    return dist;
+}
+
+template <typename PT>
+IterativeHeatSolver<PT>::IterativeHeatSolver(HeatOperators<PT> ops, PT t, int numFaces)
+    : HeatSolver<PT>(ops, numFaces)
+{
+    const int numVertices = ops.L.rows();
+    Q = ops.M - t * ops.L;
+    Q.makeCompressed();
+
+    // Dirichlet problem: zero heat on the boundary, the unknowns are the interior vertices
+    std::vector<int> interiorIndex(numVertices, 0);
+    for (int i = 0; i < ops.b.size(); ++i)
+    {
+        interiorIndex[ops.b(i)] = -1;
+    }
+    for (int v = 0; v < numVertices; ++v)
+    {
+        if (interiorIndex[v] == 0)
+        {
+            interiorIndex[v] = interior.size();
+            interior.push_back(v);
+        }
+    }
+
+    // The Poisson matrix is only semi-definite (constants are in its kernel),
+    // a tiny multiple of the mass matrix makes it definite without moving the gradients
+    A = -0.5 * ops.L;
+    const PT scale = A.diagonal().sum() / ops.M.diagonal().sum();
+    A += (HEAT_POISSON_REGULARIZATION * scale) * ops.M;
+    A.makeCompressed();
+
+    bool success1 = false, success2 = true, success3 = false;
+    #pragma omp parallel sections
+    {
+        #pragma omp section
+        {
+            Neumann.setTolerance(HEAT_CG_DIFFUSION_TOLERANCE);
+            Neumann.compute(Q);
+            success1 = Neumann.info() == Eigen::Success;
+        }
+
+        #pragma omp section
+        {
+            if (ops.b.size() > 0 && !interior.empty())
+            {
+                std::vector<Eigen::Triplet<PT>> triplets;
+                triplets.reserve(Q.nonZeros());
+                for (int k = 0; k < Q.outerSize(); ++k)
+                {
+                    for (typename Eigen::SparseMatrix<PT>::InnerIterator it(Q, k); it; ++it)
+                    {
+                        if (interiorIndex[it.row()] >= 0 && interiorIndex[it.col()] >= 0)
+                        {
+                            triplets.emplace_back(interiorIndex[it.row()], interiorIndex[it.col()], it.value());
+                        }
+                    }
+                }
+                Qinterior.resize(interior.size(), interior.size());
+                Qinterior.setFromTriplets(triplets.begin(), triplets.end());
+
+                Dirichlet.setTolerance(HEAT_CG_DIFFUSION_TOLERANCE);
+                Dirichlet.compute(Qinterior);
+                success2 = Dirichlet.info() == Eigen::Success;
+            }
+        }
+
+        #pragma omp section
+        {
+            Poisson.setTolerance(HEAT_CG_POISSON_TOLERANCE);
+            Poisson.compute(A);
+            success3 = Poisson.info() == Eigen::Success;
+        }
+    }
+
+    if (!success1 || !success2 || !success3)
+    {
+        throw std::runtime_error("Error in the incomplete Cholesky preconditioner of the heat method");
+    }
+}
+
+template <typename PT>
+typename IterativeHeatSolver<PT>::MatrixXS IterativeHeatSolver<PT>::solve(const CGSolver &solver, const MatrixXS &B, const MatrixXS &guess)
+{
+    MatrixXS X;
+    if (guess.rows() == B.rows() && guess.cols() == B.cols())
+    {
+        X = solver.solveWithGuess(B, guess);
+    }
+    else
+    {
+        X = solver.solve(B);
+    }
+
+    if (solver.info() != Eigen::Success)
+    {
+        std::cerr << "Warning: heat method conjugate gradient stopped after " << solver.iterations()
+                  << " iterations with error " << solver.error() << std::endl;
+    }
+    return X;
+}
+
+template <typename PT>
+typename IterativeHeatSolver<PT>::MatrixXS IterativeHeatSolver<PT>::diffuse(const MatrixXS &u0, HeatWarmStart<PT> &warm) const
+{
+    // Same convention as min_quad_with_fixed, which minimizes 1/2 x'Qx + x'u0
+    MatrixXS u = solve(Neumann, -u0, warm.neumann);
+    warm.neumann = u;
+
+    if (Qinterior.rows() > 0)
+    {
+        MatrixXS rhs(interior.size(), u0.cols());
+        for (int i = 0; i < interior.size(); ++i)
+        {
+            rhs.row(i) = -u0.row(interior[i]);
+        }
+        warm.dirichlet = solve(Dirichlet, rhs, warm.dirichlet);
+
+        // Boundary vertices are zero in the Dirichlet solution
+        MatrixXS uD = MatrixXS::Zero(u.rows(), u.cols());
+        for (int i = 0; i < interior.size(); ++i)
+        {
+            uD.row(interior[i]) = warm.dirichlet.row(i);
+        }
+        u += uD;
+        u *= 0.5;
+    }
+    return u;
+}
+
+template <typename PT>
+typename IterativeHeatSolver<PT>::MatrixXS IterativeHeatSolver<PT>::poisson(const MatrixXS &divergence, HeatWarmStart<PT> &warm) const
+{
+    warm.poisson = solve(Poisson, divergence, warm.poisson);
+    return warm.poisson;
+}
+
+// Explicit template instantiations
+template class HeatSolver<double>;
+template class DirectHeatSolver<double>;
+template class IterativeHeatSolver<double>;
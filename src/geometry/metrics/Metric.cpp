@@ -7,11 +7,11 @@ template <typename PT, std::size_t PD>
 Metric<PT, PD>::Metric(std::vector<CentroidPoint<PT, PD>> &centroids) : centroids(&centroids) {}
 
 template <typename PT, std::size_t PD>
-Metric<PT, PD>::Metric(std::vector<CentroidPoint<PT, PD>> &centroids, std::vector<Point<PT, PD>> data) : centroids(&centroids), data(data) {}
+Metric<PT, PD>::Metric(std::vector<CentroidPoint<PT, PD>> &centroids, std::vector<Point<PT, PD>> data) : centroids(&centroids), data(std::move(data)) {}
 
 template <typename PT, std::size_t PD>
 void Metric<PT, PD>::setPoints(std::vector<Point<PT, PD>> data){
-    this->data = data;
+    this->data = std::move(data);
 }
 
 template <typename PT, std::size_t PD>
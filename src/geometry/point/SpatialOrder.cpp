@@ -0,0 +1,110 @@
+#include "geometry/point/SpatialOrder.hpp"
+#include "utils/RadixSort.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <omp.h>
+
+std::vector<std::uint64_t> SpatialOrder::mortonKeys(const double *coordinates, std::size_t count, std::size_t dimensions)
+{
+    std::vector<std::uint64_t> keys(count);
+    if (count == 0 || dimensions == 0)
+    {
+        return keys;
+    }
+
+    // Only the first MORTON_KEY_BITS dimensions fit in the key, with one bit each
+    const std::size_t keyDimensions = std::min<std::size_t>(dimensions, MORTON_KEY_BITS);
+    const int bits = MORTON_KEY_BITS / keyDimensions;
+
+    // Bounding box of the points
+    std::vector<double> lower(keyDimensions, std::numeric_limits<double>::max());
+    std::vector<double> upper(keyDimensions, std::numeric_limits<double>::lowest());
+    #pragma omp parallel
+    {
+        std::vector<double> localLower(lower), localUpper(upper);
+        #pragma omp for nowait
+        for (std::int64_t i = 0; i < count; ++i)
+        {
+            for (std::size_t d = 0; d < keyDimensions; ++d)
+            {
+                localLower[d] = std::min(localLower[d], coordinates[i * dimensions + d]);
+                localUpper[d] = std::max(localUpper[d], coordinates[i * dimensions + d]);
+            }
+        }
+        #pragma omp critical
+        for (std::size_t d = 0; d < keyDimensions; ++d)
+        {
+            lower[d] = std::min(lower[d], localLower[d]);
+            upper[d] = std::max(upper[d], localUpper[d]);
+        }
+    }
+
+    const std::uint64_t maxCell = (std::uint64_t(1) << bits) - 1;
+    std::vector<double> scale(keyDimensions);
+    for (std::size_t d = 0; d < keyDimensions; ++d)
+    {
+        scale[d] = upper[d] > lower[d] ? maxCell / (upper[d] - lower[d]) : 0.0;
+    }
+
+    #pragma omp parallel
+    {
+        std::vector<std::uint64_t> cell(keyDimensions);
+        #pragma omp for
+        for (std::int64_t i = 0; i < count; ++i)
+        {
+            for (std::size_t d = 0; d < keyDimensions; ++d)
+            {
+                const double position = (coordinates[i * dimensions + d] - lower[d]) * scale[d];
+                cell[d] = std::min(maxCell, static_cast<std::uint64_t>(std::max(position, 0.0)));
+            }
+
+            // Interleave the bits of the cell coordinates, from the most significant
+            std::uint64_t key = 0;
+            for (int b = bits - 1; b >= 0; --b)
+            {
+                for (std::size_t d = 0; d < keyDimensions; ++d)
+                {
+                    key = key << 1 | ((cell[d] >> b) & 1);
+                }
+            }
+            keys[i] = key;
+        }
+    }
+    return keys;
+}
+
+std::vector<std::uint32_t> SpatialOrder::mortonOrder(const double *coordinates, std::size_t count, std::size_t dimensions)
+{
+    std::vector<std::uint64_t> keys = mortonKeys(coordinates, count, dimensions);
+    std::vector<std::uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    radixSortPairs(keys, order);
+    return order;
+}
+
+template <typename PT, std::size_t PD>
+std::vector<std::uint32_t> SpatialOrder::reorderPoints(std::vector<Point<PT, PD>> &points)
+{
+    std::vector<double> coordinates(points.size() * PD);
+    #pragma omp parallel for
+    for (std::int64_t i = 0; i < points.size(); ++i)
+    {
+        std::copy(points[i].coordinates.begin(), points[i].coordinates.end(), coordinates.begin() + i * PD);
+    }
+
+    const std::vector<std::uint32_t> order = mortonOrder(coordinates.data(), points.size(), PD);
+    std::vector<Point<PT, PD>> sorted(points.size());
+    #pragma omp parallel for
+    for (std::int64_t i = 0; i < points.size(); ++i)
+    {
+        sorted[i] = std::move(points[order[i]]);
+    }
+    points = std::move(sorted);
+    return order;
+}
+
+// Explicit template instantiation
+template std::vector<std::uint32_t> SpatialOrder::reorderPoints<double, 2>(std::vector<Point<double, 2>> &);
+template std::vector<std::uint32_t> SpatialOrder::reorderPoints<double, 3>(std::vector<Point<double, 3>> &);
@@ -1,29 +1,103 @@
 #include <vector>
 
 #include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <cassert>
 
 #include "utils/CSVUtils.hpp"
+#include "utils/PointFile.hpp"
+#include "geometry/point/SpatialOrder.hpp"
 #include "clustering/KMeans.hpp"
+#include "clustering/StreamingKMeans.hpp"
+#include "clustering/CentroidInitializationMethods/KMeansPlusPlus.hpp"
+#include "clustering/CentroidInitializationMethods/SharedEnum.hpp"
 #include "geometry/metrics/EuclideanMetric.hpp"
 
 #define DIMENSION 2
 
 using namespace std;
 
+/**
+ * \brief Saves the label of every point, in the order of the input file, and the centroids as point files.
+ */
+template <typename PT, std::size_t PD>
+void exportClustering(const std::string &basePath, std::vector<Point<PT, PD>> &points, std::vector<CentroidPoint<PT, PD>> &centroids) {
+    // Every initializer numbers the centroids by their index, and both the CPU and the CUDA
+    // fits keep the id, whether the points refer to the centroids or to copies of them
+    std::vector<std::int32_t> labels(points.size(), -1);
+    #pragma omp parallel for
+    for (std::int64_t i = 0; i < points.size(); ++i) {
+        const Point<PT, PD> &p = points[i];
+        if (p.centroid != nullptr) {
+            const std::int64_t label = p.centroid->id;
+            assert(label >= 0 && label < static_cast<std::int64_t>(centroids.size()));
+            labels[p.id] = label;
+        }
+    }
+
+    std::vector<Point<PT, PD>> centroidPoints;
+    for (const auto &c : centroids) {
+        centroidPoints.emplace_back(c.coordinates);
+    }
+
+    PointFile::writeLabels(basePath + "_labels.kpts", labels);
+    PointFile::writePoints(basePath + "_centroids.kpts", centroidPoints);
+    std::cout << "Labels and centroids saved to " << basePath << "_labels.kpts and " << basePath << "_centroids.kpts\n";
+}
+
 void printUsage() {
-    std::cout << "Usage: ./k_means <csv_file> <num_clusters> <centroid_init_method> [k_init_method]\n";
-    std::cout << "  <csv_file>             - Name of csv file in /resources folder\n";
+    std::cout << "Usage: ./k_means <data_file> <num_clusters> <centroid_init_method> [k_init_method] [--reorder] [--convert] [--export] [--stream] [--seed <seed>]\n";
+    std::cout << "  <data_file>            - Name of csv or .kpts point file in /resources folder\n";
     std::cout << "  <num_clusters>         - Number of clusters (0 if unknown)\n";
     std::cout << "  <centroid_init_method> - Method of initialization of centroids:\n";
     std::cout << "                           0: Random\n";
     std::cout << "                           1: Kernel Density Estimator\n";
     std::cout << "                           2: Most Distant\n";
+    std::cout << "                           4: Mean Shift\n";
+    std::cout << "                           5: K-Means++\n";
     std::cout << "  [k_init_method]        - (Optional) Method for k initialization (0: elbow, 1: KDE, 2: Silhouette) if <num_clusters> is 0\n";
+    std::cout << "  [--reorder]            - (Optional) Sort the points along a space-filling curve before building the kd-tree\n";
+    std::cout << "  [--convert]            - (Optional) Also save the csv file as a .kpts point file next to it\n";
+    std::cout << "  [--export]             - (Optional) Save the labels and the centroids as <data_file>_labels.kpts and <data_file>_centroids.kpts\n";
+    std::cout << "  [--stream]             - (Optional) Run out of core, reading the file block by block, with centroids sampled from the data\n";
+    std::cout << "                           (0: random) or drawn by k-means++ on a sample (5: K-Means++), and save the labels and\n";
+    std::cout << "                           the centroids like --export (requires <num_clusters> > 0)\n";
+    std::cout << "  [--seed <seed>]        - (Optional) Seed of the k-means++ and --stream initializations (default " << KMEANS_PP_SEED << ")\n";
     std::cout << "\nExample: ./k_means data.csv 3 1\n";
 }
 
 int main(int argc, char* argv[]) {
     try {
+        // The flags can appear anywhere, the other arguments are positional
+        bool reorder = false;
+        bool convert = false;
+        bool exportResult = false;
+        bool stream = false;
+        std::uint64_t seed = KMEANS_PP_SEED;
+        int numArgs = 0;
+        for (int i = 0; i < argc; ++i) {
+            if (std::string(argv[i]) == "--reorder") {
+                reorder = true;
+            } else if (std::string(argv[i]) == "--convert") {
+                convert = true;
+            } else if (std::string(argv[i]) == "--export") {
+                exportResult = true;
+            } else if (std::string(argv[i]) == "--stream") {
+                stream = true;
+            } else if (std::string(argv[i]) == "--seed") {
+                if (i + 1 == argc) {
+                    std::cerr << "Error: --seed requires a value!\n";
+                    printUsage();
+                    return 1;
+                }
+                seed = std::stoull(argv[++i]);
+            } else {
+                argv[numArgs++] = argv[i];
+            }
+        }
+        argc = numArgs;
+
         if (argc < 4) {
             std::cerr << "Error: Not enough arguments!\n";
             printUsage();
@@ -46,21 +120,88 @@ int main(int argc, char* argv[]) {
             kinitMethod = std::stoi(argv[4]);
         }
 
+        // Point files are mapped and copied without parsing
+        const std::filesystem::path data_path(full_path);
+        const bool point_file = data_path.extension() == ".kpts";
+        const std::string base_path = (data_path.parent_path() / data_path.stem()).string();
+
+        // The out-of-core mode never loads the whole dataset
+        if (stream) {
+            if (num_clusters == 0) {
+                std::cerr << "Error: --stream requires the number of clusters!\n";
+                printUsage();
+                return 1;
+            }
+            if (num_initialization_method != static_cast<int>(Enums::CentroidInit::RANDOM) &&
+                num_initialization_method != static_cast<int>(Enums::CentroidInit::KMEANSPP)) {
+                std::cerr << "Error: --stream only supports the random (0) and k-means++ (5) initializations!\n";
+                printUsage();
+                return 1;
+            }
+            auto source = PointBlockSource<double, DIMENSION>::open(full_path);
+            StreamingKMeans<double, DIMENSION> kmeans(num_clusters, 1e-4, source.get());
+
+            // k-means++ runs on a uniform sample of the dataset
+            if (num_initialization_method == static_cast<int>(Enums::CentroidInit::KMEANSPP)) {
+                const std::vector<Point<double, DIMENSION>> sample = kmeans.samplePoints(STREAMING_SAMPLE_SIZE, static_cast<unsigned int>(seed));
+                if (sample.size() < static_cast<std::size_t>(num_clusters)) {
+                    throw std::runtime_error("The dataset has fewer points than clusters");
+                }
+                std::vector<CentroidPoint<double, DIMENSION>> initial;
+                KMeansPlusPlus<DIMENSION>(sample, num_clusters, seed).findCentroid(initial);
+                kmeans.setCentroids(initial);
+            }
+            kmeans.fit(static_cast<unsigned int>(seed));
+            kmeans.writeLabels(base_path + "_labels.kpts");
+
+            std::vector<Point<double, DIMENSION>> centroids;
+            for (const auto &c : kmeans.getCentroids()) {
+                centroids.emplace_back(c.coordinates);
+                c.print();
+                std::cout << "\n";
+            }
+            PointFile::writePoints(base_path + "_centroids.kpts", centroids);
+            std::cout << kmeans.getNumPoints() << " points clustered in " << kmeans.getIterations()
+                      << " iterations, inertia " << kmeans.getInertia() << "\n";
+            std::cout << "Labels and centroids saved to " << base_path << "_labels.kpts and " << base_path << "_centroids.kpts\n";
+            return 0;
+        }
+
         std::vector<Point<double, DIMENSION>> points;
         try {
-            points = CSVUtils::readCSV<double, DIMENSION>(full_path);
+            if (point_file) {
+                points = PointFile(full_path).readPoints<double, DIMENSION>();
+            } else {
+                points = CSVUtils::readCSV<double, DIMENSION>(full_path);
+                for (std::size_t i = 0; i < points.size(); ++i) {
+                    points[i].id = i;
+                }
+            }
         } catch (const std::exception &e) {
-            std::cerr << "Failed to read CSV: " << e.what() << '\n';
+            std::cerr << "Failed to read " << (point_file ? "point file" : "CSV") << ": " << e.what() << '\n';
             std::cerr << "Ensure the file exists at: " << full_path << '\n';
             return 1;
         }
 
-        EuclideanMetric<double, DIMENSION> metric(points, 1e-4);
-        KMeans<double, DIMENSION, EuclideanMetric<double, DIMENSION>> kmeans(num_clusters, 1e-4, &metric, num_initialization_method, kinitMethod);
+        if (convert && !point_file) {
+            PointFile::convertCSV(full_path, base_path + ".kpts");
+            std::cout << "Point file saved to " << base_path << ".kpts\n";
+        }
+
+        if (reorder) {
+            SpatialOrder::reorderPoints(points);
+        }
+
+        EuclideanMetric<double, DIMENSION> metric(std::move(points), 1e-4);
+        KMeans<double, DIMENSION, EuclideanMetric<double, DIMENSION>> kmeans(num_clusters, 1e-4, &metric, num_initialization_method, kinitMethod, seed);
 
         kmeans.fit();
         kmeans.print();
 
+        if (exportResult) {
+            exportClustering(base_path, kmeans.getPoints(), kmeans.getCentroids());
+        }
+
         return 0;
     }
     catch (const std::exception &e) {
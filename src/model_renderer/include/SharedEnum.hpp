@@ -18,7 +18,9 @@ public:
         RANDOM,
         KDE,
         MOSTDISTANT,
-        KDE3D
+        KDE3D,
+        MEANSHIFT,
+        KMEANSPP
     };
 
     enum class MetricMethod
@@ -55,6 +57,10 @@ public:
             return "Most Distant";
         case CentroidInit::KDE3D:
             return "Static KDE - 3D Point";
+        case CentroidInit::MEANSHIFT:
+            return "Mean Shift";
+        case CentroidInit::KMEANSPP:
+            return "K-Means++";
         default:
             return "Unknown Centroid Init Method";
         }
@@ -226,7 +226,7 @@ void Render::start()
                 }
 
                 // Initialization method dropdown
-                const Enums::CentroidInit initMethods[] = {Enums::CentroidInit::RANDOM, Enums::CentroidInit::KDE, Enums::CentroidInit::MOSTDISTANT, Enums::CentroidInit::KDE3D};
+                const Enums::CentroidInit initMethods[] = {Enums::CentroidInit::RANDOM, Enums::CentroidInit::KDE, Enums::CentroidInit::MOSTDISTANT, Enums::CentroidInit::KDE3D, Enums::CentroidInit::MEANSHIFT, Enums::CentroidInit::KMEANSPP};
                 static Enums::CentroidInit selectedInitMethod = Enums::CentroidInit::RANDOM;
                 static Enums::KInit selectedKInitMethod = Enums::KInit::ELBOW_METHOD;
                 static Enums::MetricMethod selectedMetricMethod = Enums::MetricMethod::DIJKSTRA;
@@ -3,6 +3,7 @@
 #include <cstdlib>
 
 #include "mesh_segmentation/MeshSegmentation.hpp"
+#include "mesh_segmentation/MultilevelMeshSegmentation.hpp"
 #include "geometry/metrics/EuclideanMetric.hpp"
 #include "geometry/metrics/GeodesicDijkstraMetric.hpp"
 #include "geometry/metrics/GeodesicHeatMetric.hpp"
@@ -12,18 +13,86 @@ using namespace std;
 
 #define DIM 3
 
+// Runs the plain or the multilevel segmentation with the given metric
+template <class M>
+void segment(Mesh &mesh, int num_clusters, double threshold, int num_initialization_method, int num_k_init_method, bool multilevel, std::uint64_t seed)
+{
+    if (multilevel)
+    {
+        MultilevelMeshSegmentation<M> segmentation(&mesh, num_clusters, threshold, num_initialization_method, num_k_init_method, MULTILEVEL_COARSE_FACES, seed);
+        segmentation.fit();
+    }
+    else
+    {
+        MeshSegmentation<M> segmentation(&mesh, num_clusters, threshold, num_initialization_method, num_k_init_method, seed);
+        segmentation.fit();
+    }
+}
+
 int main(int argc, char *argv[])
 {
     try
     {
+        // The flags can appear anywhere, the other arguments are positional
+        bool multilevel = false;
+        bool edgeAdjacency = false;
+        bool reorder = false;
+        bool ply = false;
+        bool seg = false;
+        std::uint64_t seed = KMEANS_PP_SEED;
+        int numArgs = 0;
+        for (int i = 0; i < argc; ++i)
+        {
+            if (string(argv[i]) == "--multilevel")
+            {
+                multilevel = true;
+            }
+            else if (string(argv[i]) == "--edge-adjacency")
+            {
+                edgeAdjacency = true;
+            }
+            else if (string(argv[i]) == "--reorder")
+            {
+                reorder = true;
+            }
+            else if (string(argv[i]) == "--ply")
+            {
+                ply = true;
+            }
+            else if (string(argv[i]) == "--seg")
+            {
+                seg = true;
+            }
+            else if (string(argv[i]) == "--seed")
+            {
+                if (i + 1 == argc)
+                {
+                    std::cerr << "Error: --seed requires a value." << std::endl;
+                    return 1;
+                }
+                seed = std::stoull(argv[++i]);
+            }
+            else
+            {
+                argv[numArgs++] = argv[i];
+            }
+        }
+        argc = numArgs;
+
         if (argc < 5)
         {
-            std::cerr << "Usage: " << argv[0] << " <mesh_file> <num_clusters> <init_method> <metric> [k_init_method]" << std::endl;
+            std::cerr << "Usage: " << argv[0] << " <mesh_file> <num_clusters> <init_method> <metric> [k_init_method] [--multilevel] [--edge-adjacency] [--reorder] [--ply] [--seg] [--seed <seed>]" << std::endl;
             std::cerr << "  <mesh_file>       : Name of the mesh file (i.e resources/meshes/obj/1.obj)" << std::endl;
             std::cerr << "  <num_clusters>    : Number of clusters (0 if unknown)" << std::endl;
-            std::cerr << "  <init_method>     : Initialization method for centroids (0: random, 1: KDE, 2: most distant, 3: Static KDE - 3D point)" << std::endl;
+            std::cerr << "  <init_method>     : Initialization method for centroids (0: random, 1: KDE, 2: most distant, 3: Static KDE - 3D point, 4: mean shift, 5: k-means++)" << std::endl;
             std::cerr << "  <metric>          : Distance metric (0: Euclidean, 1: Dijkstra, 2: Heat)" << std::endl;
             std::cerr << "  [k_init_method]   : (Optional) Method for k initialization (0: elbow, 1: KDE, 2: Silhouette) if <num_clusters> is 0" << std::endl;
+            std::cerr << "  [--multilevel]    : (Optional) Cluster a coarsened mesh and refine back, for large meshes" << std::endl;
+            std::cerr << "  [--edge-adjacency]: (Optional) Faces are adjacent only through edges (faster Dijkstra)" << std::endl;
+            std::cerr << "  [--reorder]       : (Optional) Sort vertices and faces along a space-filling curve, for large meshes" << std::endl;
+            std::cerr << "  [--ply]           : (Optional) Save the segmented mesh as binary PLY with a per-face label, instead of OBJ" << std::endl;
+            std::cerr << "  [--seg]           : (Optional) Also save the label of each face to a .seg file" << std::endl;
+            std::cerr << "  [--seed <seed>]   : (Optional) Seed of the k-means++ initialization (default " << KMEANS_PP_SEED << ")" << std::endl;
             return 1;
         }
 
@@ -45,21 +114,26 @@ int main(int argc, char *argv[])
         }
 
         Mesh mesh(file_name);
+        if (reorder)
+        {
+            mesh.reorderSpatially();
+        }
+        if (edgeAdjacency)
+        {
+            mesh.setAdjacencyMode(AdjacencyMode::EDGE);
+        }
 
         if (metric == Enums::MetricMethod::EUCLIDEAN)
         {
-            MeshSegmentation<EuclideanMetric<double, DIM>> segmentation(&mesh, num_clusters, 1e-4, num_initialization_method, num_k_init_method);
-            segmentation.fit();
+            segment<EuclideanMetric<double, DIM>>(mesh, num_clusters, 1e-4, num_initialization_method, num_k_init_method, multilevel, seed);
         }
         else if (metric == Enums::MetricMethod::DIJKSTRA)
         {
-            MeshSegmentation<GeodesicDijkstraMetric<double, DIM>> segmentation(&mesh, num_clusters, 0.05, num_initialization_method, num_k_init_method);
-            segmentation.fit();
+            segment<GeodesicDijkstraMetric<double, DIM>>(mesh, num_clusters, 0.05, num_initialization_method, num_k_init_method, multilevel, seed);
         }
         else if (metric == Enums::MetricMethod::HEAT)
         {
-            MeshSegmentation<GeodesicHeatMetric<double, DIM>> segmentation(&mesh, num_clusters, 0.05, num_initialization_method, num_k_init_method);
-            segmentation.fit();
+            segment<GeodesicHeatMetric<double, DIM>>(mesh, num_clusters, 0.05, num_initialization_method, num_k_init_method, multilevel, seed);
         }
         else
         {
@@ -68,10 +142,22 @@ int main(int argc, char *argv[])
         }
 
         // Generate the output file path
-        std::string output_file = file_name.substr(0, file_name.find_last_of('.')) + "_segmented.obj";
+        std::string output_base = file_name.substr(0, file_name.find_last_of('.')) + "_segmented";
+        std::string output_file = output_base + (ply ? ".ply" : ".obj");
 
         // Export the mesh grouped by clusters
-        mesh.exportToGroupedObj(output_file);
+        if (ply)
+        {
+            mesh.exportToPly(output_file);
+        }
+        else
+        {
+            mesh.exportToGroupedObj(output_file);
+        }
+        if (seg)
+        {
+            mesh.exportToSeg(output_base + ".seg");
+        }
 
         std::cout << "Segmented mesh saved to: " << output_file << std::endl;
 
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include "clustering/CentroidInitializationMethods/BinnedKDE.hpp"
+#include "clustering/CentroidInitializationMethods/KDECentroid.hpp"
+#include "GaussianBlobs.hpp"
+
+class BinnedKDETest : public ::testing::Test
+{
+protected:
+    std::vector<Point<double, 2>> data;
+
+    // Two Gaussian blobs, elongated along y
+    void SetUp() override
+    {
+        data = gaussianBlobs<2>({{{0.0, 0.0}}, {{6.0, 3.0}}}, {1.0, 2.0}, 4000, 7);
+    }
+};
+
+TEST_F(BinnedKDETest, LinearBinningKeepsTheWeights)
+{
+    std::vector<Point<double, 2>> points = {{{0.0, 0.0}}, {{1.5, 2.0}}, {{9.0, 9.0}}};
+    BinnedKDE<2> binned(points, {0.0, 0.0}, {1.0, 1.0}, {4, 3});
+
+    const std::vector<double> &weights = binned.weights();
+    ASSERT_EQ(weights.size(), 12);
+    EXPECT_DOUBLE_EQ(weights[0], 1.0);
+    EXPECT_DOUBLE_EQ(weights[1 + 4 * 2], 0.5); // (1.5, 2) between (1, 2) and (2, 2)
+    EXPECT_DOUBLE_EQ(weights[2 + 4 * 2], 0.5);
+    EXPECT_DOUBLE_EQ(weights[11], 1.0); // Clamped onto the last node
+    double total = 0;
+    for (double w : weights)
+    {
+        total += w;
+    }
+    EXPECT_DOUBLE_EQ(total, 3.0);
+}
+
+TEST_F(BinnedKDETest, MatchesTheExactSums)
+{
+    KDEBase<2> exact;
+    exact.m_h = exact.bandwidth_RuleOfThumb(data);
+
+    // Grid with a step of half the smallest bandwidth, over the data
+    std::array<double, 2> origin = {-4.0, -8.0}, step;
+    std::array<std::size_t, 2> extents;
+    for (std::size_t d = 0; d < 2; ++d)
+    {
+        step[d] = 0.5 * std::sqrt(exact.m_h(0, 0));
+        extents[d] = static_cast<std::size_t>(18.0 / step[d]) + 1;
+    }
+    BinnedKDE<2> binned(data, origin, step, extents);
+
+    for (double factor : {1.0, 0.5})
+    {
+        if (factor != 1.0)
+        {
+            exact.shrinkBandwidth(factor, data);
+        }
+        const std::vector<double> densities = binned.densities(exact.m_h);
+        double maxDensity = 0, maxError = 0;
+        for (std::size_t j = 0; j < densities.size(); j += 7)
+        {
+            Point<double, 2> node;
+            node.coordinates = {origin[0] + (j % extents[0]) * step[0], origin[1] + (j / extents[0]) * step[1]};
+            const double value = exact.kdeValue(node);
+            maxDensity = std::max(maxDensity, value);
+            maxError = std::max(maxError, std::abs(value - densities[j]));
+        }
+        EXPECT_LT(maxError, 0.02 * maxDensity);
+    }
+}
+
+TEST_F(BinnedKDETest, MatchesTheExactSumsOnTheKDEGrid)
+{
+    // The grid of the KDE initializer, whose step is larger than the bandwidth
+    KDE<2> kde(data, 2);
+    const std::vector<Point<double, 2>> grid = kde.generateGrid();
+    std::size_t extent = 1;
+    while (grid[extent].coordinates[1] == grid[0].coordinates[1])
+    {
+        ++extent;
+    }
+    const std::array<double, 2> step = {grid[1].coordinates[0] - grid[0].coordinates[0],
+                                        grid[extent].coordinates[1] - grid[0].coordinates[1]};
+    ASSERT_GT(step[0], std::sqrt(kde.m_h(0, 0)));
+    BinnedKDE<2> binned(data, grid[0].coordinates, step, {extent, grid.size() / extent});
+
+    // The bandwidth of the rule of thumb and two rungs of the ladder
+    for (double factor : {1.0, 0.4, 0.4})
+    {
+        if (factor != 1.0)
+        {
+            kde.shrinkBandwidth(factor, data);
+        }
+        ASSERT_TRUE(binned.resolves(kde.m_h));
+        const std::vector<double> densities = binned.densities(kde.m_h);
+        ASSERT_EQ(densities.size(), grid.size());
+        double maxDensity = 0, maxError = 0;
+        for (std::size_t j = 0; j < grid.size(); ++j)
+        {
+            const double value = kde.kdeValue(grid[j]);
+            maxDensity = std::max(maxDensity, value);
+            maxError = std::max(maxError, std::abs(value - densities[j]));
+        }
+        EXPECT_LT(maxError, 0.01 * maxDensity);
+    }
+}
+
+TEST_F(BinnedKDETest, DoesNotResolveBandwidthsFinerThanTheNodeLimit)
+{
+    BinnedKDE<2> binned(data, {0.0, 0.0}, {1.0, 1.0}, {100, 100});
+    Eigen::MatrixXd bandwidth = Eigen::MatrixXd::Identity(2, 2);
+    EXPECT_TRUE(binned.resolves(bandwidth));
+    bandwidth *= 1e-4;
+    EXPECT_FALSE(binned.resolves(bandwidth));
+    EXPECT_THROW(binned.densities(bandwidth), std::invalid_argument);
+}
+
+TEST_F(BinnedKDETest, RejectsNonDiagonalBandwidths)
+{
+    BinnedKDE<2> binned(data, {0.0, 0.0}, {1.0, 1.0}, {5, 5});
+    Eigen::MatrixXd bandwidth(2, 2);
+    bandwidth << 1.0, 0.5, 0.5, 1.0;
+    EXPECT_THROW(binned.densities(bandwidth), std::invalid_argument);
+}
+
+TEST_F(BinnedKDETest, KDEFindsTheSameCentroidsAsExactSums)
+{
+    std::vector<CentroidPoint<double, 2>> binnedCentroids, exactCentroids;
+    KDE<2> binned(data, 2);
+    binned.findCentroid(binnedCentroids);
+    KDE<2> exact(data, 2);
+    exact.setExactDensities(true);
+    exact.findCentroid(exactCentroids);
+
+    ASSERT_EQ(binnedCentroids.size(), 2);
+    ASSERT_EQ(exactCentroids.size(), 2);
+    for (const auto &c : binnedCentroids)
+    {
+        double nearest = std::numeric_limits<double>::max();
+        for (const auto &e : exactCentroids)
+        {
+            nearest = std::min(nearest, std::hypot(c.coordinates[0] - e.coordinates[0], c.coordinates[1] - e.coordinates[1]));
+        }
+        EXPECT_LT(nearest, 1.5);
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef GAUSSIAN_BLOBS_HPP
+#define GAUSSIAN_BLOBS_HPP
+
+#include <array>
+#include <random>
+#include <vector>
+#include <cstddef>
+
+#include "geometry/point/Point.hpp"
+
+/**
+ * \brief Draws points around centers with independent Gaussian noise in each dimension.
+ *
+ * Point i is drawn around centers[i % centers.size()], so a center listed twice gets twice
+ * the points. The noise is drawn dimension after dimension from a std::mt19937 of the seed.
+ *
+ * \param centers The centers, cycled through.
+ * \param spread The standard deviation of the noise in each dimension.
+ * \param count The number of points.
+ * \param seed The seed of the generator.
+ * \return The points.
+ */
+template <std::size_t PD>
+inline std::vector<Point<double, PD>> gaussianBlobs(const std::vector<std::array<double, PD>> &centers, const std::array<double, PD> &spread,
+                                                    std::size_t count, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::vector<Point<double, PD>> points;
+    points.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const std::array<double, PD> &center = centers[i % centers.size()];
+        std::array<double, PD> coordinates;
+        for (std::size_t dim = 0; dim < PD; ++dim)
+        {
+            coordinates[dim] = center[dim] + spread[dim] * noise(gen);
+        }
+        points.push_back(Point<double, PD>(coordinates, -1));
+    }
+    return points;
+}
+
+#endif // GAUSSIAN_BLOBS_HPP
@@ -42,4 +42,85 @@ TEST_F(KDEBase2DTest, PointToVector)
     EXPECT_EQ(vec.size(), 2);
     EXPECT_DOUBLE_EQ(vec[0], 1.0);
     EXPECT_DOUBLE_EQ(vec[1], 2.0);
-}
\ No newline at end of file
+}
+TEST_F(KDEBase2DTest, KdeValueMatchesTheKernelSums)
+{
+    kde.m_h = kde.bandwidth_RuleOfThumb(sampleData);
+    EXPECT_EQ(kde.m_transformedPoints.rows(), 2);
+    EXPECT_EQ(kde.m_transformedPoints.cols(), 4);
+
+    // Direct sums of the kernel functions over the transformed differences
+    const Point<double, 2> query({2.2, 3.5}, -1);
+    const std::vector<std::pair<KernelType, double (*)(const Eigen::VectorXd &)>> kernels = {
+        {KernelType::GAUSSIAN, Kernel::gaussian}, {KernelType::EPANECHNIKOV, Kernel::epanechnikov},
+        {KernelType::UNIFORM, Kernel::uniform}, {KernelType::TRIANGULAR, Kernel::triangular},
+        {KernelType::BIWEIGHT, Kernel::biweight}, {KernelType::TRIWEIGHT, Kernel::triweight},
+        {KernelType::COSINE, Kernel::cosine}};
+    for (const auto &[type, kernel] : kernels)
+    {
+        double expected = 0.0;
+        for (const auto &point : sampleData)
+        {
+            expected += kernel(kde.m_h_sqrt_inv * (kde.pointToVector(query) - kde.pointToVector(point)));
+        }
+        expected /= sampleData.size() * std::sqrt(kde.m_h.determinant());
+        EXPECT_NEAR(kde.kdeValue(query, type), expected, 1e-12 * std::max(1.0, expected));
+    }
+}
+
+TEST_F(KDEBase2DTest, ShrinkBandwidthRescalesThePoints)
+{
+    kde.m_h = kde.bandwidth_RuleOfThumb(sampleData);
+    kde.shrinkBandwidth(0.3, sampleData);
+    kde.shrinkBandwidth(1.5, sampleData);
+
+    // Gaussian sums with the inverse square root of the scaled bandwidth, computed afresh
+    const Eigen::MatrixXd bandwidth = kde.m_h;
+    const Eigen::MatrixXd sqrtInverse = Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd>(bandwidth).operatorInverseSqrt();
+    const Point<double, 2> query({2.2, 3.5}, -1);
+    double expected = 0.0;
+    for (const auto &point : sampleData)
+    {
+        expected += Kernel::gaussian(sqrtInverse * (kde.pointToVector(query) - kde.pointToVector(point)));
+    }
+    expected /= sampleData.size() * std::sqrt(bandwidth.determinant());
+    EXPECT_NEAR(kde.kdeValue(query), expected, 1e-12 * std::max(1.0, expected));
+}
+
+TEST_F(KDEBase2DTest, KdeValueRequiresABandwidth)
+{
+    EXPECT_THROW(kde.kdeValue(sampleData[0]), std::runtime_error);
+}
+
+TEST_F(KDEBase2DTest, TruncatedSumsStayWithinTheTolerance)
+{
+    for (int i = 0; i < 300; ++i)
+    {
+        sampleData.push_back(Point<double, 2>({(i % 17) * 0.7, (i % 23) * 0.4}, -1));
+    }
+    kde.m_h = kde.bandwidth_RuleOfThumb(sampleData);
+    EXPECT_THROW(kde.kdeValueTruncated(sampleData[0]), std::runtime_error);
+    EXPECT_THROW(kde.setTruncation(1.0), std::invalid_argument);
+
+    const double tolerance = 1e-6;
+    kde.setTruncation(tolerance);
+    EXPECT_TRUE(kde.isTruncated());
+    const double peak = 1.0 / (2 * M_PI * std::sqrt(kde.m_h.determinant()));
+    double maxError = 0.0;
+    for (const Point<double, 2> &query : {Point<double, 2>({0.0, 0.0}, -1), Point<double, 2>({5.0, 4.0}, -1), Point<double, 2>({30.0, -3.0}, -1)})
+    {
+        double errorBound = 0.0;
+        const double truncated = kde.kdeValueTruncated(query, &errorBound);
+        EXPECT_LE(std::abs(truncated - kde.kdeValue(query)), errorBound + 1e-15);
+        EXPECT_LE(errorBound, tolerance * peak);
+        EXPECT_DOUBLE_EQ(kde.gridDensity(query, maxError), truncated);
+    }
+    EXPECT_GT(maxError, 0.0);
+
+    // The tree follows the bandwidth
+    kde.shrinkBandwidth(0.5, sampleData);
+    EXPECT_NEAR(kde.kdeValueTruncated(sampleData[5]), kde.kdeValue(sampleData[5]), tolerance * 4 * peak);
+
+    kde.setTruncation(0.0);
+    EXPECT_FALSE(kde.isTruncated());
+}
@@ -1,6 +1,7 @@
 
 #include <gtest/gtest.h>
 #include "clustering/CentroidInitializationMethods/KDECentroidMatrix.hpp"
+#include <random>
 
 class KDE3DTest : public ::testing::Test
 {
@@ -26,10 +27,66 @@ protected:
 TEST_F(KDE3DTest, GenerateGridTest)
 {
     Grid3D grid = kde3d->generateGrid();
-    ASSERT_FALSE(grid.empty());
     EXPECT_GT(grid.size(), 0);
-    EXPECT_GT(grid[0].size(), 0);
-    EXPECT_GT(grid[0][0].size(), 0);
+    EXPECT_GT(grid.extents[0], 0);
+    EXPECT_GT(grid.extents[1], 0);
+    EXPECT_GT(grid.extents[2], 0);
+
+    // The last node is the maximum of the data, reached from its flat index
+    Point<double, 3> last = grid.point(grid.size() - 1);
+    for (std::size_t dim = 0; dim < 3; ++dim)
+    {
+        EXPECT_NEAR(last.coordinates[dim], 5.0, 1e-9);
+    }
+    EXPECT_EQ(grid.index(1, 0, 1), 1 + grid.extents[0] * grid.extents[1]);
+}
+
+// Test the plane-by-plane stencil against a direct scan of every box
+TEST_F(KDE3DTest, LocalMaximaMatchDirectScan)
+{
+    Grid3D grid;
+    grid.origin = {0.0, 0.0, 0.0};
+    grid.step = {1.0, 1.0, 1.0};
+    grid.extents = {13, 9, 17};
+    Densities3D densities(grid.size());
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> level(0, 40); // Integer levels, to have ties
+    for (double &density : densities)
+    {
+        density = level(gen);
+    }
+
+    std::vector<std::size_t> expected;
+    for (int x = 0; x < 13; ++x)
+    {
+        for (int y = 0; y < 9; ++y)
+        {
+            for (int z = 0; z < 17; ++z)
+            {
+                bool maximum = true;
+                for (int dx = -3; dx <= 3; ++dx)
+                {
+                    for (int dy = -3; dy <= 3; ++dy)
+                    {
+                        for (int dz = -3; dz <= 3; ++dz)
+                        {
+                            const int nx = x + dx, ny = y + dy, nz = z + dz;
+                            if (nx >= 0 && nx < 13 && ny >= 0 && ny < 9 && nz >= 0 && nz < 17 &&
+                                densities[grid.index(nx, ny, nz)] > densities[grid.index(x, y, z)])
+                            {
+                                maximum = false;
+                            }
+                        }
+                    }
+                }
+                if (maximum)
+                {
+                    expected.push_back(grid.index(x, y, z));
+                }
+            }
+        }
+    }
+    EXPECT_EQ(kde3d->findLocalMaximaIndices(grid, densities), expected);
 }
 
 // Test KDE density computation
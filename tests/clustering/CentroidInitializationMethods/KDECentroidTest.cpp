@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "clustering/CentroidInitializationMethods/KDECentroid.hpp"
+#include "GaussianBlobs.hpp"
 
 constexpr std::size_t PD = 2; // Adjust as needed
 using PointType = Point<double, PD>;
@@ -53,8 +54,170 @@ TEST_F(KDETest, LocalMaximumDetection)
         densities[i] = kde->kdeValue(grid[i]);
     }
 
-    std::vector<std::size_t> neighbors;
-    std::vector<double> offsets;
-    bool isMax = kde->isLocalMaximum(grid, densities, 0, neighbors, offsets);
-    EXPECT_TRUE(isMax || !isMax); // Basic validity check
+    // The stencil pass finds exactly the points passing the check of their neighbors
+    std::vector<std::size_t> maxima = kde->findLocalMaximaIndices(densities);
+    EXPECT_FALSE(maxima.empty());
+    std::size_t next = 0;
+    for (size_t i = 0; i < grid.size(); ++i)
+    {
+        const bool isMax = next < maxima.size() && maxima[next] == i;
+        EXPECT_EQ(kde->isLocalMaximum(densities, i), isMax);
+        next += isMax;
+    }
+}
+
+TEST_F(KDETest, LocalMaximumNeighborsAreClipped)
+{
+    // A single peak on the corner of the grid, the rest decreasing away from it
+    std::vector<PointType> grid = kde->generateGrid();
+    std::vector<double> densities(grid.size());
+    for (size_t i = 0; i < grid.size(); ++i)
+    {
+        densities[i] = -(grid[i].coordinates[0] + grid[i].coordinates[1]);
+    }
+    EXPECT_EQ(kde->findLocalMaximaIndices(densities), std::vector<std::size_t>{0});
+    EXPECT_TRUE(kde->isLocalMaximum(densities, 0));
+    EXPECT_FALSE(kde->isLocalMaximum(densities, grid.size() - 1));
+}
+
+TEST_F(KDETest, SparseGridKeepsTheNodesNearTheData)
+{
+    // Points along the diagonal: most of the bounding box is empty
+    std::vector<PointType> line;
+    for (int i = 0; i < 200; ++i)
+    {
+        line.push_back({{0.05 * i, 0.05 * i}});
+    }
+    KDE<PD> dense(line), sparse(line);
+    sparse.setSparseGrid(true);
+    std::vector<PointType> denseGrid = dense.generateGrid(), sparseGrid = sparse.generateGrid();
+    EXPECT_LT(sparseGrid.size(), denseGrid.size() / 2);
+
+    // Every point has a node within one step, and the nodes are those of the dense grid
+    const double step = denseGrid[1].coordinates[0] - denseGrid[0].coordinates[0];
+    for (const auto &point : line)
+    {
+        double nearest = std::numeric_limits<double>::max();
+        for (const auto &node : sparseGrid)
+        {
+            nearest = std::min(nearest, std::max(std::abs(node.coordinates[0] - point.coordinates[0]), std::abs(node.coordinates[1] - point.coordinates[1])));
+        }
+        EXPECT_LE(nearest, step);
+    }
+    for (const auto &node : sparseGrid)
+    {
+        EXPECT_NEAR(std::remainder(node.coordinates[0], step), 0.0, 1e-9);
+        EXPECT_NEAR(std::remainder(node.coordinates[1], step), 0.0, 1e-9);
+    }
+}
+
+TEST_F(KDETest, SparseGridFindsTheDenseMaxima)
+{
+    // Two blobs far apart
+    std::vector<PointType> blobs;
+    for (int i = 0; i < 300; ++i)
+    {
+        const double cx = (i % 2) * 20.0;
+        blobs.push_back({{cx + std::cos(0.7 * i) * (i % 7) * 0.2, cx + std::sin(0.7 * i) * (i % 5) * 0.2}});
+    }
+    std::vector<CentroidPoint<double, PD>> denseCentroids, sparseCentroids;
+    KDE<PD> dense(blobs, 2), sparse(blobs, 2);
+    sparse.setSparseGrid(true);
+    dense.findCentroid(denseCentroids);
+    sparse.findCentroid(sparseCentroids);
+
+    ASSERT_EQ(sparseCentroids.size(), 2);
+    ASSERT_EQ(denseCentroids.size(), 2);
+    for (const auto &c : sparseCentroids)
+    {
+        double nearest = std::numeric_limits<double>::max();
+        for (const auto &d : denseCentroids)
+        {
+            nearest = std::min(nearest, std::hypot(c.coordinates[0] - d.coordinates[0], c.coordinates[1] - d.coordinates[1]));
+        }
+        EXPECT_LT(nearest, 1e-9);
+    }
+}
+
+TEST_F(KDETest, BandwidthSearchStopsOnTheWidestRung)
+{
+    // Three small clusters: the bandwidth of the rule of thumb smooths two of them together
+    std::vector<PointType> clusters;
+    for (int i = 0; i < 12; ++i)
+    {
+        clusters.push_back({{(i % 3) * 5.0 + 0.2 * std::cos(1.3 * i), 0.2 * std::sin(1.7 * i)}});
+    }
+    KDE<PD> unrestricted(clusters);
+    EXPECT_LT(unrestricted.findLocalWithoutRestriction(), 3);
+
+    KDE<PD> search(clusters, 3);
+    std::vector<CentroidPoint<double, PD>> centroids;
+    search.findCentroid(centroids);
+    EXPECT_EQ(centroids.size(), 3);
+    EXPECT_DOUBLE_EQ(search.getBandwidthScale(), KDE_BANDWIDTH_SHRINK);
+}
+
+TEST_F(KDETest, CentroidsFromASharedAnalysis)
+{
+    // The analysis of the search of k gives the same centroids as a fresh computation
+    KDE<PD> search(sampleData);
+    std::shared_ptr<const KDEAnalysis<PD>> analysis = search.analyze();
+    ASSERT_FALSE(analysis->maxima.empty());
+    const int k = analysis->maxima.size();
+
+    std::vector<CentroidPoint<double, PD>> shared, fresh;
+    KDE<PD> reusing(sampleData, k), computing(sampleData, k);
+    reusing.setAnalysis(analysis);
+    reusing.findCentroid(shared);
+    computing.findCentroid(fresh);
+    ASSERT_EQ(shared.size(), fresh.size());
+    for (std::size_t i = 0; i < shared.size(); ++i)
+    {
+        EXPECT_EQ(shared[i].coordinates, fresh[i].coordinates);
+    }
+
+    std::vector<PointType> other(sampleData.begin(), sampleData.begin() + 4);
+    KDE<PD> mismatched(other, 1);
+    EXPECT_THROW(mismatched.setAnalysis(analysis), std::invalid_argument);
+}
+
+TEST_F(KDETest, MoreClustersThanModes)
+{
+    // Five blobs, enough points for the binned densities
+    const std::vector<std::array<double, PD>> centers = {{{0.0, 0.0}}, {{10.0, 0.0}}, {{0.0, 10.0}}, {{10.0, 10.0}}, {{5.0, 5.0}}};
+    const std::vector<PointType> blobs = gaussianBlobs<PD>(centers, {1.0, 1.0}, 5000, 3);
+    ASSERT_GE(blobs.size(), KDE_BINNED_MIN_POINTS);
+
+    for (int k : {6, 8})
+    {
+        std::vector<CentroidPoint<double, PD>> centroids;
+        KDE<PD>(blobs, k).findCentroid(centroids);
+        EXPECT_EQ(centroids.size(), k);
+
+        // The modes are kept, the farthest points added to them
+        for (const auto &center : centers)
+        {
+            EXPECT_TRUE(std::any_of(centroids.begin(), centroids.end(), [&](const CentroidPoint<double, PD> &c)
+                                    { return std::hypot(c.coordinates[0] - center[0], c.coordinates[1] - center[1]) < 2.0; }));
+        }
+    }
+}
+
+TEST_F(KDETest, MoreClustersThanDistinctPoints)
+{
+    // No bandwidth separates more than four modes: the farthest points complete them
+    std::vector<PointType> triples;
+    for (int i = 0; i < 3000; ++i)
+    {
+        triples.push_back({{(i % 3) * 4.0, (i % 3 == 1) ? 3.0 : 0.0}});
+    }
+    triples.push_back({{20.0, 20.0}});
+
+    std::vector<CentroidPoint<double, PD>> centroids;
+    KDE<PD>(triples, 5).findCentroid(centroids);
+    ASSERT_EQ(centroids.size(), 5);
+    for (std::size_t i = 0; i < centroids.size(); ++i)
+    {
+        EXPECT_EQ(centroids[i].id, i);
+    }
 }
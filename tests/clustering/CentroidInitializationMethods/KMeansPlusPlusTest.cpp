@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "clustering/CentroidInitializationMethods/KMeansPlusPlus.hpp"
+#include "GaussianBlobs.hpp"
+#include <set>
+#include <omp.h>
+
+class KMeansPlusPlusTest : public ::testing::Test
+{
+protected:
+    std::vector<Point<double, 2>> data;
+    const std::vector<std::array<double, 2>> centers = {{{0.0, 0.0}}, {{50.0, 0.0}}, {{0.0, 50.0}}, {{50.0, 50.0}}};
+
+    // Four tight, far apart blobs, over more than one block of sums
+    void SetUp() override
+    {
+        data = gaussianBlobs<2>(centers, {1.0, 1.0}, 10000, 5);
+    }
+};
+
+TEST_F(KMeansPlusPlusTest, DrawsDistinctPointsOfTheDataset)
+{
+    KMeansPlusPlus<2> init(data, 10);
+    std::vector<CentroidPoint<double, 2>> centroids;
+    init.findCentroid(centroids);
+
+    ASSERT_EQ(centroids.size(), 10);
+    std::set<std::array<double, 2>> drawn;
+    for (std::size_t i = 0; i < centroids.size(); ++i)
+    {
+        EXPECT_EQ(centroids[i].id, i);
+        drawn.insert(centroids[i].coordinates);
+        EXPECT_TRUE(std::any_of(data.begin(), data.end(), [&](const Point<double, 2> &p)
+                                { return p.coordinates == centroids[i].coordinates; }));
+    }
+    EXPECT_EQ(drawn.size(), 10);
+}
+
+TEST_F(KMeansPlusPlusTest, SpreadsOverTheBlobs)
+{
+    for (std::uint64_t seed : {1, 2, 3})
+    {
+        KMeansPlusPlus<2> init(data, 4, seed);
+        std::vector<CentroidPoint<double, 2>> centroids;
+        init.findCentroid(centroids);
+
+        std::set<std::size_t> blobs;
+        for (const auto &centroid : centroids)
+        {
+            for (std::size_t c = 0; c < centers.size(); ++c)
+            {
+                if (std::hypot(centroid.coordinates[0] - centers[c][0], centroid.coordinates[1] - centers[c][1]) < 10.0)
+                {
+                    blobs.insert(c);
+                }
+            }
+        }
+        EXPECT_EQ(blobs.size(), 4);
+    }
+}
+
+TEST_F(KMeansPlusPlusTest, DependsOnlyOnTheSeed)
+{
+    std::vector<CentroidPoint<double, 2>> first, second, other;
+    const int threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    KMeansPlusPlus<2>(data, 6, 7).findCentroid(first);
+    omp_set_num_threads(3);
+    KMeansPlusPlus<2>(data, 6, 7).findCentroid(second);
+    KMeansPlusPlus<2>(data, 6, 8).findCentroid(other);
+    omp_set_num_threads(threads);
+
+    ASSERT_EQ(first.size(), second.size());
+    for (std::size_t i = 0; i < first.size(); ++i)
+    {
+        EXPECT_EQ(first[i].coordinates, second[i].coordinates);
+    }
+    EXPECT_NE(first[0].coordinates, other[0].coordinates);
+}
+
+TEST_F(KMeansPlusPlusTest, HandlesDuplicatesAndInvalidK)
+{
+    // Fewer distinct points than clusters: the centroids repeat them
+    std::vector<Point<double, 2>> duplicates(5, Point<double, 2>({1.0, 1.0}, -1));
+    duplicates.push_back(Point<double, 2>({2.0, 2.0}, -1));
+    KMeansPlusPlus<2> init(duplicates, 4);
+    std::vector<CentroidPoint<double, 2>> centroids;
+    init.findCentroid(centroids);
+    EXPECT_EQ(centroids.size(), 4);
+
+    EXPECT_THROW(KMeansPlusPlus<2>(duplicates, 7), std::invalid_argument);
+    KMeansPlusPlus<2> withoutK(duplicates);
+    EXPECT_THROW(withoutK.findCentroid(centroids), std::invalid_argument);
+}
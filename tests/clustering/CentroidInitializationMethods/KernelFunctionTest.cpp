@@ -58,3 +58,31 @@ TEST_F(KernelTest, CosineKernel)
     EXPECT_GT(Kernel::cosine(inside), 0);
     EXPECT_EQ(Kernel::cosine(outside), 0);
 }
+
+TEST_F(KernelTest, ProfilesMatchTheKernels)
+{
+    const std::vector<Eigen::VectorXd> arguments = {zero, inside, outside, Eigen::VectorXd::Constant(3, 0.3)};
+    Eigen::ArrayXd squaredNorms(arguments.size());
+    for (std::size_t i = 0; i < arguments.size(); ++i)
+    {
+        squaredNorms[i] = arguments[i].squaredNorm();
+    }
+
+    const Eigen::ArrayXd gaussian = Kernel::coefficient(KernelType::GAUSSIAN, 3) * Kernel::gaussianProfile(squaredNorms);
+    const Eigen::ArrayXd epanechnikov = Kernel::epanechnikovProfile(squaredNorms);
+    const Eigen::ArrayXd uniform = Kernel::uniformProfile(squaredNorms);
+    const Eigen::ArrayXd triangular = Kernel::triangularProfile(squaredNorms);
+    const Eigen::ArrayXd biweight = Kernel::biweightProfile(squaredNorms);
+    const Eigen::ArrayXd triweight = Kernel::triweightProfile(squaredNorms);
+    const Eigen::ArrayXd cosine = Kernel::cosineProfile(squaredNorms);
+    for (std::size_t i = 0; i < arguments.size(); ++i)
+    {
+        EXPECT_NEAR(gaussian[i], Kernel::gaussian(arguments[i]), 1e-15);
+        EXPECT_NEAR(epanechnikov[i], Kernel::epanechnikov(arguments[i]), 1e-15);
+        EXPECT_NEAR(uniform[i], Kernel::uniform(arguments[i]), 1e-15);
+        EXPECT_NEAR(triangular[i], Kernel::triangular(arguments[i]), 1e-15);
+        EXPECT_NEAR(biweight[i], Kernel::biweight(arguments[i]), 1e-15);
+        EXPECT_NEAR(triweight[i], Kernel::triweight(arguments[i]), 1e-15);
+        EXPECT_NEAR(cosine[i], Kernel::cosine(arguments[i]), 1e-15);
+    }
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include "clustering/CentroidInitializationMethods/MeanShift.hpp"
+#include "GaussianBlobs.hpp"
+
+class MeanShiftTest : public ::testing::Test
+{
+protected:
+    std::vector<Point<double, 2>> data;
+    const std::vector<std::array<double, 2>> centers = {{{0.0, 0.0}}, {{10.0, 0.0}}, {{5.0, 8.0}}};
+
+    // Three Gaussian blobs of different sizes, the last one with half the points of the others
+    void SetUp() override
+    {
+        data = gaussianBlobs<2>({centers[0], centers[1], centers[2], centers[0], centers[1]}, {1.0, 1.0}, 1500, 3);
+    }
+
+    void expectNearCenters(const std::vector<CentroidPoint<double, 2>> &centroids)
+    {
+        for (const auto &c : centers)
+        {
+            double nearest = std::numeric_limits<double>::max();
+            for (const auto &centroid : centroids)
+            {
+                nearest = std::min(nearest, std::hypot(centroid.coordinates[0] - c[0], centroid.coordinates[1] - c[1]));
+            }
+            EXPECT_LT(nearest, 0.5);
+        }
+    }
+};
+
+TEST_F(MeanShiftTest, FindsTheModesOfTheBlobs)
+{
+    MeanShift<2> meanShift(data, 3);
+    std::vector<CentroidPoint<double, 2>> centroids;
+    meanShift.findCentroid(centroids);
+
+    ASSERT_EQ(centroids.size(), 3);
+    expectNearCenters(centroids);
+    for (std::size_t i = 0; i < centroids.size(); ++i)
+    {
+        EXPECT_EQ(centroids[i].id, static_cast<int>(i));
+    }
+}
+
+TEST_F(MeanShiftTest, ModesAreSortedByDensity)
+{
+    MeanShift<2> meanShift(data);
+    const auto modes = meanShift.findModes();
+    ASSERT_GE(modes.size(), 3);
+    for (std::size_t i = 1; i < modes.size(); ++i)
+    {
+        EXPECT_GE(modes[i - 1].second, modes[i].second);
+    }
+
+    // The densities are the ones of the kernel density estimate
+    EXPECT_NEAR(modes[0].second, meanShift.kdeValue(modes[0].first), 1e-3 * modes[0].second);
+}
+
+TEST_F(MeanShiftTest, ShrinksTheBandwidthForMoreClusters)
+{
+    MeanShift<2> meanShift(data, 8);
+    std::vector<CentroidPoint<double, 2>> centroids;
+    meanShift.findCentroid(centroids);
+    EXPECT_EQ(centroids.size(), 8);
+}
+
+TEST_F(MeanShiftTest, MoreClustersThanDistinctPoints)
+{
+    // Three distinct points: the modes are completed with the farthest points
+    std::vector<Point<double, 2>> triples;
+    for (int i = 0; i < 300; ++i)
+    {
+        triples.push_back(Point<double, 2>({(i % 3) * 4.0, (i % 3 == 1) ? 3.0 : 0.0}, i));
+    }
+
+    std::vector<CentroidPoint<double, 2>> centroids;
+    MeanShift<2>(triples, 5).findCentroid(centroids);
+    ASSERT_EQ(centroids.size(), 5);
+    for (std::size_t i = 0; i < centroids.size(); ++i)
+    {
+        EXPECT_EQ(centroids[i].id, static_cast<int>(i));
+    }
+}
+
+TEST_F(MeanShiftTest, RejectsMoreClustersThanPoints)
+{
+    std::vector<Point<double, 2>> few(data.begin(), data.begin() + 2);
+    EXPECT_THROW(MeanShift<2>(few, 3), std::invalid_argument);
+}
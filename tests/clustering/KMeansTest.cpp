@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include "clustering/KMeans.hpp"
+#include <set>
+#include "CentroidInitializationMethods/GaussianBlobs.hpp"
 
 // Define test fixture for KMeans
 class KMeansTest : public ::testing::Test
@@ -70,3 +72,101 @@ TEST_F(KMeansTest, SetNumClustersWorks)
 
     EXPECT_EQ(kmeans.getCentroids().size(), 2);
 }
+
+// Test the automatic k with KDE, whose analysis is shared with the KDE centroids
+TEST_F(KMeansTest, AutomaticKWithKDE)
+{
+    KMeans<double, 2, Metric2D> kmeans(0, 0.001, metric, static_cast<int>(Enums::CentroidInit::KDE), static_cast<int>(Enums::KInit::KDE_METHOD));
+
+    KDE<2> kde(points);
+    EXPECT_EQ(kmeans.getCentroids().size(), kde.findLocalWithoutRestriction());
+}
+
+// The seed of the k-means++ initialization is the one given to KMeans
+TEST_F(KMeansTest, KMeansPlusPlusUsesTheSeed)
+{
+    const int kmeanspp = static_cast<int>(Enums::CentroidInit::KMEANSPP);
+    std::set<std::vector<double>> initializations;
+    for (std::uint64_t seed = 1; seed <= 8; ++seed)
+    {
+        KMeans<double, 2, Metric2D> kmeans(2, 0.001, metric, kmeanspp, 0, seed);
+        KMeans<double, 2, Metric2D> again(2, 0.001, metric, kmeanspp, 0, seed);
+        std::vector<double> coordinates;
+        for (std::size_t c = 0; c < 2; ++c)
+        {
+            EXPECT_EQ(kmeans.getCentroids()[c].coordinates, again.getCentroids()[c].coordinates);
+            coordinates.insert(coordinates.end(), kmeans.getCentroids()[c].coordinates.begin(), kmeans.getCentroids()[c].coordinates.end());
+        }
+        initializations.insert(coordinates);
+    }
+    EXPECT_GT(initializations.size(), 1);
+}
+
+// A blob and a far pair of points: the bandwidth is too narrow for the binning over the
+// bounding box, mostly empty, so the KDE initialization sums over the nodes near the data
+class KMeansKDETest : public ::testing::Test
+{
+protected:
+    using Point3D = Point<double, 3>;
+    std::vector<Point3D> points;
+
+    void SetUp() override
+    {
+        points = gaussianBlobs<3>({{{0.0, 0.0, 0.0}}}, {1.0, 1.0, 1.0}, 5000, 11);
+        points.push_back(Point3D({1e5, 1e5, 1e5}, -1));
+        points.push_back(Point3D({1e5 + 1, 1e5, 1e5}, -1));
+    }
+};
+
+TEST_F(KMeansKDETest, TruncatesTheSumsOverLargeDatasets)
+{
+    KDE<3> kde(points, 2);
+    std::vector<CentroidPoint<double, 3>> centroids;
+    kde.findCentroid(centroids);
+    EXPECT_TRUE(kde.isTruncated());
+    EXPECT_GT(kde.getMaxTruncationError(), 0.0);
+
+    EuclideanMetric<double, 3> metric(points, 0.01);
+    KMeans<double, 3, EuclideanMetric<double, 3>> kmeans(2, 0.001, &metric, static_cast<int>(Enums::CentroidInit::KDE), 0);
+    ASSERT_EQ(kmeans.getCentroids().size(), 2);
+    const auto &first = kmeans.getCentroids()[0].coordinates, &second = kmeans.getCentroids()[1].coordinates;
+    EXPECT_GT(std::abs(first[0] - second[0]), 5e4);
+
+    // Exact densities are never truncated
+    KDE<3> exact(points, 2);
+    exact.setExactDensities(true);
+    exact.findCentroid(centroids);
+    EXPECT_FALSE(exact.isTruncated());
+}
+
+TEST_F(KMeansKDETest, UsesTheSparseGridOverMostlyEmptyBoxes)
+{
+    KDE<3> kde(points, 2);
+    const std::size_t sparseNodes = kde.generateGrid().size();
+    EXPECT_TRUE(kde.isSparseGrid());
+
+    // Same centroids as the dense grid, from a small fraction of its nodes
+    KDE<3> dense(points, 2);
+    dense.setSparseGrid(false);
+    EXPECT_LT(sparseNodes, dense.generateGrid().size() / 10);
+    std::vector<CentroidPoint<double, 3>> sparseCentroids, denseCentroids;
+    kde.findCentroid(sparseCentroids);
+    dense.findCentroid(denseCentroids);
+    ASSERT_EQ(sparseCentroids.size(), 2);
+    ASSERT_EQ(denseCentroids.size(), 2);
+    for (std::size_t i = 0; i < 2; ++i)
+    {
+        EXPECT_EQ(sparseCentroids[i].coordinates, denseCentroids[i].coordinates);
+    }
+
+    // Through the KDE search of k and the KDE initialization of KMeans
+    EuclideanMetric<double, 3> metric(points, 0.01);
+    KMeans<double, 3, EuclideanMetric<double, 3>> kmeans(0, 0.001, &metric, static_cast<int>(Enums::CentroidInit::KDE), static_cast<int>(Enums::KInit::KDE_METHOD));
+    EXPECT_EQ(kmeans.getCentroids().size(), 2);
+
+    // A blob filling its box keeps the dense grid
+    std::vector<Point3D> blob(points.begin(), points.end() - 2);
+    KDE<3> filled(blob, 1);
+    filled.generateGrid();
+    EXPECT_FALSE(filled.isSparseGrid());
+}
@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include "clustering/StreamingKMeans.hpp"
+#include "clustering/CentroidInitializationMethods/KMeansPlusPlus.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <set>
+
+class StreamingKMeansTest : public ::testing::Test
+{
+protected:
+    std::string csvPath = "test_stream.csv";
+    std::string pointsPath = "test_stream.kpts";
+    std::string labelsPath = "test_stream_labels.kpts";
+    std::vector<Point<double, 2>> points;
+
+    // Three well separated groups of 100 points, interleaved in the file
+    void SetUp() override
+    {
+        std::ofstream csv(csvPath);
+        csv << std::setprecision(17) << "x,y\n";
+        for (int i = 0; i < 300; ++i)
+        {
+            const double cx = (i % 3) * 100.0, cy = (i % 3 == 1) * 50.0;
+            points.emplace_back(std::array<double, 2>{cx + (i % 7) * 0.1, cy - (i % 5) * 0.1});
+            csv << points.back().coordinates[0] << "," << points.back().coordinates[1] << "\n";
+        }
+        csv.close();
+        PointFile::writePoints(pointsPath, points);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(csvPath);
+        std::filesystem::remove(pointsPath);
+        std::filesystem::remove(labelsPath);
+    }
+
+    // Points of the same group share a label, and the groups have distinct labels
+    void expectGroupLabels()
+    {
+        PointFile labels(labelsPath);
+        ASSERT_EQ(labels.numPoints(), 300);
+        const std::int32_t *label = labels.column<std::int32_t>(0);
+        EXPECT_NE(label[0], label[1]);
+        EXPECT_NE(label[1], label[2]);
+        EXPECT_NE(label[0], label[2]);
+        for (int i = 3; i < 300; ++i)
+        {
+            EXPECT_EQ(label[i], label[i % 3]);
+        }
+    }
+};
+
+TEST_F(StreamingKMeansTest, ClustersSmallBlocksOfAPointFile)
+{
+    PointFileBlockSource<double, 2> source(pointsPath, 32);
+    StreamingKMeans<double, 2> kmeans(3, 1e-6, &source);
+    std::vector<CentroidPoint<double, 2>> initial(3);
+    for (int k = 0; k < 3; ++k)
+    {
+        initial[k].coordinates = points[k].coordinates;
+    }
+    kmeans.setCentroids(initial);
+    kmeans.fit();
+    kmeans.writeLabels(labelsPath);
+
+    EXPECT_EQ(kmeans.getNumPoints(), 300);
+    EXPECT_LE(kmeans.getIterations(), 3);
+    expectGroupLabels();
+
+    std::array<double, 2> mean = {0, 0};
+    for (int i = 1; i < 300; i += 3)
+    {
+        mean[0] += points[i].coordinates[0] / 100;
+        mean[1] += points[i].coordinates[1] / 100;
+    }
+    const auto centroids = kmeans.getCentroids();
+    EXPECT_NEAR(centroids[1].coordinates[0], mean[0], 1e-9);
+    EXPECT_NEAR(centroids[1].coordinates[1], mean[1], 1e-9);
+}
+
+TEST_F(StreamingKMeansTest, CSVBlocksMatchThePointFile)
+{
+    CSVBlockSource<double, 2> csv(csvPath, 100);
+    PointFileBlockSource<double, 2> file(pointsPath, 100);
+    std::vector<double> csvValues, fileValues, block;
+    while (std::size_t count = csv.read(block))
+    {
+        EXPECT_EQ(block.size(), 2 * count);
+        csvValues.insert(csvValues.end(), block.begin(), block.end());
+    }
+    while (file.read(block))
+    {
+        fileValues.insert(fileValues.end(), block.begin(), block.end());
+    }
+    EXPECT_EQ(csvValues.size(), 600);
+    EXPECT_EQ(csvValues, fileValues);
+
+    // A new pass starts over, header included
+    csv.rewind();
+    EXPECT_GT(csv.read(block), 0);
+    EXPECT_DOUBLE_EQ(block[0], points[0].coordinates[0]);
+}
+
+TEST_F(StreamingKMeansTest, SampledCentroidsFromCSV)
+{
+    CSVBlockSource<double, 2> source(csvPath, 1000);
+
+    // Sampled centroids can fall in the same group, a few seeds must find the groups
+    double best = std::numeric_limits<double>::max();
+    for (unsigned int seed = 0; seed < 5; ++seed)
+    {
+        StreamingKMeans<double, 2> kmeans(3, 1e-6, &source);
+        kmeans.fit(seed);
+        kmeans.writeLabels(labelsPath);
+        EXPECT_EQ(kmeans.getNumPoints(), 300);
+        best = std::min(best, kmeans.getInertia());
+    }
+    EXPECT_LT(best, 300.0);
+}
+
+// The sample holds distinct points of the dataset, with their positions as ids
+TEST_F(StreamingKMeansTest, SamplesPointsOfTheDataset)
+{
+    PointFileBlockSource<double, 2> source(pointsPath, 32);
+    StreamingKMeans<double, 2> kmeans(3, 1e-6, &source);
+
+    const std::vector<Point<double, 2>> sample = kmeans.samplePoints(50, 1);
+    ASSERT_EQ(sample.size(), 50);
+    std::set<int> ids;
+    for (const auto &point : sample)
+    {
+        ASSERT_GE(point.id, 0);
+        ASSERT_LT(point.id, 300);
+        EXPECT_EQ(point.coordinates, points[point.id].coordinates);
+        ids.insert(point.id);
+    }
+    EXPECT_EQ(ids.size(), 50);
+    EXPECT_EQ(kmeans.samplePoints(1000, 1).size(), 300);
+}
+
+// k-means++ on a sample gives one centroid per group
+TEST_F(StreamingKMeansTest, KMeansPlusPlusOnASample)
+{
+    PointFileBlockSource<double, 2> source(pointsPath, 32);
+    StreamingKMeans<double, 2> kmeans(3, 1e-6, &source);
+    std::vector<CentroidPoint<double, 2>> initial;
+    KMeansPlusPlus<2>(kmeans.samplePoints(100, 3), 3).findCentroid(initial);
+    kmeans.setCentroids(initial);
+    kmeans.fit();
+    kmeans.writeLabels(labelsPath);
+    expectGroupLabels();
+}
+
+TEST_F(StreamingKMeansTest, RejectsInvalidInput)
+{
+    CSVBlockSource<double, 2> source(csvPath, 1000);
+    EXPECT_THROW((StreamingKMeans<double, 2>(0, 1e-6, &source)), std::invalid_argument);
+
+    StreamingKMeans<double, 2> kmeans(301, 1e-6, &source);
+    EXPECT_THROW(kmeans.fit(0), std::runtime_error);
+
+    std::ofstream(csvPath, std::ios::app) << "1,2,3\n";
+    CSVBlockSource<double, 2> ragged(csvPath, 1000);
+    std::vector<double> block;
+    EXPECT_THROW(while (ragged.read(block)) {}, std::runtime_error);
+}
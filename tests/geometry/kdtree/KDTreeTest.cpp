@@ -56,3 +56,33 @@ TEST_F(KdTreeTest, ClearTree)
     tree.~KdTree();
     EXPECT_EQ(tree.getRoot(), nullptr);
 }
+
+// Test the radius search against a linear scan
+TEST_F(KdTreeTest, RadiusSearch)
+{
+    std::vector<Point<double, 2>> points;
+    for (int i = 0; i < 200; ++i)
+    {
+        points.push_back(Point<double, 2>({(i * 37 % 101) * 0.1, (i * 59 % 97) * 0.1}, -1));
+    }
+    const std::vector<Point<double, 2>> original = points;
+    KdTree<double, 2> tree(points);
+
+    const std::array<double, 2> center = {4.0, 5.0};
+    std::vector<const Point<double, 2> *> found;
+    tree.radiusSearch(center, 2.5, found);
+
+    std::size_t expected = 0;
+    for (const auto &p : original)
+    {
+        expected += std::hypot(p.coordinates[0] - center[0], p.coordinates[1] - center[1]) <= 2.5;
+    }
+    EXPECT_EQ(found.size(), expected);
+    for (const auto *p : found)
+    {
+        EXPECT_LE(std::hypot(p->coordinates[0] - center[0], p->coordinates[1] - center[1]), 2.5);
+    }
+
+    tree.radiusSearch({100.0, 100.0}, 1.0, found);
+    EXPECT_TRUE(found.empty());
+}
@@ -0,0 +1,35 @@
+#ifndef GRID_MESH_HPP
+#define GRID_MESH_HPP
+
+#include "geometry/mesh/Mesh.hpp"
+
+/**
+ * \brief Builds a flat grid of (size x size) unit squares, each split in two triangles.
+ *
+ * Vertex `y * (size + 1) + x` is at (x, y, 0); faces `2 * (y * size + x)` and the next one
+ * cover the square with lower-left corner (x, y).
+ *
+ * \param mesh The mesh the vertices and faces are added to.
+ * \param size The number of squares per side.
+ */
+inline void buildGridMesh(Mesh &mesh, int size)
+{
+    for (int y = 0; y <= size; ++y)
+    {
+        for (int x = 0; x <= size; ++x)
+        {
+            mesh.addVertex(Point<double, 3>({double(x), double(y), 0.0}, y * (size + 1) + x));
+        }
+    }
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            VertId v0 = y * (size + 1) + x;
+            mesh.addFace(Face({v0, v0 + 1, v0 + size + 2}, mesh.getVertices(), mesh.numFaces()));
+            mesh.addFace(Face({v0, v0 + size + 2, v0 + size + 1}, mesh.getVertices(), mesh.numFaces()));
+        }
+    }
+}
+
+#endif // GRID_MESH_HPP
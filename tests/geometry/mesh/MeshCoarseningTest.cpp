@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include "geometry/mesh/MeshCoarsening.hpp"
+#include "GridMesh.hpp"
+
+class MeshCoarseningTest : public ::testing::Test
+{
+protected:
+    static constexpr int gridSize = 16;
+    Mesh mesh;
+
+    void SetUp() override
+    {
+        buildGridMesh(mesh, gridSize);
+        mesh.buildFaceAdjacency();
+    }
+};
+
+// Every face belongs to a super-face, and super-faces keep the total area
+TEST_F(MeshCoarseningTest, CoarsenPreservesAreaAndMapsEveryFace)
+{
+    std::vector<FaceId> parent;
+    Mesh coarse = MeshCoarsening::coarsen(mesh, parent);
+
+    ASSERT_EQ(parent.size(), mesh.numFaces());
+    EXPECT_LT(coarse.numFaces(), mesh.numFaces());
+    EXPECT_GE(2 * coarse.numFaces(), mesh.numFaces());
+
+    std::vector<double> childArea(coarse.numFaces(), 0.0);
+    for (FaceId f = 0; f < mesh.numFaces(); ++f)
+    {
+        ASSERT_LT(parent[f], coarse.numFaces());
+        childArea[parent[f]] += mesh.getFace(f).area;
+    }
+    for (FaceId c = 0; c < coarse.numFaces(); ++c)
+    {
+        EXPECT_NEAR(coarse.getFace(c).area, childArea[c], 1e-12);
+        EXPECT_EQ(coarse.getFace(c).baricenter.id, c);
+        EXPECT_FALSE(coarse.getFaceAdjacencyAt(c).empty());
+    }
+}
+
+// The hierarchy stops at the target size and chains the parent maps
+TEST_F(MeshCoarseningTest, HierarchyReachesTargetSize)
+{
+    std::vector<Mesh> levels;
+    std::vector<std::vector<FaceId>> parents;
+    MeshCoarsening::buildHierarchy(mesh, 50, levels, parents);
+
+    ASSERT_FALSE(levels.empty());
+    ASSERT_EQ(levels.size(), parents.size());
+    EXPECT_LE(levels.back().numFaces(), 50);
+
+    EXPECT_EQ(parents[0].size(), mesh.numFaces());
+    for (size_t l = 1; l < levels.size(); ++l)
+    {
+        EXPECT_EQ(parents[l].size(), levels[l - 1].numFaces());
+    }
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "geometry/mesh/MeshExporter.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+class MeshExporterTest : public ::testing::Test
+{
+protected:
+    std::string objPath = "test_export_mesh.obj";
+    std::string outPath = "test_export_out";
+    std::unique_ptr<Mesh> mesh;
+
+    // A strip of triangles, with clusters alternating between two faces
+    void SetUp() override
+    {
+        std::ofstream objFile(objPath);
+        for (int x = 0; x <= 4; ++x)
+        {
+            objFile << "v " << x << " 0 0\nv " << x + 0.5 << " 1 0\n";
+        }
+        for (int x = 0; x < 4; ++x)
+        {
+            objFile << "f " << 2 * x + 1 << " " << 2 * x + 3 << " " << 2 * x + 2 << "\n";
+        }
+        objFile.close();
+
+        mesh = std::make_unique<Mesh>(objPath);
+        for (FaceId f = 0; f < 4; ++f)
+        {
+            mesh->setFaceCluster(f, f % 2);
+        }
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(objPath);
+        std::filesystem::remove(outPath);
+    }
+
+    std::string readFile() const
+    {
+        std::ifstream in(outPath, std::ios::binary);
+        std::ostringstream content;
+        content << in.rdbuf();
+        return content.str();
+    }
+};
+
+TEST_F(MeshExporterTest, WritesOneGroupPerCluster)
+{
+    ASSERT_TRUE(MeshExporter::writeGroupedObj(*mesh, outPath));
+    const std::string content = readFile();
+    EXPECT_NE(content.find("v 0.5 1 0\n"), std::string::npos);
+    EXPECT_NE(content.find("\ng cluster_0\nf 1 3 2\nf 5 7 6\n"), std::string::npos);
+    EXPECT_NE(content.find("\ng cluster_1\nf 3 5 4\nf 7 9 8\n"), std::string::npos);
+    EXPECT_EQ(content.find("g cluster_0", content.find("g cluster_0") + 1), std::string::npos);
+}
+
+TEST_F(MeshExporterTest, WritesTheFacesOfOneCluster)
+{
+    ASSERT_TRUE(MeshExporter::writeObj(*mesh, outPath, 1));
+    const std::string content = readFile();
+    EXPECT_NE(content.find("f 3 5 4\nf 7 9 8\n"), std::string::npos);
+    EXPECT_EQ(content.find("f 1 3 2"), std::string::npos);
+}
+
+TEST_F(MeshExporterTest, WritesBinaryPlyWithLabels)
+{
+    ASSERT_TRUE(MeshExporter::writePly(*mesh, outPath));
+    const std::string content = readFile();
+    const std::string endHeader = "end_header\n";
+    const std::size_t bodyStart = content.find(endHeader) + endHeader.size();
+    ASSERT_NE(content.find("element vertex 10\n"), std::string::npos);
+    ASSERT_NE(content.find("element face 4\n"), std::string::npos);
+    ASSERT_NE(content.find("property int label\n"), std::string::npos);
+    ASSERT_EQ(content.size() - bodyStart, 10 * 3 * sizeof(double) + 4 * (1 + 4 * sizeof(std::int32_t)));
+
+    const char *faces = content.data() + bodyStart + 10 * 3 * sizeof(double);
+    for (int f = 0; f < 4; ++f)
+    {
+        const char *record = faces + f * (1 + 4 * sizeof(std::int32_t));
+        std::int32_t values[4];
+        std::memcpy(values, record + 1, sizeof(values));
+        EXPECT_EQ(record[0], 3);
+        EXPECT_EQ(values[0], 2 * f);
+        EXPECT_EQ(values[3], f % 2);
+    }
+}
+
+TEST_F(MeshExporterTest, SegFileRoundTrip)
+{
+    mesh->reorderSpatially();
+    ASSERT_TRUE(MeshExporter::writeSeg(*mesh, outPath));
+    EXPECT_EQ(readFile(), "0\n1\n0\n1\n");
+
+    std::filesystem::rename(outPath, outPath + ".seg");
+    Mesh loaded(objPath);
+    EXPECT_EQ(loaded.createSegmentationFromSegFile(outPath + ".seg"), 2);
+    std::filesystem::remove(outPath + ".seg");
+    for (FaceId f = 0; f < 4; ++f)
+    {
+        EXPECT_EQ(loaded.getFaceCluster(f), f % 2);
+    }
+}
+
+// The exports of a reordered mesh are the same, vertices included
+TEST_F(MeshExporterTest, ReorderedMeshExportsTheSameFiles)
+{
+    ASSERT_TRUE(MeshExporter::writeGroupedObj(*mesh, outPath));
+    const std::string obj = readFile();
+    ASSERT_TRUE(MeshExporter::writePly(*mesh, outPath));
+    const std::string ply = readFile();
+
+    mesh->reorderSpatially();
+    ASSERT_NE(mesh->getOriginalVertexId(1), 1);
+    ASSERT_TRUE(MeshExporter::writeGroupedObj(*mesh, outPath));
+    EXPECT_EQ(readFile(), obj);
+    ASSERT_TRUE(MeshExporter::writePly(*mesh, outPath));
+    EXPECT_EQ(readFile(), ply);
+}
+
+TEST_F(MeshExporterTest, FailsOnInvalidPath)
+{
+    EXPECT_FALSE(MeshExporter::writeGroupedObj(*mesh, "missing_directory/out.obj"));
+    EXPECT_FALSE(MeshExporter::writePly(*mesh, "missing_directory/out.ply"));
+}
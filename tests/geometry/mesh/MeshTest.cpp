@@ -2,6 +2,9 @@
 #include "geometry/mesh/Mesh.hpp"
 #include <filesystem>
 #include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
 
 class MeshTest : public ::testing::Test
 {
@@ -30,7 +33,29 @@ protected:
 TEST_F(MeshTest, LoadMeshFromObj)
 {
     EXPECT_EQ(mesh->getMeshVertices().size(), 3);
-    EXPECT_EQ(mesh->getMeshFaces().size(), 1);
+    EXPECT_EQ(mesh->numFaces(), 1);
+}
+
+TEST_F(MeshTest, FaceAttributes)
+{
+    Span<const VertId> vertices = mesh->getFaceVertices(0);
+    ASSERT_EQ(vertices.size(), 3);
+    EXPECT_EQ(vertices[0], 0);
+    EXPECT_EQ(vertices[1], 1);
+    EXPECT_EQ(vertices[2], 2);
+    EXPECT_DOUBLE_EQ(mesh->getFaceArea(0), 0.5);
+    EXPECT_DOUBLE_EQ(mesh->getFaceNormal(0)[2], 1.0);
+    EXPECT_DOUBLE_EQ(mesh->getFaceBaricenter(0)[0], 1.0 / 3);
+    EXPECT_DOUBLE_EQ(mesh->getFaceBaricenter(0)[1], 1.0 / 3);
+
+    // The attributes computed on the flat arrays match the ones of a Face
+    Face face({0, 1, 2}, mesh->getVertices(), 0);
+    Face copy = mesh->getFace(0);
+    EXPECT_EQ(copy.vertices, face.vertices);
+    EXPECT_EQ(copy.area, face.area);
+    EXPECT_EQ(copy.normal.coordinates, face.normal.coordinates);
+    EXPECT_EQ(copy.baricenter.coordinates, face.baricenter.coordinates);
+    EXPECT_EQ(copy.baricenter.id, 0);
 }
 
 TEST_F(MeshTest, CreateSegmentationFromSegFile)
@@ -46,7 +71,189 @@ TEST_F(MeshTest, CreateSegmentationFromSegFile)
 TEST_F(MeshTest, BuildFaceAdjacency)
 {
     mesh->buildFaceAdjacency();
-    EXPECT_FALSE(mesh->getFaceAdjacency().empty());
+    EXPECT_TRUE(mesh->hasFaceAdjacency());
+}
+
+TEST_F(MeshTest, VertexAndEdgeAdjacency)
+{
+    // A 4x4 grid of squares, each split in two triangles
+    const int size = 4;
+    Mesh grid;
+    for (int y = 0; y <= size; ++y)
+    {
+        for (int x = 0; x <= size; ++x)
+        {
+            grid.addVertex(Point<double, 3>({double(x), double(y), 0.0}, y * (size + 1) + x));
+        }
+    }
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            VertId v0 = y * (size + 1) + x;
+            grid.addFace(Face({v0, v0 + 1, v0 + size + 2}, grid.getVertices(), grid.numFaces()));
+            grid.addFace(Face({v0, v0 + size + 2, v0 + size + 1}, grid.getVertices(), grid.numFaces()));
+        }
+    }
+
+    // Brute force: faces sharing at least one (vertex mode) or two (edge mode) vertices
+    auto sharedVertices = [&](FaceId f, FaceId g)
+    {
+        int shared = 0;
+        for (VertId v : grid.getFaceVertices(f))
+        {
+            for (VertId w : grid.getFaceVertices(g))
+            {
+                shared += v == w;
+            }
+        }
+        return shared;
+    };
+
+    for (AdjacencyMode mode : {AdjacencyMode::VERTEX, AdjacencyMode::EDGE})
+    {
+        grid.setAdjacencyMode(mode);
+        EXPECT_FALSE(grid.hasFaceAdjacency());
+        grid.buildFaceAdjacency();
+        ASSERT_TRUE(grid.hasFaceAdjacency());
+
+        for (FaceId f = 0; f < grid.numFaces(); ++f)
+        {
+            std::vector<FaceId> expected;
+            for (FaceId g = 0; g < grid.numFaces(); ++g)
+            {
+                if (g != f && sharedVertices(f, g) >= (mode == AdjacencyMode::EDGE ? 2 : 1))
+                {
+                    expected.push_back(g);
+                }
+            }
+            Span<const FaceId> neighbors = grid.getFaceAdjacencyAt(f);
+            EXPECT_EQ(std::vector<FaceId>(neighbors.begin(), neighbors.end()), expected);
+            if (mode == AdjacencyMode::EDGE)
+            {
+                EXPECT_LE(neighbors.size(), 3);
+            }
+        }
+    }
+}
+
+TEST_F(MeshTest, LandmarksAreKeptPerAdjacencyMode)
+{
+    mesh->setLandmarks({0}, {{0.0}});
+    EXPECT_EQ(mesh->getLandmarkFaces().size(), 1);
+
+    mesh->setAdjacencyMode(AdjacencyMode::EDGE);
+    EXPECT_TRUE(mesh->getLandmarkFaces().empty());
+    EXPECT_TRUE(mesh->getLandmarkDistances().empty());
+
+    mesh->setAdjacencyMode(AdjacencyMode::VERTEX);
+    EXPECT_EQ(mesh->getLandmarkFaces().size(), 1);
+}
+
+TEST_F(MeshTest, LandmarksAreDroppedWithTheAdjacency)
+{
+    mesh->buildFaceAdjacency();
+    mesh->setLandmarks({0}, {std::vector<double>(mesh->numFaces(), 0.0)});
+    mesh->setFaceAdjacency(std::vector<std::vector<FaceId>>(mesh->numFaces()));
+    EXPECT_TRUE(mesh->getLandmarkFaces().empty());
+
+    mesh->setLandmarks({0}, {std::vector<double>(mesh->numFaces(), 0.0)});
+    mesh->addFace(Face({0, 1, 2}, mesh->getVertices(), mesh->numFaces()));
+    EXPECT_TRUE(mesh->getLandmarkFaces().empty());
+    EXPECT_TRUE(mesh->getLandmarkDistances().empty());
+}
+
+TEST_F(MeshTest, ReorderSpatiallyKeepsFileOrder)
+{
+    // A strip of triangles written in a shuffled order
+    const int size = 16;
+    std::string stripPath = "test_strip.obj";
+    std::ofstream objFile(stripPath);
+    for (int x = 0; x <= size; ++x)
+    {
+        objFile << "v " << x << " 0 0\nv " << x << " 1 0\n";
+    }
+    for (int i = 0; i < size; ++i)
+    {
+        const int x = (i * 7) % size;
+        objFile << "f " << 2 * x + 1 << " " << 2 * x + 3 << " " << 2 * x + 2 << "\n";
+    }
+    objFile.close();
+
+    Mesh strip(stripPath);
+    Mesh reordered(stripPath);
+    strip.buildFaceAdjacency();
+    reordered.buildFaceAdjacency();
+    reordered.setLandmarks({0}, {std::vector<double>(size, 0.0)});
+    reordered.setFaceCluster(0, 7);
+    reordered.reorderSpatially();
+
+    // Same faces, now sorted along the strip, with the adjacency and the cluster remapped
+    ASSERT_EQ(reordered.numFaces(), size);
+    std::vector<FaceId> fileOrder(size);
+    for (FaceId f = 0; f < size; ++f)
+    {
+        const FaceId original = reordered.getOriginalFaceId(f);
+        fileOrder[original] = f;
+        EXPECT_DOUBLE_EQ(reordered.getFaceBaricenter(f)[0], strip.getFaceBaricenter(original)[0]);
+        if (f > 0)
+        {
+            EXPECT_LT(reordered.getFaceBaricenter(f - 1)[0], reordered.getFaceBaricenter(f)[0]);
+        }
+        for (int c = 0; c < 3; ++c)
+        {
+            const VertId v = reordered.getFaceVertices(f)[c], w = strip.getFaceVertices(original)[c];
+            EXPECT_EQ(reordered.getMeshVertices()[v].coordinates, strip.getMeshVertices()[w].coordinates);
+        }
+
+        Span<const FaceId> neighbors = strip.getFaceAdjacencyAt(original);
+        Span<const FaceId> reorderedNeighbors = reordered.getFaceAdjacencyAt(f);
+        std::vector<FaceId> mapped;
+        for (FaceId g : reorderedNeighbors)
+        {
+            mapped.push_back(reordered.getOriginalFaceId(g));
+        }
+        std::sort(mapped.begin(), mapped.end());
+        EXPECT_EQ(mapped, std::vector<FaceId>(neighbors.begin(), neighbors.end()));
+        EXPECT_TRUE(std::is_sorted(reorderedNeighbors.begin(), reorderedNeighbors.end()));
+    }
+    EXPECT_EQ(reordered.getFaceCluster(fileOrder[0]), 7);
+    EXPECT_EQ(reordered.getLandmarkFaces(), std::vector<FaceId>{fileOrder[0]});
+
+    // The .seg lines are read in file order
+    std::ofstream segFile(testSegPath);
+    for (int i = 0; i < size; ++i)
+    {
+        segFile << i << "\n";
+    }
+    segFile.close();
+    reordered.createSegmentationFromSegFile(testSegPath);
+    for (FaceId f = 0; f < size; ++f)
+    {
+        EXPECT_EQ(reordered.getFaceCluster(f), reordered.getOriginalFaceId(f));
+    }
+
+    // The exported faces and their vertex indices are in file order
+    std::string outPath = "exported_reordered.obj";
+    reordered.exportToGroupedObj(outPath);
+    std::ifstream exported(outPath);
+    std::string line;
+    int face = 0;
+    while (std::getline(exported, line))
+    {
+        if (line.rfind("f ", 0) == 0)
+        {
+            std::istringstream iss(line.substr(2));
+            VertId v;
+            iss >> v;
+            EXPECT_EQ(v - 1, strip.getFaceVertices(face)[0]);
+            face++;
+        }
+    }
+    EXPECT_EQ(face, size);
+
+    std::filesystem::remove(outPath);
+    std::filesystem::remove(stripPath);
 }
 
 TEST_F(MeshTest, ExportToObj)
@@ -64,3 +271,115 @@ TEST_F(MeshTest, ExportToGroupedObj)
     EXPECT_TRUE(std::filesystem::exists(outPath));
     std::filesystem::remove(outPath);
 }
+
+TEST_F(MeshTest, BinaryCacheRoundTrip)
+{
+    const std::filesystem::path cacheDir = std::filesystem::temp_directory_path() / "kmeans_mesh_cache_test";
+    std::filesystem::remove_all(cacheDir);
+    Mesh::setCacheDirectory(cacheDir.string());
+
+    std::string quadPath = "test_quad.obj";
+    std::ofstream objFile(quadPath);
+    objFile << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3\nf 1 3 4\n";
+    objFile.close();
+
+    // The first load parses the OBJ and writes the cache, then the adjacency is added to it
+    Mesh parsed(quadPath);
+    parsed.buildFaceAdjacency();
+    ASSERT_EQ(std::distance(std::filesystem::directory_iterator(cacheDir), std::filesystem::directory_iterator()), 1);
+
+    // The second load comes from the cache, with the adjacency
+    Mesh cached(quadPath);
+    ASSERT_EQ(cached.numFaces(), parsed.numFaces());
+    ASSERT_EQ(cached.getMeshVertices().size(), parsed.getMeshVertices().size());
+    EXPECT_TRUE(cached.hasFaceAdjacency());
+    for (FaceId f = 0; f < parsed.numFaces(); ++f)
+    {
+        EXPECT_EQ(cached.getFace(f).vertices, parsed.getFace(f).vertices);
+        EXPECT_DOUBLE_EQ(cached.getFace(f).area, parsed.getFace(f).area);
+        EXPECT_EQ(cached.getFace(f).baricenter.id, f);
+        for (int d = 0; d < 3; ++d)
+        {
+            EXPECT_DOUBLE_EQ(cached.getFace(f).baricenter.coordinates[d], parsed.getFace(f).baricenter.coordinates[d]);
+            EXPECT_DOUBLE_EQ(cached.getFace(f).normal.coordinates[d], parsed.getFace(f).normal.coordinates[d]);
+        }
+        Span<const FaceId> cachedNeighbors = cached.getFaceAdjacencyAt(f), parsedNeighbors = parsed.getFaceAdjacencyAt(f);
+        EXPECT_EQ(std::vector<FaceId>(cachedNeighbors.begin(), cachedNeighbors.end()), std::vector<FaceId>(parsedNeighbors.begin(), parsedNeighbors.end()));
+    }
+
+    // A corrupted cache file fails its checksum and the OBJ is parsed again
+    const std::filesystem::path cacheFile = std::filesystem::directory_iterator(cacheDir)->path();
+    {
+        std::fstream cache(cacheFile, std::ios::in | std::ios::out | std::ios::binary);
+        cache.seekp(std::filesystem::file_size(cacheFile) - 16);
+        cache.put('\x7f');
+    }
+    Mesh reparsed(quadPath);
+    EXPECT_FALSE(reparsed.hasFaceAdjacency());
+    ASSERT_EQ(reparsed.numFaces(), parsed.numFaces());
+    for (FaceId f = 0; f < parsed.numFaces(); ++f)
+    {
+        EXPECT_EQ(reparsed.getFace(f).vertices, parsed.getFace(f).vertices);
+    }
+
+    // A modified source file is parsed again
+    objFile.open(quadPath);
+    objFile << "v 0 0 0\nv 2 0 0\nv 2 2 0\nv 0 2 0\nf 1 2 3\nf 1 3 4\n";
+    objFile.close();
+    Mesh modified(quadPath);
+    EXPECT_DOUBLE_EQ(modified.getFace(0).area, 2.0);
+
+    Mesh::setCacheDirectory("");
+    std::filesystem::remove(quadPath);
+    std::filesystem::remove_all(cacheDir);
+}
+
+// The cache keeps the adjacency of every mode built, and is only written when it misses one
+TEST_F(MeshTest, BinaryCacheKeepsTheAdjacencyModes)
+{
+    const std::filesystem::path cacheDir = std::filesystem::temp_directory_path() / "kmeans_mesh_cache_modes_test";
+    std::filesystem::remove_all(cacheDir);
+    Mesh::setCacheDirectory(cacheDir.string());
+
+    // Faces 1 and 3 only share a vertex
+    std::string stripPath = "test_strip.obj";
+    std::ofstream objFile(stripPath);
+    objFile << "v 0 0 0\nv 1 0 0\nv 2 0 0\nv 0 1 0\nv 1 1 0\nv 2 1 0\nf 1 2 5\nf 1 5 4\nf 2 3 6\nf 2 6 5\n";
+    objFile.close();
+
+    const auto neighbors = [](const Mesh &m, FaceId f)
+    {
+        Span<const FaceId> adjacent = m.getFaceAdjacencyAt(f);
+        return std::vector<FaceId>(adjacent.begin(), adjacent.end());
+    };
+
+    Mesh parsed(stripPath);
+    EXPECT_THROW(parsed.getFaceAdjacencyAt(0), std::out_of_range);
+    parsed.buildFaceAdjacency();
+    const std::vector<FaceId> vertexNeighbors = neighbors(parsed, 1);
+    parsed.setAdjacencyMode(AdjacencyMode::EDGE);
+    parsed.buildFaceAdjacency();
+    const std::vector<FaceId> edgeNeighbors = neighbors(parsed, 1);
+    ASSERT_NE(vertexNeighbors, edgeNeighbors);
+
+    // Both modes come from the cache, which is not written again
+    const std::filesystem::path cacheFile = std::filesystem::directory_iterator(cacheDir)->path();
+    const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(cacheFile) - std::chrono::hours(1);
+    std::filesystem::last_write_time(cacheFile, writeTime);
+
+    Mesh cached(stripPath);
+    ASSERT_TRUE(cached.hasFaceAdjacency());
+    EXPECT_EQ(neighbors(cached, 1), vertexNeighbors);
+    cached.setAdjacencyMode(AdjacencyMode::EDGE);
+    EXPECT_FALSE(cached.hasFaceAdjacency());
+    cached.buildFaceAdjacency();
+    EXPECT_EQ(neighbors(cached, 1), edgeNeighbors);
+    cached.setAdjacencyMode(AdjacencyMode::VERTEX);
+    cached.buildFaceAdjacency();
+    EXPECT_EQ(neighbors(cached, 1), vertexNeighbors);
+    EXPECT_EQ(std::filesystem::last_write_time(cacheFile), writeTime);
+
+    Mesh::setCacheDirectory("");
+    std::filesystem::remove(stripPath);
+    std::filesystem::remove_all(cacheDir);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "geometry/mesh/ObjReader.hpp"
+#include <sstream>
+
+class ObjReaderTest : public ::testing::Test
+{
+protected:
+    static ObjData parse(const std::string &content, std::size_t minChunkSize = OBJ_MIN_CHUNK_SIZE)
+    {
+        return ObjReader::parse(content.data(), content.size(), minChunkSize);
+    }
+};
+
+TEST_F(ObjReaderTest, ReadsVerticesAndTriangles)
+{
+    ObjData obj = parse("# comment\nv 0 0 0\nv 1.5 0 0\nv 0 -2e-1 +3\nvn 0 0 1\nf 1 2 3\n");
+    ASSERT_EQ(obj.numVertices(), 3);
+    ASSERT_EQ(obj.numTriangles(), 1);
+    EXPECT_DOUBLE_EQ(obj.vertices[3], 1.5);
+    EXPECT_DOUBLE_EQ(obj.vertices[7], -0.2);
+    EXPECT_DOUBLE_EQ(obj.vertices[8], 3.0);
+    EXPECT_EQ(obj.triangles, (std::vector<VertId>{0, 1, 2}));
+    EXPECT_EQ(obj.groups, (std::vector<std::string>{OBJ_DEFAULT_GROUP}));
+}
+
+TEST_F(ObjReaderTest, TriangulatesPolygonsAsFans)
+{
+    ObjData obj = parse("v 0 0 0\r\nv 1 0 0\r\nv 1 1 0\r\nv 0 1 0\r\nv -1 1 0\r\nf 1/1/1 2/2/2 3//3 4 5\r\n");
+    ASSERT_EQ(obj.numTriangles(), 3);
+    EXPECT_EQ(obj.triangles, (std::vector<VertId>{0, 1, 2, 0, 2, 3, 0, 3, 4}));
+}
+
+TEST_F(ObjReaderTest, ResolvesNegativeIndices)
+{
+    ObjData obj = parse("v 0 0 0\nv 1 0 0\nv 0 1 0\nf -3 -2 -1\nv 1 1 0\nf -3 -1 -2\n");
+    EXPECT_EQ(obj.triangles, (std::vector<VertId>{0, 1, 2, 1, 3, 2}));
+}
+
+TEST_F(ObjReaderTest, ReadsGroups)
+{
+    ObjData obj = parse("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\ng first\nf 1 2 3\nf 1 2 3\ng second \ng first\nf 1 2 3\ng empty\n");
+    EXPECT_EQ(obj.groups, (std::vector<std::string>{OBJ_DEFAULT_GROUP, "first"}));
+    EXPECT_EQ(obj.triangleGroups, (std::vector<int>{0, 1, 1, 1}));
+}
+
+TEST_F(ObjReaderTest, ChunksGiveTheSameResult)
+{
+    std::ostringstream content;
+    const int size = 40;
+    for (int y = 0; y <= size; ++y)
+    {
+        for (int x = 0; x <= size; ++x)
+        {
+            content << "v " << x << " " << y << " 0\n";
+        }
+    }
+    for (int y = 0; y < size; ++y)
+    {
+        content << "g row" << y % 3 << "\n";
+        for (int x = 0; x < size; ++x)
+        {
+            const int v = y * (size + 1) + x + 1;
+            content << "f " << v << " " << v + 1 << " " << v + size + 2 << " " << v + size + 1 << "\n";
+        }
+    }
+
+    ObjData whole = parse(content.str());
+    ObjData chunked = parse(content.str(), 64);
+    ASSERT_EQ(whole.numVertices(), (size + 1) * (size + 1));
+    ASSERT_EQ(whole.numTriangles(), 2 * size * size);
+    EXPECT_EQ(chunked.vertices, whole.vertices);
+    EXPECT_EQ(chunked.triangles, whole.triangles);
+    EXPECT_EQ(chunked.groups, (std::vector<std::string>{"row0", "row1", "row2"}));
+    EXPECT_EQ(chunked.triangleGroups, whole.triangleGroups);
+}
+
+TEST_F(ObjReaderTest, RejectsInvalidFiles)
+{
+    EXPECT_THROW(parse("v 0 0\nf 1 1 1\n"), std::runtime_error);
+    EXPECT_THROW(parse("v 0 0 0\nv 1 0 0\nf 1 2 3\n"), std::runtime_error);
+    EXPECT_THROW(parse("v 0 0 0\nf 0 1 1\n"), std::runtime_error);
+    EXPECT_THROW(ObjReader::read("missing_file.obj"), std::runtime_error);
+}
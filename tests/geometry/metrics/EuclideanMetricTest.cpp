@@ -38,3 +38,20 @@ TEST_F(EuclideanMetricTest, DistanceToCalculatesCorrectly)
     Point2D b({3.0, 4.0}, -1);
     EXPECT_DOUBLE_EQ(metric->distanceTo(a, b), 5.0);
 }
+
+// Test that setPoints rebuilds the kd-tree over the new points
+TEST_F(EuclideanMetricTest, SetPointsRebuildsTheTree)
+{
+    metric->setPoints({Point2D({0.0, 0.0}, 0), Point2D({0.0, 1.0}, 1), Point2D({10.0, 0.0}, 2), Point2D({10.0, 1.0}, 3)});
+    std::vector<CentroidPoint<double, 2>> centroids = {CentroidPoint<double, 2>(Point2D({1.0, 0.0}, 0)), CentroidPoint<double, 2>(Point2D({9.0, 0.0}, 1))};
+    metric->setCentroids(centroids);
+    metric->fit_cpu();
+
+    EXPECT_DOUBLE_EQ(centroids[0].coordinates[0], 0.0);
+    EXPECT_DOUBLE_EQ(centroids[1].coordinates[0], 10.0);
+    for (Point2D &p : metric->getPoints())
+    {
+        ASSERT_TRUE(p.centroid);
+        EXPECT_EQ(p.centroid->id, p.id < 2 ? 0 : 1);
+    }
+}
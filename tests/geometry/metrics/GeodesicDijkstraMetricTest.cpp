@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include "geometry/metrics/GeodesicDijkstraMetric.hpp"
+#include "geometry/mesh/Mesh.hpp"
+#include "../mesh/GridMesh.hpp"
+
+class GeodesicDijkstraMetricTest : public ::testing::Test
+{
+protected:
+    static constexpr int gridSize = 12;
+
+    static std::vector<CentroidPoint<double, 3>> initialCentroids()
+    {
+        std::vector<CentroidPoint<double, 3>> centroids;
+        const std::vector<std::array<double, 3>> coords = {{1.0, 1.0, 0.0}, {10.0, 2.0, 0.0}, {6.0, 6.0, 0.0}, {2.0, 10.0, 0.0}, {10.0, 10.0, 0.0}};
+        for (size_t i = 0; i < coords.size(); ++i)
+        {
+            centroids.emplace_back(Point<double, 3>(coords[i], i));
+        }
+        return centroids;
+    }
+};
+
+// The landmark bounds must not change the segmentation
+TEST_F(GeodesicDijkstraMetricTest, LandmarkBoundsGiveSameClusters)
+{
+    Mesh fullMesh, boundedMesh;
+    buildGridMesh(fullMesh, gridSize);
+    buildGridMesh(boundedMesh, gridSize);
+
+    std::vector<CentroidPoint<double, 3>> fullCentroids = initialCentroids();
+    GeodesicDijkstraMetric<double, 3> fullMetric(fullMesh, 0.05, fullMesh.getMeshFacesPoints());
+    fullMetric.setNumLandmarks(0);
+    fullMetric.setCentroids(fullCentroids);
+    fullMetric.fit_cpu();
+
+    std::vector<CentroidPoint<double, 3>> boundedCentroids = initialCentroids();
+    GeodesicDijkstraMetric<double, 3> boundedMetric(boundedMesh, 0.05, boundedMesh.getMeshFacesPoints());
+    boundedMetric.setNumLandmarks(4);
+    boundedMetric.setCentroids(boundedCentroids);
+    boundedMetric.fit_cpu();
+
+    for (FaceId faceId = 0; faceId < fullMesh.numFaces(); ++faceId)
+    {
+        EXPECT_EQ(fullMesh.getFaceCluster(faceId), boundedMesh.getFaceCluster(faceId));
+    }
+}
+
+// The landmark fields are computed once and cached on the mesh
+TEST_F(GeodesicDijkstraMetricTest, LandmarksAreCachedOnMesh)
+{
+    Mesh mesh;
+    buildGridMesh(mesh, gridSize);
+
+    std::vector<CentroidPoint<double, 3>> centroids = initialCentroids();
+    GeodesicDijkstraMetric<double, 3> metric(mesh, 0.05, mesh.getMeshFacesPoints());
+    metric.setNumLandmarks(4);
+    metric.setCentroids(centroids);
+    metric.fit_cpu();
+
+    ASSERT_EQ(mesh.getLandmarkFaces().size(), 4);
+    ASSERT_EQ(mesh.getLandmarkDistances().size(), 4);
+    EXPECT_EQ(mesh.getLandmarkFaces()[0], 0);
+    EXPECT_EQ(mesh.getLandmarkDistances()[0][0], 0.0);
+    EXPECT_EQ(mesh.getLandmarkDistances()[1].size(), mesh.numFaces());
+}
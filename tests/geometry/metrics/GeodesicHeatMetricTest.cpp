@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include "geometry/metrics/GeodesicHeatMetric.hpp"
 #include "geometry/mesh/Mesh.hpp"
+#include "../mesh/GridMesh.hpp"
+#include <chrono>
+#include <algorithm>
 
 class GeodesicHeatMetricTest : public ::testing::Test
 {
@@ -52,3 +55,200 @@ TEST_F(GeodesicHeatMetricTest, ConstructorInitializesCorrectly)
 //         EXPECT_GE(d, 0.0); // Distances should be non-negative
 //     }
 // }
+
+// The operators are written to the on-disk cache and reloaded with the same results
+TEST_F(GeodesicHeatMetricTest, OperatorsAreCachedOnDisk)
+{
+    const std::filesystem::path cacheDir = std::filesystem::temp_directory_path() / "kmeans_heat_cache_test";
+    std::filesystem::remove_all(cacheDir);
+    GeodesicHeatMetric<double, 3>::setCacheDirectory(cacheDir.string());
+    GeodesicHeatMetric<double, 3>::clearMemoryCache();
+
+    Mesh grid;
+    buildGridMesh(grid, 4);
+
+    GeodesicHeatMetric<double, 3> first(grid, 0.05, grid.getMeshFacesPoints());
+    std::vector<double> firstDistances = first.computeDistances(0);
+
+    int cachedFiles = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(cacheDir))
+    {
+        cachedFiles += entry.path().extension() == ".heat";
+    }
+    ASSERT_EQ(cachedFiles, 1);
+
+    // Force the reload from disk instead of the in-memory factorizations
+    GeodesicHeatMetric<double, 3>::clearMemoryCache();
+    GeodesicHeatMetric<double, 3> second(grid, 0.05, grid.getMeshFacesPoints());
+    std::vector<double> secondDistances = second.computeDistances(0);
+
+    ASSERT_EQ(firstDistances.size(), secondDistances.size());
+    for (size_t i = 0; i < firstDistances.size(); ++i)
+    {
+        EXPECT_DOUBLE_EQ(firstDistances[i], secondDistances[i]);
+    }
+
+    GeodesicHeatMetric<double, 3>::setCacheDirectory("");
+    std::filesystem::remove_all(cacheDir);
+}
+
+// The cache keeps the most recently used files within its size bound
+TEST_F(GeodesicHeatMetricTest, CacheEvictsTheLeastRecentlyUsedFiles)
+{
+    const std::filesystem::path cacheDir = std::filesystem::temp_directory_path() / "kmeans_heat_cache_lru_test";
+    std::filesystem::remove_all(cacheDir);
+    GeodesicHeatMetric<double, 3>::setCacheDirectory(cacheDir.string());
+    GeodesicHeatMetric<double, 3>::clearMemoryCache();
+
+    const auto cachedFiles = [&]()
+    {
+        std::vector<std::filesystem::path> files;
+        for (const auto &entry : std::filesystem::directory_iterator(cacheDir))
+        {
+            if (entry.path().extension() == ".heat")
+            {
+                files.push_back(entry.path());
+            }
+        }
+        return files;
+    };
+
+    Mesh small, large;
+    buildGridMesh(small, 3);
+    buildGridMesh(large, 4);
+    GeodesicHeatMetric<double, 3>(small, 0.05, small.getMeshFacesPoints());
+    GeodesicHeatMetric<double, 3>(large, 0.05, large.getMeshFacesPoints());
+    ASSERT_EQ(cachedFiles().size(), 2);
+
+    // A bound of zero keeps only the file just written
+    Mesh other;
+    buildGridMesh(other, 5);
+    GeodesicHeatMetric<double, 3>::setCacheSizeLimit(0);
+    GeodesicHeatMetric<double, 3>(other, 0.05, other.getMeshFacesPoints());
+    std::vector<std::filesystem::path> files = cachedFiles();
+    ASSERT_EQ(files.size(), 1);
+    const std::filesystem::path otherFile = files[0];
+
+    // Room for two files: reading a file marks it as used, the least recently used one is evicted
+    GeodesicHeatMetric<double, 3>::setCacheSizeLimit(HEAT_CACHE_MAX_BYTES);
+    GeodesicHeatMetric<double, 3>::clearMemoryCache();
+    GeodesicHeatMetric<double, 3>(large, 0.05, large.getMeshFacesPoints());
+    files = cachedFiles();
+    ASSERT_EQ(files.size(), 2);
+    const std::filesystem::path largeFile = files[0] == otherFile ? files[1] : files[0];
+    GeodesicHeatMetric<double, 3>::setCacheSizeLimit(std::filesystem::file_size(otherFile) + std::filesystem::file_size(largeFile));
+    std::filesystem::last_write_time(otherFile, std::filesystem::last_write_time(otherFile) - std::chrono::hours(1));
+
+    GeodesicHeatMetric<double, 3>::clearMemoryCache();
+    GeodesicHeatMetric<double, 3>(other, 0.05, other.getMeshFacesPoints());
+    GeodesicHeatMetric<double, 3>(small, 0.05, small.getMeshFacesPoints());
+    files = cachedFiles();
+    EXPECT_EQ(files.size(), 2);
+    EXPECT_NE(std::find(files.begin(), files.end(), otherFile), files.end());
+    EXPECT_EQ(std::find(files.begin(), files.end(), largeFile), files.end());
+
+    GeodesicHeatMetric<double, 3>::setCacheSizeLimit(HEAT_CACHE_MAX_BYTES);
+    GeodesicHeatMetric<double, 3>::setCacheDirectory("");
+    std::filesystem::remove_all(cacheDir);
+}
+
+// The iterative solver converges to the distances of the direct factorizations
+TEST_F(GeodesicHeatMetricTest, IterativeSolverMatchesDirectSolver)
+{
+    Mesh grid;
+    buildGridMesh(grid, 10);
+    GeodesicHeatMetric<double, 3>::setCacheDirectory("");
+
+    GeodesicHeatMetric<double, 3>::setSolverType(HeatSolverType::DIRECT);
+    GeodesicHeatMetric<double, 3> direct(grid, 0.05, grid.getMeshFacesPoints());
+    std::vector<std::vector<double>> directDistances = direct.computeDistancesBatch({0, 57, 199});
+
+    GeodesicHeatMetric<double, 3>::setSolverType(HeatSolverType::ITERATIVE);
+    GeodesicHeatMetric<double, 3> iterative(grid, 0.05, grid.getMeshFacesPoints());
+    std::vector<std::vector<double>> iterativeDistances = iterative.computeDistancesBatch({0, 57, 199});
+    GeodesicHeatMetric<double, 3>::setSolverType(HeatSolverType::AUTO);
+
+    ASSERT_EQ(directDistances.size(), iterativeDistances.size());
+    for (size_t s = 0; s < directDistances.size(); ++s)
+    {
+        ASSERT_EQ(directDistances[s].size(), grid.numFaces());
+        for (size_t i = 0; i < directDistances[s].size(); ++i)
+        {
+            EXPECT_NEAR(directDistances[s][i], iterativeDistances[s][i], 1e-4);
+        }
+    }
+}
+
+// Every column of a batch matches the one-column solve of its starting face
+TEST_F(GeodesicHeatMetricTest, BatchMatchesSingleSourceSolves)
+{
+    Mesh grid;
+    buildGridMesh(grid, 8);
+    GeodesicHeatMetric<double, 3>::setCacheDirectory("");
+    GeodesicHeatMetric<double, 3>::setSolverType(HeatSolverType::DIRECT);
+    GeodesicHeatMetric<double, 3> metric(grid, 0.05, grid.getMeshFacesPoints());
+    GeodesicHeatMetric<double, 3>::setSolverType(HeatSolverType::AUTO);
+
+    // Faces 0 and 1 share an edge: their three source vertices overlap
+    const std::vector<FaceId> startFaces = {0, 1, 45, 127};
+    const std::vector<std::vector<double>> batch = metric.computeDistancesBatch(startFaces);
+    ASSERT_EQ(batch.size(), startFaces.size());
+    for (size_t s = 0; s < startFaces.size(); ++s)
+    {
+        const std::vector<double> single = metric.computeDistances(startFaces[s]);
+        ASSERT_EQ(batch[s].size(), single.size());
+        double largest = 0.0;
+        for (size_t i = 0; i < single.size(); ++i)
+        {
+            EXPECT_NEAR(batch[s][i], single[i], 1e-9 * std::max(1.0, std::abs(single[i])));
+            largest = std::max(largest, single[i]);
+        }
+
+        // The starting face, whose vertices are all sources, is the closest
+        EXPECT_LE(single[startFaces[s]], *std::min_element(single.begin(), single.end()) + 1e-9);
+        EXPECT_GT(largest, 1.0);
+    }
+}
+
+// The warm start of the iterative solver belongs to the batches over the centroids
+TEST_F(GeodesicHeatMetricTest, WarmStartIsKeptPerCentroid)
+{
+    struct WarmMetric : GeodesicHeatMetric<double, 3>
+    {
+        using GeodesicHeatMetric<double, 3>::GeodesicHeatMetric;
+        using GeodesicHeatMetric<double, 3>::warmStart;
+    };
+
+    Mesh grid;
+    buildGridMesh(grid, 8);
+    grid.buildFaceAdjacency();
+    GeodesicHeatMetric<double, 3>::setCacheDirectory("");
+    GeodesicHeatMetric<double, 3>::setSolverType(HeatSolverType::ITERATIVE);
+    WarmMetric metric(grid, 0.05, grid.getMeshFacesPoints());
+    GeodesicHeatMetric<double, 3>::setSolverType(HeatSolverType::AUTO);
+
+    std::vector<CentroidPoint<double, 3>> centroids;
+    for (FaceId faceId : {0, 45, 127})
+    {
+        centroids.emplace_back(grid.getMeshFacesPoints()[faceId]);
+    }
+    metric.setCentroids(centroids);
+    metric.setup();
+    ASSERT_EQ(metric.warmStart.poisson.cols(), 3);
+    const std::vector<double> poisson(metric.warmStart.poisson.data(), metric.warmStart.poisson.data() + metric.warmStart.poisson.size());
+
+    // Neither a single source nor a batch of other faces replaces the solutions of the centroids
+    metric.computeDistances(60);
+    metric.computeDistancesBatch({1, 2});
+    ASSERT_EQ(metric.warmStart.poisson.size(), poisson.size());
+    EXPECT_TRUE(std::equal(poisson.begin(), poisson.end(), metric.warmStart.poisson.data()));
+
+    // The next iteration starts from them and still matches a cold solve
+    const std::vector<std::vector<double>> warm = metric.computeDistancesBatch({1, 45, 127});
+    EXPECT_EQ(metric.warmStart.poisson.cols(), 3);
+    const std::vector<double> cold = metric.computeDistances(1);
+    for (size_t i = 0; i < cold.size(); ++i)
+    {
+        EXPECT_NEAR(warm[0][i], cold[i], 1e-4);
+    }
+}
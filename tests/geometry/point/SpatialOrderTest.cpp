@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include "geometry/point/SpatialOrder.hpp"
+#include <algorithm>
+
+TEST(SpatialOrderTest, MortonKeysInterleaveCoordinates)
+{
+    // The corners of a square: the curve visits (0,0), (0,1), (1,0), (1,1)
+    const std::vector<double> coordinates = {1, 1, 0, 0, 1, 0, 0, 1};
+    std::vector<std::uint64_t> keys = SpatialOrder::mortonKeys(coordinates.data(), 4, 2);
+    EXPECT_LT(keys[1], keys[3]);
+    EXPECT_LT(keys[3], keys[2]);
+    EXPECT_LT(keys[2], keys[0]);
+
+    EXPECT_EQ(SpatialOrder::mortonOrder(coordinates.data(), 4, 2), (std::vector<std::uint32_t>{1, 3, 2, 0}));
+}
+
+TEST(SpatialOrderTest, ReorderPointsKeepsTheirIds)
+{
+    std::vector<Point<double, 3>> points;
+    for (int i = 0; i < 1000; ++i)
+    {
+        points.emplace_back(std::array<double, 3>{double((i * 37) % 101), double((i * 53) % 97), double(i % 7)}, i);
+    }
+    const std::vector<Point<double, 3>> original = points;
+
+    std::vector<std::uint32_t> order = SpatialOrder::reorderPoints(points);
+    ASSERT_EQ(points.size(), original.size());
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        EXPECT_EQ(points[i].id, original[order[i]].id);
+        EXPECT_EQ(points[i].coordinates, original[order[i]].coordinates);
+    }
+
+    std::sort(order.begin(), order.end());
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+        EXPECT_EQ(order[i], i);
+    }
+}
+
+TEST(SpatialOrderTest, DegenerateSets)
+{
+    std::vector<Point<double, 2>> empty;
+    EXPECT_TRUE(SpatialOrder::reorderPoints(empty).empty());
+
+    // Points with the same key keep their order
+    std::vector<Point<double, 2>> same(5, Point<double, 2>(1.0));
+    EXPECT_EQ(SpatialOrder::reorderPoints(same), (std::vector<std::uint32_t>{0, 1, 2, 3, 4}));
+}
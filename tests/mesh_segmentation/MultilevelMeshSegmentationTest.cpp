@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include "mesh_segmentation/MultilevelMeshSegmentation.hpp"
+#include "clustering/CentroidInitializationMethods/SharedEnum.hpp"
+#include "../geometry/mesh/GridMesh.hpp"
+#include <set>
+
+template <class M>
+class MultilevelMeshSegmentationTest : public ::testing::Test
+{
+protected:
+    static constexpr int gridSize = 16;
+    static constexpr int clusters = 4;
+    Mesh mesh;
+
+    void SetUp() override
+    {
+        buildGridMesh(mesh, gridSize);
+        mesh.buildFaceAdjacency();
+        GeodesicHeatMetric<double, 3>::setCacheDirectory("");
+    }
+};
+
+typedef ::testing::Types<EuclideanMetric<double, 3>, GeodesicDijkstraMetric<double, 3>, GeodesicHeatMetric<double, 3>> Metrics;
+TYPED_TEST_SUITE(MultilevelMeshSegmentationTest, Metrics);
+
+// Every face gets one of the segments, and no segment is emptied by the refinement
+TYPED_TEST(MultilevelMeshSegmentationTest, LabelsEveryFace)
+{
+    Mesh &mesh = this->mesh;
+
+    // The grid is coarsened, so the refinement runs
+    std::vector<Mesh> levels;
+    std::vector<std::vector<FaceId>> parents;
+    MeshCoarsening::buildHierarchy(mesh, 64, levels, parents);
+    ASSERT_FALSE(levels.empty());
+
+    MultilevelMeshSegmentation<TypeParam> segmentation(&mesh, this->clusters, 1e-4,
+                                                       static_cast<int>(Enums::CentroidInit::MOSTDISTANT), 0, 64);
+    segmentation.fit();
+
+    std::set<int> segments;
+    for (FaceId f = 0; f < mesh.numFaces(); ++f)
+    {
+        const int label = mesh.getFaceCluster(f);
+        ASSERT_GE(label, 0);
+        ASSERT_LT(label, this->clusters);
+        segments.insert(label);
+    }
+    EXPECT_EQ(segments.size(), this->clusters);
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include "utils/BinaryIO.hpp"
+#include "utils/MappedFile.hpp"
+#include <thread>
+#include <vector>
+
+class BinaryIOTest : public ::testing::Test
+{
+protected:
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "kmeans_binary_io_test";
+
+    void SetUp() override
+    {
+        std::filesystem::remove_all(directory);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(directory);
+    }
+};
+
+// The checksum appended by the writer is verified, and catches a flipped byte
+TEST_F(BinaryIOTest, ChecksumDetectsCorruption)
+{
+    const std::string path = (directory / "values.bin").string();
+    const std::vector<double> values = {1.0, 2.0, 3.0};
+    ASSERT_TRUE(writeFileAtomically(path, [&](std::ofstream &out)
+                                    { writeValues(out, values.data(), values.size()); }));
+
+    {
+        MappedFile file(path);
+        ASSERT_EQ(verifyChecksum(file.data(), file.size()), values.size() * sizeof(double));
+    }
+
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(3);
+        file.put('\x7f');
+    }
+    MappedFile file(path);
+    EXPECT_THROW(verifyChecksum(file.data(), file.size()), std::runtime_error);
+    EXPECT_THROW(verifyChecksum(file.data(), 4), std::runtime_error);
+}
+
+// Concurrent writers of the same file use their own temporary files
+TEST_F(BinaryIOTest, ConcurrentWritersLeaveAValidFile)
+{
+    const std::string path = (directory / "shared.bin").string();
+    EXPECT_NE(uniqueTemporaryPath(path), uniqueTemporaryPath(path));
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t)
+    {
+        writers.emplace_back([&, t]()
+                             {
+            const std::vector<int> values(10000, t);
+            for (int i = 0; i < 20; ++i)
+            {
+                writeFileAtomically(path, [&](std::ofstream &out)
+                                    { writeValues(out, values.data(), values.size()); });
+            } });
+    }
+    for (std::thread &writer : writers)
+    {
+        writer.join();
+    }
+
+    MappedFile file(path);
+    EXPECT_EQ(verifyChecksum(file.data(), file.size()), 10000 * sizeof(int));
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()), 1);
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "utils/CSVUtils.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+class CSVUtilsTest : public ::testing::Test
+{
+protected:
+    std::string csvPath = "test_points.csv";
+
+    void write(const std::string &content)
+    {
+        std::ofstream file(csvPath, std::ios::binary);
+        file << content;
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(csvPath);
+    }
+};
+
+TEST_F(CSVUtilsTest, ReadsPointsWithHeader)
+{
+    write("\xEF\xBB\xBFx,y\r\n1,2\r\n-3.5, +4e1\r\n\r\n");
+    std::vector<Point<double, 2>> points = CSVUtils::readCSV<double, 2>(csvPath);
+    ASSERT_EQ(points.size(), 2);
+    EXPECT_EQ(points[0].coordinates, (std::array<double, 2>{1, 2}));
+    EXPECT_EQ(points[1].coordinates, (std::array<double, 2>{-3.5, 40}));
+}
+
+TEST_F(CSVUtilsTest, DetectsHeaderAndDelimiter)
+{
+    const std::string semicolons = "\"a\";b;c\n1;2;3\n4;5;6\n";
+    CSVColumns<double> withHeader = CSVUtils::parseColumns<double>(semicolons.data(), semicolons.size());
+    EXPECT_EQ(withHeader.header, (std::vector<std::string>{"a", "b", "c"}));
+    ASSERT_EQ(withHeader.numColumns(), 3);
+    EXPECT_EQ(withHeader.columns[2], (std::vector<double>{3, 6}));
+
+    const std::string content = "1\t2\n3\t4\n";
+    CSVColumns<double> withoutHeader = CSVUtils::parseColumns<double>(content.data(), content.size());
+    EXPECT_TRUE(withoutHeader.header.empty());
+    EXPECT_EQ(withoutHeader.columns[0], (std::vector<double>{1, 3}));
+}
+
+TEST_F(CSVUtilsTest, ChunksGiveTheSameResult)
+{
+    std::ostringstream stream;
+    stream << "x,y,z,w\n";
+    for (int i = 0; i < 5000; ++i)
+    {
+        stream << i << "," << i * 0.5 << "," << -i << "," << i % 7 << "\n";
+    }
+    const std::string content = stream.str();
+
+    CSVColumns<double> whole = CSVUtils::parseColumns<double>(content.data(), content.size());
+    CSVColumns<double> chunked = CSVUtils::parseColumns<double>(content.data(), content.size(), 64);
+    ASSERT_EQ(whole.numRows(), 5000);
+    EXPECT_EQ(chunked.columns, whole.columns);
+    EXPECT_DOUBLE_EQ(chunked.columns[1][4999], 2499.5);
+}
+
+TEST_F(CSVUtilsTest, RejectsInvalidFiles)
+{
+    write("x,y,z\n1,2,3\n");
+    EXPECT_THROW((CSVUtils::readCSV<double, 2>(csvPath)), std::runtime_error);
+
+    const std::string ragged = "1,2\n3\n";
+    EXPECT_THROW(CSVUtils::parseColumns<double>(ragged.data(), ragged.size()), std::runtime_error);
+    const std::string text = "1,2\n3,x\n";
+    EXPECT_THROW(CSVUtils::parseColumns<double>(text.data(), text.size()), std::runtime_error);
+    EXPECT_THROW((CSVUtils::readCSV<double, 2>("missing_file.csv")), std::runtime_error);
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "utils/PointFile.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+class PointFileTest : public ::testing::Test
+{
+protected:
+    std::string path = "test_points.kpts";
+    std::string csvPath = "test_points.csv";
+
+    void TearDown() override
+    {
+        std::filesystem::remove(path);
+        std::filesystem::remove(csvPath);
+    }
+};
+
+TEST_F(PointFileTest, PointsRoundTrip)
+{
+    std::vector<Point<double, 3>> points;
+    for (int i = 0; i < 100; ++i)
+    {
+        points.emplace_back(std::array<double, 3>{i * 0.5, -i * 1.25, 3.0 + i});
+    }
+    PointFile::writePoints(path, points);
+
+    PointFile file(path);
+    EXPECT_EQ(file.numPoints(), 100);
+    EXPECT_EQ(file.dimensions(), 3);
+    EXPECT_EQ(file.type(), PointFileType::FLOAT64);
+    EXPECT_EQ(std::filesystem::file_size(path), POINT_FILE_ALIGNMENT + 3 * 832);
+
+    // Columns are aligned in the map
+    for (std::size_t d = 0; d < 3; ++d)
+    {
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(file.column<double>(d)) % POINT_FILE_ALIGNMENT, 0);
+    }
+    EXPECT_DOUBLE_EQ(file.column<double>(1)[10], -12.5);
+
+    const auto loaded = file.readPoints<double, 3>();
+    ASSERT_EQ(loaded.size(), points.size());
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        EXPECT_EQ(loaded[i].coordinates, points[i].coordinates);
+        EXPECT_EQ(loaded[i].id, static_cast<int>(i));
+    }
+}
+
+TEST_F(PointFileTest, ReadsARange)
+{
+    std::vector<Point<double, 2>> points;
+    for (int i = 0; i < 10; ++i)
+    {
+        points.emplace_back(std::array<double, 2>{double(i), double(2 * i)});
+    }
+    PointFile::writePoints(path, points);
+
+    const auto range = PointFile(path).readPoints<double, 2>(4, 7);
+    ASSERT_EQ(range.size(), 3);
+    EXPECT_EQ(range[0].id, 4);
+    EXPECT_DOUBLE_EQ(range[2].coordinates[1], 12.0);
+    EXPECT_TRUE((PointFile(path).readPoints<double, 2>(12, 20).empty()));
+}
+
+TEST_F(PointFileTest, ConvertsCSVAndWritesLabels)
+{
+    std::ofstream csv(csvPath);
+    csv << "x,y\n1.5,2\n-3,4.25\n";
+    csv.close();
+    PointFile::convertCSV(csvPath, path);
+
+    const auto points = PointFile(path).readPoints<double, 2>();
+    ASSERT_EQ(points.size(), 2);
+    EXPECT_DOUBLE_EQ(points[1].coordinates[0], -3.0);
+    EXPECT_DOUBLE_EQ(points[1].coordinates[1], 4.25);
+
+    // Values of other types are converted
+    const std::vector<float> x = {0.5f, 1.5f}, y = {-2.0f, 8.0f};
+    PointFile::writeColumns<float>(path, {x.data(), y.data()}, 2);
+    EXPECT_EQ(PointFile(path).type(), PointFileType::FLOAT32);
+    EXPECT_DOUBLE_EQ((PointFile(path).readPoints<double, 2>()[1].coordinates[1]), 8.0);
+
+    PointFile::writeLabels(path, {2, 0, -1});
+    PointFile labels(path);
+    EXPECT_EQ(labels.type(), PointFileType::INT32);
+    EXPECT_EQ(labels.column<std::int32_t>(0)[2], -1);
+    EXPECT_THROW(labels.column<double>(0), std::invalid_argument);
+}
+
+TEST_F(PointFileTest, RejectsInvalidFiles)
+{
+    std::ofstream(path) << "x,y\n1,2\n";
+    EXPECT_THROW(PointFile file(path), std::runtime_error);
+
+    std::vector<Point<double, 2>> points(4);
+    PointFile::writePoints(path, points);
+    EXPECT_THROW((PointFile(path).readPoints<double, 3>()), std::runtime_error);
+
+    std::filesystem::resize_file(path, POINT_FILE_ALIGNMENT + 16);
+    EXPECT_THROW(PointFile file(path), std::runtime_error);
+
+    // N * sizeof(double) wraps to 8 bytes, which the file would hold
+    PointFile::writePoints(path, points);
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        const std::uint64_t hugeN = (std::uint64_t(1) << 61) + 1;
+        file.seekp(2 * sizeof(std::uint32_t));
+        file.write(reinterpret_cast<const char *>(&hugeN), sizeof(hugeN));
+    }
+    EXPECT_THROW(PointFile file(path), std::runtime_error);
+}